@@ -0,0 +1,1565 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+/* A Pawn 3.2 abstract machine for amxprof-run, implementing the interface
+ * declared in amx.h (the plugin itself uses the server's VM through
+ * amxplugin.cpp). It is a plain switch-based interpreter: jump and call
+ * targets are relocated to absolute addresses by amx_Init() as in the
+ * original VM, which is what amxprof's GetCalleeAddress() expects, but
+ * opcodes are not, so the table returned in browse mode maps each opcode
+ * to itself.
+ *
+ * Only little-endian hosts and the name table format (file version 7 and
+ * newer, i.e. everything the SA-MP compiler produces) are supported.
+ * amx_Clone(), amx_InitJIT() and the UTF-8 functions are not implemented.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "amx.h"
+
+typedef enum {
+  OP_NONE,         OP_LOAD_PRI,     OP_LOAD_ALT,
+  OP_LOAD_S_PRI,   OP_LOAD_S_ALT,   OP_LREF_PRI,
+  OP_LREF_ALT,     OP_LREF_S_PRI,   OP_LREF_S_ALT,
+  OP_LOAD_I,       OP_LODB_I,       OP_CONST_PRI,
+  OP_CONST_ALT,    OP_ADDR_PRI,     OP_ADDR_ALT,
+  OP_STOR_PRI,     OP_STOR_ALT,     OP_STOR_S_PRI,
+  OP_STOR_S_ALT,   OP_SREF_PRI,     OP_SREF_ALT,
+  OP_SREF_S_PRI,   OP_SREF_S_ALT,   OP_STOR_I,
+  OP_STRB_I,       OP_LIDX,         OP_LIDX_B,
+  OP_IDXADDR,      OP_IDXADDR_B,    OP_ALIGN_PRI,
+  OP_ALIGN_ALT,    OP_LCTRL,        OP_SCTRL,
+  OP_MOVE_PRI,     OP_MOVE_ALT,     OP_XCHG,
+  OP_PUSH_PRI,     OP_PUSH_ALT,     OP_PUSH_R,
+  OP_PUSH_C,       OP_PUSH,         OP_PUSH_S,
+  OP_POP_PRI,      OP_POP_ALT,      OP_STACK,
+  OP_HEAP,         OP_PROC,         OP_RET,
+  OP_RETN,         OP_CALL,         OP_CALL_PRI,
+  OP_JUMP,         OP_JREL,         OP_JZER,
+  OP_JNZ,          OP_JEQ,          OP_JNEQ,
+  OP_JLESS,        OP_JLEQ,         OP_JGRTR,
+  OP_JGEQ,         OP_JSLESS,       OP_JSLEQ,
+  OP_JSGRTR,       OP_JSGEQ,        OP_SHL,
+  OP_SHR,          OP_SSHR,         OP_SHL_C_PRI,
+  OP_SHL_C_ALT,    OP_SHR_C_PRI,    OP_SHR_C_ALT,
+  OP_SMUL,         OP_SDIV,         OP_SDIV_ALT,
+  OP_UMUL,         OP_UDIV,         OP_UDIV_ALT,
+  OP_ADD,          OP_SUB,          OP_SUB_ALT,
+  OP_AND,          OP_OR,           OP_XOR,
+  OP_NOT,          OP_NEG,          OP_INVERT,
+  OP_ADD_C,        OP_SMUL_C,       OP_ZERO_PRI,
+  OP_ZERO_ALT,     OP_ZERO,         OP_ZERO_S,
+  OP_SIGN_PRI,     OP_SIGN_ALT,     OP_EQ,
+  OP_NEQ,          OP_LESS,         OP_LEQ,
+  OP_GRTR,         OP_GEQ,          OP_SLESS,
+  OP_SLEQ,         OP_SGRTR,        OP_SGEQ,
+  OP_EQ_C_PRI,     OP_EQ_C_ALT,     OP_INC_PRI,
+  OP_INC_ALT,      OP_INC,          OP_INC_S,
+  OP_INC_I,        OP_DEC_PRI,      OP_DEC_ALT,
+  OP_DEC,          OP_DEC_S,        OP_DEC_I,
+  OP_MOVS,         OP_CMPS,         OP_FILL,
+  OP_HALT,         OP_BOUNDS,       OP_SYSREQ_PRI,
+  OP_SYSREQ_C,     OP_FILE,         OP_LINE,
+  OP_SYMBOL,       OP_SRANGE,       OP_JUMP_PRI,
+  OP_SWITCH,       OP_CASETBL,      OP_SWAP_PRI,
+  OP_SWAP_ALT,     OP_PUSH_ADR,     OP_NOP,
+  OP_SYSREQ_D,     OP_SYMTAG,       OP_BREAK,
+  OP_NUM_OPCODES
+} OPCODE;
+
+#define NUMENTRIES(hdr,field,nextfield) \
+  (int)(((hdr)->nextfield - (hdr)->field) / (hdr)->defsize)
+#define GETENTRY(hdr,table,index) \
+  ((AMX_FUNCSTUBNT *)((unsigned char *)(hdr) + (hdr)->table + (index) * (hdr)->defsize))
+#define GETENTRYNAME(hdr,entry) \
+  ((char *)((unsigned char *)(hdr) + (entry)->nameofs))
+
+/* Jump targets hold the absolute address of the target instruction,
+ * truncated to a cell on 64-bit hosts.
+ */
+#define RELOCATE(code,offs)     ((cell)((ucell)(size_t)(code) + (ucell)(offs)))
+#define JUMPTARGET(code,target) \
+  ((cell *)((code) + (ucell)((ucell)(target) - (ucell)(size_t)(code))))
+
+#define STKMARGIN     ((cell)(16 * sizeof(cell)))
+
+static int is_little_endian(void)
+{
+  static const uint16_t probe = 1;
+  return *(const unsigned char *)&probe == 1;
+}
+
+static void swap_bytes(unsigned char *bytes, size_t size)
+{
+  size_t i;
+  unsigned char t;
+
+  for (i = 0; i < size / 2; i++) {
+    t = bytes[i];
+    bytes[i] = bytes[size - 1 - i];
+    bytes[size - 1 - i] = t;
+  } /* for */
+}
+
+uint16_t * AMXAPI amx_Align16(uint16_t *v)
+{
+  if (!is_little_endian())
+    swap_bytes((unsigned char *)v, sizeof *v);
+  return v;
+}
+
+uint32_t * AMXAPI amx_Align32(uint32_t *v)
+{
+  if (!is_little_endian())
+    swap_bytes((unsigned char *)v, sizeof *v);
+  return v;
+}
+
+#if defined _I64_MAX || defined HAVE_I64
+uint64_t * AMXAPI amx_Align64(uint64_t *v)
+{
+  if (!is_little_endian())
+    swap_bytes((unsigned char *)v, sizeof *v);
+  return v;
+}
+#endif
+
+/* The "address" field of a native table entry is only a cell wide. On
+ * 64-bit hosts it holds the low bits of the function pointer and the full
+ * pointers are looked up here. The table is shared by all AMX instances
+ * and is not thread-safe.
+ */
+#if defined __64BIT__
+static AMX_NATIVE *native_funcs = NULL;
+static int num_native_funcs = 0;
+static int max_native_funcs = 0;
+#endif
+
+static ucell native_address(AMX_NATIVE func)
+{
+  #if defined __64BIT__
+    AMX_NATIVE *funcs;
+    int i;
+
+    for (i = 0; i < num_native_funcs; i++)
+      if (native_funcs[i] == func)
+        return (ucell)(size_t)func;
+    if (num_native_funcs == max_native_funcs) {
+      funcs = (AMX_NATIVE *)realloc(native_funcs,
+                                    (max_native_funcs + 64) * sizeof *funcs);
+      if (funcs == NULL)
+        return 0;
+      native_funcs = funcs;
+      max_native_funcs += 64;
+    } /* if */
+    native_funcs[num_native_funcs++] = func;
+  #endif
+  return (ucell)(size_t)func;
+}
+
+static AMX_NATIVE native_function(ucell address)
+{
+  #if defined __64BIT__
+    int i;
+
+    for (i = 0; i < num_native_funcs; i++)
+      if ((ucell)(size_t)native_funcs[i] == address)
+        return native_funcs[i];
+    return NULL;
+  #else
+    return (AMX_NATIVE)(size_t)address;
+  #endif
+}
+
+/* Returns the number of operands of an opcode, or -1 for opcodes that are
+ * not supported (OP_CASETBL has a variable number of operands and is
+ * handled by the caller).
+ */
+static int num_operands(cell op)
+{
+  switch (op) {
+  case OP_LOAD_I:     case OP_STOR_I:     case OP_LIDX:
+  case OP_IDXADDR:    case OP_MOVE_PRI:   case OP_MOVE_ALT:
+  case OP_XCHG:       case OP_PUSH_PRI:   case OP_PUSH_ALT:
+  case OP_POP_PRI:    case OP_POP_ALT:    case OP_PROC:
+  case OP_RET:        case OP_RETN:       case OP_CALL_PRI:
+  case OP_SHL:        case OP_SHR:        case OP_SSHR:
+  case OP_SMUL:       case OP_SDIV:       case OP_SDIV_ALT:
+  case OP_UMUL:       case OP_UDIV:       case OP_UDIV_ALT:
+  case OP_ADD:        case OP_SUB:        case OP_SUB_ALT:
+  case OP_AND:        case OP_OR:         case OP_XOR:
+  case OP_NOT:        case OP_NEG:        case OP_INVERT:
+  case OP_ZERO_PRI:   case OP_ZERO_ALT:   case OP_SIGN_PRI:
+  case OP_SIGN_ALT:   case OP_EQ:         case OP_NEQ:
+  case OP_LESS:       case OP_LEQ:        case OP_GRTR:
+  case OP_GEQ:        case OP_SLESS:      case OP_SLEQ:
+  case OP_SGRTR:      case OP_SGEQ:       case OP_INC_PRI:
+  case OP_INC_ALT:    case OP_INC_I:      case OP_DEC_PRI:
+  case OP_DEC_ALT:    case OP_DEC_I:      case OP_SYSREQ_PRI:
+  case OP_JUMP_PRI:   case OP_SWAP_PRI:   case OP_SWAP_ALT:
+  case OP_NOP:        case OP_BREAK:
+    return 0;
+  case OP_LOAD_PRI:   case OP_LOAD_ALT:   case OP_LOAD_S_PRI:
+  case OP_LOAD_S_ALT: case OP_LREF_PRI:   case OP_LREF_ALT:
+  case OP_LREF_S_PRI: case OP_LREF_S_ALT: case OP_LODB_I:
+  case OP_CONST_PRI:  case OP_CONST_ALT:  case OP_ADDR_PRI:
+  case OP_ADDR_ALT:   case OP_STOR_PRI:   case OP_STOR_ALT:
+  case OP_STOR_S_PRI: case OP_STOR_S_ALT: case OP_SREF_PRI:
+  case OP_SREF_ALT:   case OP_SREF_S_PRI: case OP_SREF_S_ALT:
+  case OP_STRB_I:     case OP_LIDX_B:     case OP_IDXADDR_B:
+  case OP_ALIGN_PRI:  case OP_ALIGN_ALT:  case OP_LCTRL:
+  case OP_SCTRL:      case OP_PUSH_R:     case OP_PUSH_C:
+  case OP_PUSH:       case OP_PUSH_S:     case OP_STACK:
+  case OP_HEAP:       case OP_CALL:       case OP_JUMP:
+  case OP_JREL:       case OP_JZER:       case OP_JNZ:
+  case OP_JEQ:        case OP_JNEQ:       case OP_JLESS:
+  case OP_JLEQ:       case OP_JGRTR:      case OP_JGEQ:
+  case OP_JSLESS:     case OP_JSLEQ:      case OP_JSGRTR:
+  case OP_JSGEQ:      case OP_SHL_C_PRI:  case OP_SHL_C_ALT:
+  case OP_SHR_C_PRI:  case OP_SHR_C_ALT:  case OP_ADD_C:
+  case OP_SMUL_C:     case OP_ZERO:       case OP_ZERO_S:
+  case OP_EQ_C_PRI:   case OP_EQ_C_ALT:   case OP_INC:
+  case OP_INC_S:      case OP_DEC:        case OP_DEC_S:
+  case OP_MOVS:       case OP_CMPS:       case OP_FILL:
+  case OP_HALT:       case OP_BOUNDS:     case OP_SYSREQ_C:
+  case OP_SWITCH:     case OP_PUSH_ADR:   case OP_SYSREQ_D:
+    return 1;
+  default:
+    /* OP_NONE and the obsolete OP_FILE, OP_LINE, OP_SYMBOL, OP_SRANGE and
+     * OP_SYMTAG */
+    return -1;
+  } /* switch */
+}
+
+/* Checks the code and makes jump and call targets absolute. */
+static int relocate(AMX *amx)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  unsigned char *code = amx->base + hdr->cod;
+  cell codesize = hdr->dat - hdr->cod;
+  cell *cip, *end, op, num, i;
+  int operands;
+
+  cip = (cell *)code;
+  end = (cell *)(code + codesize);
+  while (cip < end) {
+    op = *cip;
+    if (op == OP_CASETBL) {
+      if (cip + 3 > end)
+        return AMX_ERR_FORMAT;
+      num = cip[1];
+      if (num < 0 || num > (end - cip - 3) / 2)
+        return AMX_ERR_FORMAT;
+      cip[2] = RELOCATE(code, cip[2]);
+      for (i = 0; i < num; i++)
+        cip[4 + 2 * i] = RELOCATE(code, cip[4 + 2 * i]);
+      cip += 3 + 2 * num;
+      continue;
+    } /* if */
+    operands = num_operands(op);
+    if (operands < 0 || cip + 1 + operands > end)
+      return AMX_ERR_INVINSTR;
+    switch (op) {
+    case OP_CALL:   case OP_JUMP:   case OP_JZER:   case OP_JNZ:
+    case OP_JEQ:    case OP_JNEQ:   case OP_JLESS:  case OP_JLEQ:
+    case OP_JGRTR:  case OP_JGEQ:   case OP_JSLESS: case OP_JSLEQ:
+    case OP_JSGRTR: case OP_JSGEQ:  case OP_SWITCH:
+      if (cip[1] < 0 || cip[1] >= codesize)
+        return AMX_ERR_FORMAT;
+      cip[1] = RELOCATE(code, cip[1]);
+      break;
+    default:
+      break;
+    } /* switch */
+    cip += 1 + operands;
+  } /* while */
+
+  amx->flags |= AMX_FLAG_RELOC;
+  return AMX_ERR_NONE;
+}
+
+/* Expands code and data stored in the compact encoding: every cell is a
+ * sequence of 7-bit groups, most significant group first, where all but the
+ * last byte have the high bit set; bit 6 of the first byte is the sign.
+ */
+static int expand(unsigned char *code, long codesize, long memsize)
+{
+  ucell *buffer, c;
+  long in, out;
+
+  buffer = (ucell *)malloc((size_t)memsize);
+  if (buffer == NULL)
+    return AMX_ERR_MEMORY;
+  in = out = 0;
+  while (in < codesize && out < memsize / (long)sizeof(cell)) {
+    c = (code[in] & 0x40) != 0 ? ~(ucell)0 : 0;
+    while (in < codesize && (code[in] & 0x80) != 0)
+      c = (c << 7) | (code[in++] & 0x7f);
+    if (in >= codesize)
+      break;
+    c = (c << 7) | code[in++];
+    buffer[out++] = c;
+  } /* while */
+  if (in != codesize || out != memsize / (long)sizeof(cell)) {
+    free(buffer);
+    return AMX_ERR_FORMAT;
+  } /* if */
+  memcpy(code, buffer, (size_t)memsize);
+  free(buffer);
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Init(AMX *amx, void *program)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)program;
+  AMX_FUNCSTUBNT *func;
+  int i, numnatives, result;
+
+  if (!is_little_endian())
+    return AMX_ERR_FORMAT;
+  if (hdr->magic != AMX_MAGIC)
+    return AMX_ERR_FORMAT;
+  if (hdr->file_version < MIN_FILE_VERSION || hdr->amx_version > CUR_FILE_VERSION)
+    return AMX_ERR_VERSION;
+  if (hdr->defsize != sizeof(AMX_FUNCSTUBNT))
+    return AMX_ERR_FORMAT;
+  if ((hdr->flags & AMX_FLAG_BYTEOPC) != 0)
+    return AMX_ERR_FORMAT;
+  if (hdr->cod < (int32_t)sizeof(AMX_HEADER) || hdr->dat < hdr->cod
+      || hdr->hea < hdr->dat || hdr->stp < hdr->hea
+      || (hdr->cip >= 0 && hdr->cip >= hdr->dat - hdr->cod))
+    return AMX_ERR_FORMAT;
+
+  amx->base = (unsigned char *)program;
+  amx->flags = hdr->flags & ~AMX_FLAG_RELOC;
+  amx->callback = amx_Callback;
+  amx->debug = NULL;
+  amx->error = AMX_ERR_NONE;
+  amx->paramcount = 0;
+
+  if ((hdr->flags & AMX_FLAG_COMPACT) != 0) {
+    result = expand(amx->base + hdr->cod, hdr->size - hdr->cod,
+                    hdr->hea - hdr->cod);
+    if (result != AMX_ERR_NONE)
+      return result;
+  } /* if */
+
+  if (amx->data != NULL)
+    memcpy(amx->data, amx->base + hdr->dat, (size_t)(hdr->hea - hdr->dat));
+
+  amx->hlw = hdr->hea - hdr->dat;
+  amx->hea = amx->hlw;
+  amx->stp = hdr->stp - hdr->dat - sizeof(cell);
+  amx->stk = amx->stp;
+  amx->reset_stk = amx->stk;
+  amx->reset_hea = amx->hea;
+  /* a sentinel for strings at the top of the stack */
+  *(cell *)((amx->data != NULL ? amx->data : amx->base + hdr->dat)
+            + amx->stp) = 0;
+
+  result = relocate(amx);
+  if (result != AMX_ERR_NONE)
+    return result;
+
+  numnatives = NUMENTRIES(hdr, natives, libraries);
+  for (i = 0; i < numnatives; i++) {
+    func = GETENTRY(hdr, natives, i);
+    func->address = 0;
+  } /* for */
+  if (numnatives == 0)
+    amx->flags |= AMX_FLAG_NTVREG;
+
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Cleanup(AMX *amx)
+{
+  (void)amx;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_MemInfo(AMX *amx, long *codesize, long *datasize, long *stackheap)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+
+  if (codesize != NULL)
+    *codesize = hdr->dat - hdr->cod;
+  if (datasize != NULL)
+    *datasize = hdr->hea - hdr->dat;
+  if (stackheap != NULL)
+    *stackheap = hdr->stp - hdr->hea;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Flags(AMX *amx, uint16_t *flags)
+{
+  *flags = (uint16_t)amx->flags;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_NameLength(AMX *amx, int *length)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  uint16_t *namelength = (uint16_t *)(amx->base + hdr->nametable);
+
+  *length = *amx_Align16(namelength);
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_NumNatives(AMX *amx, int *number)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+
+  *number = NUMENTRIES(hdr, natives, libraries);
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_NumPublics(AMX *amx, int *number)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+
+  *number = NUMENTRIES(hdr, publics, natives);
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_NumPubVars(AMX *amx, int *number)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+
+  *number = NUMENTRIES(hdr, pubvars, tags);
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_NumTags(AMX *amx, int *number)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+
+  *number = NUMENTRIES(hdr, tags, nametable);
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_GetNative(AMX *amx, int index, char *funcname)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+
+  if (index < 0 || index >= NUMENTRIES(hdr, natives, libraries))
+    return AMX_ERR_INDEX;
+  strcpy(funcname, GETENTRYNAME(hdr, GETENTRY(hdr, natives, index)));
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_GetPublic(AMX *amx, int index, char *funcname)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+
+  if (index < 0 || index >= NUMENTRIES(hdr, publics, natives))
+    return AMX_ERR_INDEX;
+  strcpy(funcname, GETENTRYNAME(hdr, GETENTRY(hdr, publics, index)));
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_GetPubVar(AMX *amx, int index, char *varname, cell *amx_addr)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  AMX_FUNCSTUBNT *var;
+
+  if (index < 0 || index >= NUMENTRIES(hdr, pubvars, tags))
+    return AMX_ERR_INDEX;
+  var = GETENTRY(hdr, pubvars, index);
+  strcpy(varname, GETENTRYNAME(hdr, var));
+  *amx_addr = (cell)var->address;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_GetTag(AMX *amx, int index, char *tagname, cell *tag_id)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  AMX_FUNCSTUBNT *tag;
+
+  if (index < 0 || index >= NUMENTRIES(hdr, tags, nametable))
+    return AMX_ERR_INDEX;
+  tag = GETENTRY(hdr, tags, index);
+  strcpy(tagname, GETENTRYNAME(hdr, tag));
+  *tag_id = (cell)tag->address;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_FindNative(AMX *amx, const char *name, int *index)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  int i, num = NUMENTRIES(hdr, natives, libraries);
+
+  for (i = 0; i < num; i++) {
+    if (strcmp(GETENTRYNAME(hdr, GETENTRY(hdr, natives, i)), name) == 0) {
+      *index = i;
+      return AMX_ERR_NONE;
+    } /* if */
+  } /* for */
+  *index = INT_MAX;
+  return AMX_ERR_NOTFOUND;
+}
+
+int AMXAPI amx_FindPublic(AMX *amx, const char *funcname, int *index)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  int first, last, mid, result;
+
+  /* the public table is sorted by name */
+  first = 0;
+  last = NUMENTRIES(hdr, publics, natives) - 1;
+  while (first <= last) {
+    mid = (first + last) / 2;
+    result = strcmp(GETENTRYNAME(hdr, GETENTRY(hdr, publics, mid)), funcname);
+    if (result == 0) {
+      *index = mid;
+      return AMX_ERR_NONE;
+    } /* if */
+    if (result < 0)
+      first = mid + 1;
+    else
+      last = mid - 1;
+  } /* while */
+  *index = INT_MAX;
+  return AMX_ERR_NOTFOUND;
+}
+
+int AMXAPI amx_FindPubVar(AMX *amx, const char *varname, cell *amx_addr)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  AMX_FUNCSTUBNT *var;
+  int i, num = NUMENTRIES(hdr, pubvars, tags);
+
+  for (i = 0; i < num; i++) {
+    var = GETENTRY(hdr, pubvars, i);
+    if (strcmp(GETENTRYNAME(hdr, var), varname) == 0) {
+      *amx_addr = (cell)var->address;
+      return AMX_ERR_NONE;
+    } /* if */
+  } /* for */
+  return AMX_ERR_NOTFOUND;
+}
+
+int AMXAPI amx_FindTagId(AMX *amx, cell tag_id, char *tagname)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  AMX_FUNCSTUBNT *tag;
+  int i, num = NUMENTRIES(hdr, tags, nametable);
+
+  for (i = 0; i < num; i++) {
+    tag = GETENTRY(hdr, tags, i);
+    if ((cell)tag->address == tag_id) {
+      strcpy(tagname, GETENTRYNAME(hdr, tag));
+      return AMX_ERR_NONE;
+    } /* if */
+  } /* for */
+  *tagname = '\0';
+  return AMX_ERR_NOTFOUND;
+}
+
+int AMXAPI amx_GetUserData(AMX *amx, long tag, void **ptr)
+{
+  int i;
+
+  for (i = 0; i < AMX_USERNUM; i++) {
+    if (amx->usertags[i] == tag) {
+      *ptr = amx->userdata[i];
+      return AMX_ERR_NONE;
+    } /* if */
+  } /* for */
+  return AMX_ERR_USERDATA;
+}
+
+int AMXAPI amx_SetUserData(AMX *amx, long tag, void *ptr)
+{
+  int i;
+
+  for (i = 0; i < AMX_USERNUM; i++) {
+    if (amx->usertags[i] == tag || amx->usertags[i] == 0) {
+      amx->usertags[i] = tag;
+      amx->userdata[i] = ptr;
+      return AMX_ERR_NONE;
+    } /* if */
+  } /* for */
+  return AMX_ERR_USERDATA;
+}
+
+AMX_NATIVE_INFO * AMXAPI amx_NativeInfo(const char *name, AMX_NATIVE func)
+{
+  static AMX_NATIVE_INFO info;
+
+  info.name = name;
+  info.func = func;
+  return &info;
+}
+
+int AMXAPI amx_Register(AMX *amx, const AMX_NATIVE_INFO *list, int number)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  AMX_FUNCSTUBNT *func;
+  const char *name;
+  int i, j, num, unresolved = 0;
+
+  num = NUMENTRIES(hdr, natives, libraries);
+  for (i = 0; i < num; i++) {
+    func = GETENTRY(hdr, natives, i);
+    if (func->address == 0) {
+      name = GETENTRYNAME(hdr, func);
+      for (j = 0; (number < 0 || j < number) && list[j].name != NULL; j++) {
+        if (strcmp(list[j].name, name) == 0) {
+          func->address = native_address(list[j].func);
+          break;
+        } /* if */
+      } /* for */
+    } /* if */
+    if (func->address == 0)
+      unresolved++;
+  } /* for */
+
+  if (unresolved > 0)
+    return AMX_ERR_NOTFOUND;
+  amx->flags |= AMX_FLAG_NTVREG;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_SetCallback(AMX *amx, AMX_CALLBACK callback)
+{
+  amx->callback = callback;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_SetDebugHook(AMX *amx, AMX_DEBUG debug)
+{
+  amx->debug = debug;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_RaiseError(AMX *amx, int error)
+{
+  amx->error = error;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Callback(AMX *amx, cell index, cell *result, cell *params)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  AMX_NATIVE f;
+
+  if (index < 0 || index >= NUMENTRIES(hdr, natives, libraries))
+    return AMX_ERR_INDEX;
+  f = native_function(GETENTRY(hdr, natives, index)->address);
+  if (f == NULL)
+    return AMX_ERR_NOTFOUND;
+  amx->error = AMX_ERR_NONE;
+  *result = f(amx, params);
+  return amx->error;
+}
+
+static unsigned char *data_ptr(AMX *amx)
+{
+  AMX_HEADER *hdr = (AMX_HEADER *)amx->base;
+  return amx->data != NULL ? amx->data : amx->base + hdr->dat;
+}
+
+int AMXAPI amx_GetAddr(AMX *amx, cell amx_addr, cell **phys_addr)
+{
+  if (amx_addr < 0 || amx_addr >= amx->stp
+      || (amx_addr >= amx->hea && amx_addr < amx->stk))
+    return AMX_ERR_MEMACCESS;
+  *phys_addr = (cell *)(data_ptr(amx) + amx_addr);
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Allot(AMX *amx, int cells, cell *amx_addr, cell **phys_addr)
+{
+  if (cells < 0 || amx->stk - amx->hea - cells * (cell)sizeof(cell) < STKMARGIN)
+    return AMX_ERR_MEMORY;
+  if (amx_addr != NULL)
+    *amx_addr = amx->hea;
+  if (phys_addr != NULL)
+    *phys_addr = (cell *)(data_ptr(amx) + amx->hea);
+  amx->hea += cells * sizeof(cell);
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Release(AMX *amx, cell amx_addr)
+{
+  if (amx->hea > amx_addr && amx_addr >= amx->hlw)
+    amx->hea = amx_addr;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Push(AMX *amx, cell value)
+{
+  if (amx->hea + STKMARGIN > amx->stk)
+    return AMX_ERR_STACKERR;
+  amx->stk -= sizeof(cell);
+  amx->paramcount++;
+  *(cell *)(data_ptr(amx) + amx->stk) = value;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_PushArray(AMX *amx, cell *amx_addr, cell **phys_addr,
+                         const cell array[], int numcells)
+{
+  cell xaddr;
+  cell *paddr;
+  int err;
+
+  err = amx_Allot(amx, numcells, &xaddr, &paddr);
+  if (err != AMX_ERR_NONE)
+    return err;
+  if (array != NULL)
+    memcpy(paddr, array, numcells * sizeof(cell));
+  if (amx_addr != NULL)
+    *amx_addr = xaddr;
+  if (phys_addr != NULL)
+    *phys_addr = paddr;
+  return amx_Push(amx, xaddr);
+}
+
+int AMXAPI amx_PushString(AMX *amx, cell *amx_addr, cell **phys_addr,
+                          const char *string, int pack, int use_wchar)
+{
+  cell xaddr;
+  cell *paddr;
+  int err, length, numcells;
+
+  length = (int)strlen(string);
+  if (pack)
+    numcells = (length + sizeof(cell)) / sizeof(cell);
+  else
+    numcells = length + 1;
+  err = amx_Allot(amx, numcells, &xaddr, &paddr);
+  if (err != AMX_ERR_NONE)
+    return err;
+  amx_SetString(paddr, string, pack, use_wchar, numcells * sizeof(cell));
+  if (amx_addr != NULL)
+    *amx_addr = xaddr;
+  if (phys_addr != NULL)
+    *phys_addr = paddr;
+  return amx_Push(amx, xaddr);
+}
+
+/* Returns the i-th character of a packed string (the first character is in
+ * the most significant byte of the first cell).
+ */
+#define PACKEDCHAR(cstr,i) \
+  (((ucell)(cstr)[(i) / sizeof(cell)] \
+    >> (8 * (sizeof(cell) - 1 - (i) % sizeof(cell)))) & 0xff)
+
+int AMXAPI amx_StrLen(const cell *cstring, int *length)
+{
+  int len;
+
+  if ((ucell)*cstring > UNPACKEDMAX) {
+    for (len = 0; PACKEDCHAR(cstring, len) != 0; len++)
+      /* nothing */;
+  } else {
+    for (len = 0; cstring[len] != 0; len++)
+      /* nothing */;
+  } /* if */
+  *length = len;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_GetString(char *dest, const cell *source, int use_wchar, size_t size)
+{
+  size_t i;
+  cell c;
+
+  if (size == 0)
+    return AMX_ERR_NONE;
+  for (i = 0; i < size - 1; i++) {
+    if ((ucell)*source > UNPACKEDMAX)
+      c = (cell)PACKEDCHAR(source, i);
+    else
+      c = source[i];
+    if (c == 0)
+      break;
+    if (use_wchar)
+      ((wchar_t *)dest)[i] = (wchar_t)c;
+    else
+      dest[i] = (char)c;
+  } /* for */
+  if (use_wchar)
+    ((wchar_t *)dest)[i] = 0;
+  else
+    dest[i] = '\0';
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_SetString(cell *dest, const char *source, int pack, int use_wchar,
+                         size_t size)
+{
+  size_t i, len;
+  int shift;
+
+  if (use_wchar)
+    for (len = 0; ((const wchar_t *)source)[len] != 0; len++)
+      /* nothing */;
+  else
+    len = strlen(source);
+
+  if (pack) {
+    if (len >= size * sizeof(cell))
+      len = size * sizeof(cell) - 1;
+    memset(dest, 0, (len / sizeof(cell) + 1) * sizeof(cell));
+    for (i = 0; i < len; i++) {
+      shift = (int)(8 * (sizeof(cell) - 1 - i % sizeof(cell)));
+      dest[i / sizeof(cell)] |= (cell)((ucell)(unsigned char)
+        (use_wchar ? (char)((const wchar_t *)source)[i] : source[i]) << shift);
+    } /* for */
+  } else {
+    if (len >= size)
+      len = size - 1;
+    for (i = 0; i < len; i++)
+      dest[i] = use_wchar ? (cell)((const wchar_t *)source)[i]
+                          : (cell)(unsigned char)source[i];
+    dest[len] = 0;
+  } /* if */
+  return AMX_ERR_NONE;
+}
+
+#define ABORT(amx,v)  { (amx)->stk = reset_stk; (amx)->hea = reset_hea; return (v); }
+
+#define CHKMARGIN()   if (hea + STKMARGIN > stk) ABORT(amx, AMX_ERR_STACKERR)
+#define CHKSTACK()    if (stk > amx->stp) ABORT(amx, AMX_ERR_STACKLOW)
+#define CHKHEAP()     if (hea < amx->hlw) ABORT(amx, AMX_ERR_HEAPLOW)
+
+/* Data addresses must lie either below the top of the heap or above the
+ * stack pointer.
+ */
+#define VERIFYADDRESS(addr) \
+  if ((ucell)(addr) >= (ucell)amx->stp \
+      || ((ucell)(addr) >= (ucell)hea && (ucell)(addr) < (ucell)stk)) \
+    ABORT(amx, AMX_ERR_MEMACCESS)
+
+#define _R(addr)      (*(cell *)(data + (addr)))
+#define PUSH(v)       (stk -= sizeof(cell), _R(stk) = (v))
+#define POP(v)        ((v) = _R(stk), stk += sizeof(cell))
+#define GETPARAM(v)   ((v) = *cip++)
+#define JUMP()        (cip = JUMPTARGET(code, *cip))
+#define SKIPPARAM()   (cip++)
+
+/* Saves the state of the machine when a native or the debug hook put it
+ * to sleep; amx_Exec() with AMX_EXEC_CONT resumes from here.
+ */
+#define SLEEP(v) \
+  { \
+    amx->cip = (cell)((unsigned char *)cip - code); \
+    amx->frm = frm; amx->stk = stk; amx->hea = hea; \
+    amx->pri = pri; amx->alt = alt; \
+    amx->reset_stk = reset_stk; amx->reset_hea = reset_hea; \
+    return (v); \
+  }
+
+#define SYSREQ(index) \
+  { \
+    amx->cip = (cell)((unsigned char *)cip - code); \
+    amx->frm = frm; amx->stk = stk; amx->hea = hea; \
+    num = amx->callback(amx, (index), &pri, (cell *)(data + stk)); \
+    if (num != AMX_ERR_NONE) { \
+      if (num == AMX_ERR_SLEEP) \
+        SLEEP(num); \
+      ABORT(amx, num); \
+    } \
+  }
+
+int AMXAPI amx_Exec(AMX *amx, cell *retval, int index)
+{
+  static cell opcodes[OP_NUM_OPCODES];
+  AMX_HEADER *hdr;
+  unsigned char *code, *data;
+  cell pri, alt, stk, frm, hea, reset_stk, reset_hea, offs, val, codesize;
+  cell *cip, *cptr;
+  int i, num;
+
+  if ((amx->flags & AMX_FLAG_BROWSE) == AMX_FLAG_BROWSE) {
+    /* opcodes are not relocated, the table maps each one to itself */
+    for (i = 0; i < OP_NUM_OPCODES; i++)
+      opcodes[i] = i;
+    *(cell **)retval = opcodes;
+    return AMX_ERR_NONE;
+  } /* if */
+
+  if (amx->callback == NULL)
+    return AMX_ERR_CALLBACK;
+  if ((amx->flags & AMX_FLAG_RELOC) == 0)
+    return AMX_ERR_INIT;
+  if ((amx->flags & AMX_FLAG_NTVREG) == 0)
+    return AMX_ERR_NOTFOUND;
+
+  hdr = (AMX_HEADER *)amx->base;
+  code = amx->base + hdr->cod;
+  data = data_ptr(amx);
+  codesize = hdr->dat - hdr->cod;
+
+  if (index == AMX_EXEC_CONT) {
+    cip = (cell *)(code + amx->cip);
+    frm = amx->frm;
+    stk = amx->stk;
+    hea = amx->hea;
+    pri = amx->pri;
+    alt = amx->alt;
+    reset_stk = amx->reset_stk;
+    reset_hea = amx->reset_hea;
+  } else {
+    if (index == AMX_EXEC_MAIN) {
+      if (hdr->cip < 0)
+        return AMX_ERR_INDEX;
+      cip = (cell *)(code + hdr->cip);
+    } else {
+      if (index < 0 || index >= NUMENTRIES(hdr, publics, natives))
+        return AMX_ERR_INDEX;
+      cip = (cell *)(code + GETENTRY(hdr, publics, index)->address);
+    } /* if */
+    pri = alt = frm = 0;
+    stk = amx->stk;
+    hea = amx->hea;
+    /* the arguments pushed with amx_Push() are removed by RETN */
+    reset_stk = stk + amx->paramcount * sizeof(cell);
+    reset_hea = hea;
+    CHKMARGIN();
+    CHKSTACK();
+    CHKHEAP();
+    PUSH(amx->paramcount * sizeof(cell));
+    amx->paramcount = 0;
+    /* return to address 0, where the compiler puts a HALT */
+    PUSH(0);
+  } /* if */
+
+  for ( ;; ) {
+    switch (*cip++) {
+    case OP_LOAD_PRI:
+      GETPARAM(offs);
+      pri = _R(offs);
+      break;
+    case OP_LOAD_ALT:
+      GETPARAM(offs);
+      alt = _R(offs);
+      break;
+    case OP_LOAD_S_PRI:
+      GETPARAM(offs);
+      pri = _R(frm + offs);
+      break;
+    case OP_LOAD_S_ALT:
+      GETPARAM(offs);
+      alt = _R(frm + offs);
+      break;
+    case OP_LREF_PRI:
+      GETPARAM(offs);
+      pri = _R(_R(offs));
+      break;
+    case OP_LREF_ALT:
+      GETPARAM(offs);
+      alt = _R(_R(offs));
+      break;
+    case OP_LREF_S_PRI:
+      GETPARAM(offs);
+      pri = _R(_R(frm + offs));
+      break;
+    case OP_LREF_S_ALT:
+      GETPARAM(offs);
+      alt = _R(_R(frm + offs));
+      break;
+    case OP_LOAD_I:
+      VERIFYADDRESS(pri);
+      pri = _R(pri);
+      break;
+    case OP_LODB_I:
+      GETPARAM(offs);
+      VERIFYADDRESS(pri);
+      switch (offs) {
+      case 1:
+        pri = *(unsigned char *)(data + pri);
+        break;
+      case 2:
+        pri = *(uint16_t *)(data + pri);
+        break;
+      case 4:
+        pri = *(uint32_t *)(data + pri);
+        break;
+      } /* switch */
+      break;
+    case OP_CONST_PRI:
+      GETPARAM(pri);
+      break;
+    case OP_CONST_ALT:
+      GETPARAM(alt);
+      break;
+    case OP_ADDR_PRI:
+      GETPARAM(pri);
+      pri += frm;
+      break;
+    case OP_ADDR_ALT:
+      GETPARAM(alt);
+      alt += frm;
+      break;
+    case OP_STOR_PRI:
+      GETPARAM(offs);
+      _R(offs) = pri;
+      break;
+    case OP_STOR_ALT:
+      GETPARAM(offs);
+      _R(offs) = alt;
+      break;
+    case OP_STOR_S_PRI:
+      GETPARAM(offs);
+      _R(frm + offs) = pri;
+      break;
+    case OP_STOR_S_ALT:
+      GETPARAM(offs);
+      _R(frm + offs) = alt;
+      break;
+    case OP_SREF_PRI:
+      GETPARAM(offs);
+      _R(_R(offs)) = pri;
+      break;
+    case OP_SREF_ALT:
+      GETPARAM(offs);
+      _R(_R(offs)) = alt;
+      break;
+    case OP_SREF_S_PRI:
+      GETPARAM(offs);
+      _R(_R(frm + offs)) = pri;
+      break;
+    case OP_SREF_S_ALT:
+      GETPARAM(offs);
+      _R(_R(frm + offs)) = alt;
+      break;
+    case OP_STOR_I:
+      VERIFYADDRESS(alt);
+      _R(alt) = pri;
+      break;
+    case OP_STRB_I:
+      GETPARAM(offs);
+      VERIFYADDRESS(alt);
+      switch (offs) {
+      case 1:
+        *(unsigned char *)(data + alt) = (unsigned char)pri;
+        break;
+      case 2:
+        *(uint16_t *)(data + alt) = (uint16_t)pri;
+        break;
+      case 4:
+        *(uint32_t *)(data + alt) = (uint32_t)pri;
+        break;
+      } /* switch */
+      break;
+    case OP_LIDX:
+      offs = pri * sizeof(cell) + alt;
+      VERIFYADDRESS(offs);
+      pri = _R(offs);
+      break;
+    case OP_LIDX_B:
+      GETPARAM(offs);
+      offs = (pri << offs) + alt;
+      VERIFYADDRESS(offs);
+      pri = _R(offs);
+      break;
+    case OP_IDXADDR:
+      pri = pri * sizeof(cell) + alt;
+      break;
+    case OP_IDXADDR_B:
+      GETPARAM(offs);
+      pri = (pri << offs) + alt;
+      break;
+    case OP_ALIGN_PRI:
+      GETPARAM(offs);
+      if ((size_t)offs < sizeof(cell))
+        pri ^= sizeof(cell) - offs;
+      break;
+    case OP_ALIGN_ALT:
+      GETPARAM(offs);
+      if ((size_t)offs < sizeof(cell))
+        alt ^= sizeof(cell) - offs;
+      break;
+    case OP_LCTRL:
+      GETPARAM(offs);
+      switch (offs) {
+      case 0:
+        pri = hdr->cod;
+        break;
+      case 1:
+        pri = hdr->dat;
+        break;
+      case 2:
+        pri = hea;
+        break;
+      case 3:
+        pri = amx->stp;
+        break;
+      case 4:
+        pri = stk;
+        break;
+      case 5:
+        pri = frm;
+        break;
+      case 6:
+        pri = (cell)((unsigned char *)cip - code);
+        break;
+      } /* switch */
+      break;
+    case OP_SCTRL:
+      GETPARAM(offs);
+      switch (offs) {
+      case 2:
+        hea = pri;
+        break;
+      case 4:
+        stk = pri;
+        break;
+      case 5:
+        frm = pri;
+        break;
+      case 6:
+        cip = (cell *)(code + pri);
+        break;
+      } /* switch */
+      break;
+    case OP_MOVE_PRI:
+      pri = alt;
+      break;
+    case OP_MOVE_ALT:
+      alt = pri;
+      break;
+    case OP_XCHG:
+      offs = pri;
+      pri = alt;
+      alt = offs;
+      break;
+    case OP_PUSH_PRI:
+      PUSH(pri);
+      break;
+    case OP_PUSH_ALT:
+      PUSH(alt);
+      break;
+    case OP_PUSH_R:
+      GETPARAM(offs);
+      while (offs-- > 0)
+        PUSH(pri);
+      break;
+    case OP_PUSH_C:
+      GETPARAM(offs);
+      PUSH(offs);
+      break;
+    case OP_PUSH:
+      GETPARAM(offs);
+      PUSH(_R(offs));
+      break;
+    case OP_PUSH_S:
+      GETPARAM(offs);
+      PUSH(_R(frm + offs));
+      break;
+    case OP_POP_PRI:
+      POP(pri);
+      break;
+    case OP_POP_ALT:
+      POP(alt);
+      break;
+    case OP_STACK:
+      GETPARAM(offs);
+      alt = stk;
+      stk += offs;
+      CHKMARGIN();
+      CHKSTACK();
+      break;
+    case OP_HEAP:
+      GETPARAM(offs);
+      alt = hea;
+      hea += offs;
+      CHKMARGIN();
+      CHKHEAP();
+      break;
+    case OP_PROC:
+      PUSH(frm);
+      frm = stk;
+      CHKMARGIN();
+      break;
+    case OP_RET:
+      POP(frm);
+      POP(offs);
+      if ((ucell)offs >= (ucell)codesize)
+        ABORT(amx, AMX_ERR_MEMACCESS);
+      cip = (cell *)(code + offs);
+      break;
+    case OP_RETN:
+      POP(frm);
+      POP(offs);
+      if ((ucell)offs >= (ucell)codesize)
+        ABORT(amx, AMX_ERR_MEMACCESS);
+      cip = (cell *)(code + offs);
+      stk += _R(stk) + sizeof(cell);
+      break;
+    case OP_CALL:
+      PUSH((cell)((unsigned char *)cip - code) + sizeof(cell));
+      JUMP();
+      break;
+    case OP_CALL_PRI:
+      PUSH((cell)((unsigned char *)cip - code));
+      cip = (cell *)(code + pri);
+      break;
+    case OP_JUMP:
+      JUMP();
+      break;
+    case OP_JREL:
+      offs = *cip;
+      cip = (cell *)((unsigned char *)cip + offs + sizeof(cell));
+      break;
+    case OP_JZER:
+      if (pri == 0) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JNZ:
+      if (pri != 0) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JEQ:
+      if (pri == alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JNEQ:
+      if (pri != alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JLESS:
+      if ((ucell)pri < (ucell)alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JLEQ:
+      if ((ucell)pri <= (ucell)alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JGRTR:
+      if ((ucell)pri > (ucell)alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JGEQ:
+      if ((ucell)pri >= (ucell)alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JSLESS:
+      if (pri < alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JSLEQ:
+      if (pri <= alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JSGRTR:
+      if (pri > alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_JSGEQ:
+      if (pri >= alt) JUMP(); else SKIPPARAM();
+      break;
+    case OP_SHL:
+      pri = (cell)((ucell)pri << alt);
+      break;
+    case OP_SHR:
+      pri = (cell)((ucell)pri >> alt);
+      break;
+    case OP_SSHR:
+      pri >>= alt;
+      break;
+    case OP_SHL_C_PRI:
+      GETPARAM(offs);
+      pri = (cell)((ucell)pri << offs);
+      break;
+    case OP_SHL_C_ALT:
+      GETPARAM(offs);
+      alt = (cell)((ucell)alt << offs);
+      break;
+    case OP_SHR_C_PRI:
+      GETPARAM(offs);
+      pri = (cell)((ucell)pri >> offs);
+      break;
+    case OP_SHR_C_ALT:
+      GETPARAM(offs);
+      alt = (cell)((ucell)alt >> offs);
+      break;
+    case OP_SMUL:
+      pri = (cell)((ucell)pri * (ucell)alt);
+      break;
+    case OP_SDIV_ALT:
+      offs = pri;
+      pri = alt;
+      alt = offs;
+      /* fall through */
+    case OP_SDIV:
+      /* floored division: pri = pri / alt, alt = pri mod alt */
+      if (alt == 0)
+        ABORT(amx, AMX_ERR_DIVIDE);
+      if (alt == -1) {
+        pri = (cell)(0 - (ucell)pri);
+        alt = 0;
+        break;
+      } /* if */
+      val = pri / alt;
+      offs = pri % alt;
+      if (offs != 0 && (offs ^ alt) < 0) {
+        val--;
+        offs += alt;
+      } /* if */
+      pri = val;
+      alt = offs;
+      break;
+    case OP_UMUL:
+      pri = (cell)((ucell)pri * (ucell)alt);
+      break;
+    case OP_UDIV_ALT:
+      offs = pri;
+      pri = alt;
+      alt = offs;
+      /* fall through */
+    case OP_UDIV:
+      if (alt == 0)
+        ABORT(amx, AMX_ERR_DIVIDE);
+      val = (cell)((ucell)pri / (ucell)alt);
+      alt = (cell)((ucell)pri % (ucell)alt);
+      pri = val;
+      break;
+    case OP_ADD:
+      pri = (cell)((ucell)pri + (ucell)alt);
+      break;
+    case OP_SUB:
+      pri = (cell)((ucell)pri - (ucell)alt);
+      break;
+    case OP_SUB_ALT:
+      pri = (cell)((ucell)alt - (ucell)pri);
+      break;
+    case OP_AND:
+      pri &= alt;
+      break;
+    case OP_OR:
+      pri |= alt;
+      break;
+    case OP_XOR:
+      pri ^= alt;
+      break;
+    case OP_NOT:
+      pri = !pri;
+      break;
+    case OP_NEG:
+      pri = (cell)(0 - (ucell)pri);
+      break;
+    case OP_INVERT:
+      pri = ~pri;
+      break;
+    case OP_ADD_C:
+      GETPARAM(offs);
+      pri = (cell)((ucell)pri + (ucell)offs);
+      break;
+    case OP_SMUL_C:
+      GETPARAM(offs);
+      pri = (cell)((ucell)pri * (ucell)offs);
+      break;
+    case OP_ZERO_PRI:
+      pri = 0;
+      break;
+    case OP_ZERO_ALT:
+      alt = 0;
+      break;
+    case OP_ZERO:
+      GETPARAM(offs);
+      _R(offs) = 0;
+      break;
+    case OP_ZERO_S:
+      GETPARAM(offs);
+      _R(frm + offs) = 0;
+      break;
+    case OP_SIGN_PRI:
+      if ((pri & 0x80) != 0)
+        pri |= ~(cell)0xff;
+      break;
+    case OP_SIGN_ALT:
+      if ((alt & 0x80) != 0)
+        alt |= ~(cell)0xff;
+      break;
+    case OP_EQ:
+      pri = pri == alt;
+      break;
+    case OP_NEQ:
+      pri = pri != alt;
+      break;
+    case OP_LESS:
+      pri = (ucell)pri < (ucell)alt;
+      break;
+    case OP_LEQ:
+      pri = (ucell)pri <= (ucell)alt;
+      break;
+    case OP_GRTR:
+      pri = (ucell)pri > (ucell)alt;
+      break;
+    case OP_GEQ:
+      pri = (ucell)pri >= (ucell)alt;
+      break;
+    case OP_SLESS:
+      pri = pri < alt;
+      break;
+    case OP_SLEQ:
+      pri = pri <= alt;
+      break;
+    case OP_SGRTR:
+      pri = pri > alt;
+      break;
+    case OP_SGEQ:
+      pri = pri >= alt;
+      break;
+    case OP_EQ_C_PRI:
+      GETPARAM(offs);
+      pri = pri == offs;
+      break;
+    case OP_EQ_C_ALT:
+      GETPARAM(offs);
+      pri = alt == offs;
+      break;
+    case OP_INC_PRI:
+      pri++;
+      break;
+    case OP_INC_ALT:
+      alt++;
+      break;
+    case OP_INC:
+      GETPARAM(offs);
+      _R(offs)++;
+      break;
+    case OP_INC_S:
+      GETPARAM(offs);
+      _R(frm + offs)++;
+      break;
+    case OP_INC_I:
+      VERIFYADDRESS(pri);
+      _R(pri)++;
+      break;
+    case OP_DEC_PRI:
+      pri--;
+      break;
+    case OP_DEC_ALT:
+      alt--;
+      break;
+    case OP_DEC:
+      GETPARAM(offs);
+      _R(offs)--;
+      break;
+    case OP_DEC_S:
+      GETPARAM(offs);
+      _R(frm + offs)--;
+      break;
+    case OP_DEC_I:
+      VERIFYADDRESS(pri);
+      _R(pri)--;
+      break;
+    case OP_MOVS:
+      GETPARAM(offs);
+      VERIFYADDRESS(pri);
+      VERIFYADDRESS(pri + offs - 1);
+      VERIFYADDRESS(alt);
+      VERIFYADDRESS(alt + offs - 1);
+      memmove(data + alt, data + pri, (size_t)offs);
+      break;
+    case OP_CMPS:
+      GETPARAM(offs);
+      VERIFYADDRESS(pri);
+      VERIFYADDRESS(pri + offs - 1);
+      VERIFYADDRESS(alt);
+      VERIFYADDRESS(alt + offs - 1);
+      pri = memcmp(data + alt, data + pri, (size_t)offs);
+      break;
+    case OP_FILL:
+      GETPARAM(offs);
+      VERIFYADDRESS(alt);
+      VERIFYADDRESS(alt + offs - 1);
+      for (val = alt; offs >= (cell)sizeof(cell); val += sizeof(cell), offs -= sizeof(cell))
+        _R(val) = pri;
+      break;
+    case OP_HALT:
+      GETPARAM(offs);
+      if (retval != NULL)
+        *retval = pri;
+      amx->frm = frm;
+      amx->pri = pri;
+      amx->alt = alt;
+      amx->cip = (cell)((unsigned char *)cip - code);
+      if (offs == AMX_ERR_SLEEP)
+        SLEEP(offs);
+      ABORT(amx, (int)offs);
+    case OP_BOUNDS:
+      GETPARAM(offs);
+      if ((ucell)pri > (ucell)offs) {
+        amx->cip = (cell)((unsigned char *)cip - code);
+        ABORT(amx, AMX_ERR_BOUNDS);
+      } /* if */
+      break;
+    case OP_SYSREQ_PRI:
+      SYSREQ(pri);
+      break;
+    case OP_SYSREQ_C:
+      GETPARAM(offs);
+      SYSREQ(offs);
+      break;
+    case OP_JUMP_PRI:
+      cip = (cell *)(code + pri);
+      break;
+    case OP_SWITCH:
+      /* skip the CASETBL opcode, then: count, default, value/target pairs */
+      cptr = JUMPTARGET(code, *cip) + 1;
+      num = (int)cptr[0];
+      cip = JUMPTARGET(code, cptr[1]);
+      for (i = 0; i < num; i++) {
+        if (cptr[2 + 2 * i] == pri) {
+          cip = JUMPTARGET(code, cptr[3 + 2 * i]);
+          break;
+        } /* if */
+      } /* for */
+      break;
+    case OP_SWAP_PRI:
+      offs = _R(stk);
+      _R(stk) = pri;
+      pri = offs;
+      break;
+    case OP_SWAP_ALT:
+      offs = _R(stk);
+      _R(stk) = alt;
+      alt = offs;
+      break;
+    case OP_PUSH_ADR:
+      GETPARAM(offs);
+      PUSH(frm + offs);
+      break;
+    case OP_NOP:
+      break;
+    case OP_BREAK:
+      if (amx->debug != NULL) {
+        amx->cip = (cell)((unsigned char *)cip - code);
+        amx->frm = frm;
+        amx->stk = stk;
+        amx->hea = hea;
+        num = amx->debug(amx);
+        if (num != AMX_ERR_NONE) {
+          if (num == AMX_ERR_SLEEP)
+            SLEEP(num);
+          ABORT(amx, num);
+        } /* if */
+      } /* if */
+      break;
+    default:
+      /* OP_SYSREQ_D is never patched in since natives are called through
+       * amx->callback, the rest is rejected by amx_Init() */
+      ABORT(amx, AMX_ERR_INVINSTR);
+    } /* switch */
+  } /* for */
+}
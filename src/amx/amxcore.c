@@ -0,0 +1,220 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+/* Core natives of the Pawn toolkit ("core.inc") for the VM in amx.c.
+ * Property and time functions are not included, amxprof-run replaces them
+ * with stubs like any other unknown native.
+ */
+
+#include "amx.h"
+
+#define CHARBITS  (8 * sizeof(char))
+
+static cell *get_arg_addr(AMX *amx, cell arg, cell index)
+{
+  cell *frame, *arg_addr, *value_addr;
+
+  /* the caller's frame: saved frame, return address, size of arguments,
+   * arguments */
+  if (amx_GetAddr(amx, amx->frm, &frame) != AMX_ERR_NONE)
+    return NULL;
+  if (arg < 0 || arg >= frame[2] / (cell)sizeof(cell))
+    return NULL;
+  arg_addr = frame + 3 + arg;
+  if (amx_GetAddr(amx, *arg_addr + index * (cell)sizeof(cell),
+                  &value_addr) != AMX_ERR_NONE)
+    return NULL;
+  return value_addr;
+}
+
+/* numargs() */
+static cell AMX_NATIVE_CALL n_numargs(AMX *amx, cell *params)
+{
+  cell *frame;
+
+  (void)params;
+  if (amx_GetAddr(amx, amx->frm, &frame) != AMX_ERR_NONE)
+    return 0;
+  return frame[2] / (cell)sizeof(cell);
+}
+
+/* getarg(arg, index=0) */
+static cell AMX_NATIVE_CALL n_getarg(AMX *amx, cell *params)
+{
+  cell *value = get_arg_addr(amx, params[1], params[2]);
+
+  if (value == NULL) {
+    amx_RaiseError(amx, AMX_ERR_NATIVE);
+    return 0;
+  } /* if */
+  return *value;
+}
+
+/* setarg(arg, index=0, value) */
+static cell AMX_NATIVE_CALL n_setarg(AMX *amx, cell *params)
+{
+  cell *value = get_arg_addr(amx, params[1], params[2]);
+
+  if (value == NULL)
+    return 0;
+  *value = params[3];
+  return 1;
+}
+
+/* heapspace() */
+static cell AMX_NATIVE_CALL n_heapspace(AMX *amx, cell *params)
+{
+  (void)params;
+  return amx->stk - amx->hea;
+}
+
+/* funcidx(const name[]) */
+static cell AMX_NATIVE_CALL n_funcidx(AMX *amx, cell *params)
+{
+  char name[sNAMEMAX + 1];
+  cell *cstr;
+  int index;
+
+  if (amx_GetAddr(amx, params[1], &cstr) != AMX_ERR_NONE)
+    return -1;
+  amx_GetString(name, cstr, 0, sizeof name);
+  if (amx_FindPublic(amx, name, &index) != AMX_ERR_NONE)
+    return -1;
+  return index;
+}
+
+/* strlen(const string[]) */
+static cell AMX_NATIVE_CALL n_strlen(AMX *amx, cell *params)
+{
+  cell *cstr;
+  int len;
+
+  if (amx_GetAddr(amx, params[1], &cstr) != AMX_ERR_NONE)
+    return 0;
+  amx_StrLen(cstr, &len);
+  return len;
+}
+
+/* tolower(c) */
+static cell AMX_NATIVE_CALL n_tolower(AMX *amx, cell *params)
+{
+  (void)amx;
+  if (params[1] >= 'A' && params[1] <= 'Z')
+    return params[1] - 'A' + 'a';
+  return params[1];
+}
+
+/* toupper(c) */
+static cell AMX_NATIVE_CALL n_toupper(AMX *amx, cell *params)
+{
+  (void)amx;
+  if (params[1] >= 'a' && params[1] <= 'z')
+    return params[1] - 'a' + 'A';
+  return params[1];
+}
+
+/* swapchars(c) */
+static cell AMX_NATIVE_CALL n_swapchars(AMX *amx, cell *params)
+{
+  ucell c = (ucell)params[1], r = 0;
+  size_t i;
+
+  (void)amx;
+  for (i = 0; i < sizeof(cell); i++) {
+    r = (r << CHARBITS) | (c & 0xff);
+    c >>= CHARBITS;
+  } /* for */
+  return (cell)r;
+}
+
+/* random(max) */
+static cell AMX_NATIVE_CALL n_random(AMX *amx, cell *params)
+{
+  static unsigned long seed = 1;
+
+  (void)amx;
+  /* the LCG from the C standard, runs must be reproducible */
+  seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+  if (params[1] <= 0)
+    return 0;
+  return (cell)((seed >> 16) % (unsigned long)params[1]);
+}
+
+/* min(value1, value2) */
+static cell AMX_NATIVE_CALL n_min(AMX *amx, cell *params)
+{
+  (void)amx;
+  return params[1] <= params[2] ? params[1] : params[2];
+}
+
+/* max(value1, value2) */
+static cell AMX_NATIVE_CALL n_max(AMX *amx, cell *params)
+{
+  (void)amx;
+  return params[1] >= params[2] ? params[1] : params[2];
+}
+
+/* clamp(value, min=cellmin, max=cellmax) */
+static cell AMX_NATIVE_CALL n_clamp(AMX *amx, cell *params)
+{
+  cell value = params[1];
+
+  if (params[2] > params[3]) {
+    amx_RaiseError(amx, AMX_ERR_NATIVE);
+    return value;
+  } /* if */
+  if (value < params[2])
+    value = params[2];
+  else if (value > params[3])
+    value = params[3];
+  return value;
+}
+
+static const AMX_NATIVE_INFO core_natives[] = {
+  { "numargs",   n_numargs },
+  { "getarg",    n_getarg },
+  { "setarg",    n_setarg },
+  { "heapspace", n_heapspace },
+  { "funcidx",   n_funcidx },
+  { "strlen",    n_strlen },
+  { "tolower",   n_tolower },
+  { "toupper",   n_toupper },
+  { "swapchars", n_swapchars },
+  { "random",    n_random },
+  { "min",       n_min },
+  { "max",       n_max },
+  { "clamp",     n_clamp },
+  { NULL, NULL }
+};
+
+int AMXAPI amx_CoreInit(AMX *amx)
+{
+  return amx_Register(amx, core_natives, -1);
+}
+
+int AMXAPI amx_CoreCleanup(AMX *amx)
+{
+  (void)amx;
+  return AMX_ERR_NONE;
+}
@@ -31,6 +31,8 @@
 template<typename T>
 class AMXHandler {
  public:
+  typedef std::map<AMX*, T*> HandlerMap;
+
   AMXHandler(AMX *amx) : amx_(amx) {}
 
   AMX *amx() const { return amx_; }
@@ -40,11 +42,12 @@ class AMXHandler {
   static T *GetHandler(AMX *amx);
   static void DestroyHandler(AMX *amx);
 
+  static const HandlerMap &GetHandlers() { return handlers_; }
+
  private:
   AMX *amx_;
 
  private:
-  typedef std::map<AMX*, T*> HandlerMap;
   static HandlerMap handlers_;
 };
 
@@ -23,6 +23,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include <cassert>
+#include <vector>
 #include "amx_utils.h"
 
 namespace amxprof {
@@ -64,13 +65,13 @@ unsigned char *GetAmxCodePtr(AMX *amx) {
   return amx->base + GetAmxHeader(amx)->cod;
 }
 
+} // anonymous namespace
+
 unsigned char *GetAmxDataPtr(AMX *amx) {
   return (amx->data != 0) ? amx->data
                           : amx->base + GetAmxHeader(amx)->dat;
 }
 
-} // anonymous namespace
-
 cell RelocateOpcode(cell opcode) {
   #ifdef AMXPROF_RELOCATE_OPCODES
     static cell *opcode_table = GetOpcodeTable();
@@ -167,4 +168,16 @@ Address GetCalleeAddress(AMX *amx, Address frame) {
   return target - reinterpret_cast<Address>(code);
 }
 
+std::string GetAmxString(AMX *amx, cell address) {
+  cell *string;
+  int length;
+  if (amx_GetAddr(amx, address, &string) != AMX_ERR_NONE
+      || amx_StrLen(string, &length) != AMX_ERR_NONE) {
+    return std::string();
+  }
+  std::vector<char> buffer(length + 1);
+  amx_GetString(&buffer[0], string, 0, buffer.size());
+  return std::string(&buffer[0]);
+}
+
 } // naemspace amxprof
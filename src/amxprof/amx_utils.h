@@ -25,6 +25,7 @@
 #ifndef AMXPROF_AMX_UTILS_H
 #define AMXPROF_AMX_UTILS_H
 
+#include <string>
 #include "amx_types.h"
 
 namespace amxprof {
@@ -81,6 +82,10 @@ enum {
 
 cell RelocateOpcode(cell opcode);
 
+// Returns the start of the data section, which is what AMX addresses of
+// variables are relative to.
+unsigned char *GetAmxDataPtr(AMX *amx);
+
 Address GetNativeAddress(AMX *amx, NativeTableIndex index);
 Address GetPublicAddress(AMX *amx, PublicTableIndex index);
 
@@ -90,6 +95,10 @@ const char *GetPublicName(AMX *amx, PublicTableIndex index);
 Address GetReturnAddress(AMX *amx, Address frame);
 Address GetCalleeAddress(AMX *amx, Address frame);
 
+// Reads a string from the AMX data section, e.g. one passed to a native.
+// Returns an empty string if the address is invalid.
+std::string GetAmxString(AMX *amx, cell address);
+
 } // naemspace amxprof
 
 #endif // !AMXPROF_AMX_UTILS_H
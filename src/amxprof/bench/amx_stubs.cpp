@@ -0,0 +1,135 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// The benchmark doesn't link against the Pawn VM. These are the few AMX
+// API functions used by amxprof, implemented on top of SyntheticScript.
+
+#include <amx/amx.h>
+#include <amxprof/amx_utils.h>
+#include "synthetic_script.h"
+
+using amxprof::bench::SyntheticScript;
+
+namespace {
+
+int GetNumEntries(AMX *amx, int32_t start, int32_t end) {
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(amx->base);
+  return (end - start) / hdr->defsize;
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+int AMXAPI amx_Exec(AMX *amx, cell *retval, int index) {
+  if ((amx->flags & AMX_FLAG_BROWSE) != 0) {
+    // RelocateOpcode() asks for the opcode table; the synthetic image
+    // stores plain opcode numbers.
+    static cell opcodes[amxprof::NUM_OPCODES];
+    for (int i = 0; i < amxprof::NUM_OPCODES; i++) {
+      opcodes[i] = i;
+    }
+    *reinterpret_cast<cell**>(retval) = opcodes;
+    return AMX_ERR_NONE;
+  }
+  return SyntheticScript::FromAmx(amx)->Exec(retval, index);
+}
+
+int AMXAPI amx_Callback(AMX *amx, cell index, cell *result, cell *params) {
+  (void)amx;
+  (void)index;
+  (void)params;
+  *result = 0;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_FindPublic(AMX *amx, const char *name, int *index) {
+  // Synthetic publics have no names.
+  (void)amx;
+  (void)name;
+  *index = 0;
+  return AMX_ERR_NOTFOUND;
+}
+
+int AMXAPI amx_GetAddr(AMX *amx, cell amx_addr, cell **phys_addr) {
+  if (amx_addr < 0
+      || (amx_addr >= amx->hea && amx_addr < amx->stk)
+      || amx_addr >= amx->stp) {
+    *phys_addr = 0;
+    return AMX_ERR_MEMACCESS;
+  }
+  *phys_addr = reinterpret_cast<cell*>(amxprof::GetAmxDataPtr(amx) + amx_addr);
+  return AMX_ERR_NONE;
+}
+
+// Strings are only read by natives and zones, which synthetic scripts
+// don't pass, so packed strings are not supported.
+int AMXAPI amx_StrLen(const cell *cstring, int *length) {
+  int len = 0;
+  while (cstring[len] != 0) {
+    len++;
+  }
+  *length = len;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_GetString(char *dest, const cell *source, int use_wchar,
+                         size_t size) {
+  (void)use_wchar;
+  size_t i = 0;
+  for (; i + 1 < size && source[i] != 0; i++) {
+    dest[i] = static_cast<char>(source[i]);
+  }
+  if (size > 0) {
+    dest[i] = '\0';
+  }
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Flags(AMX *amx, uint16_t *flags) {
+  *flags = reinterpret_cast<AMX_HEADER*>(amx->base)->flags;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_NumNatives(AMX *amx, int *number) {
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(amx->base);
+  *number = GetNumEntries(amx, hdr->natives, hdr->libraries);
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_NumPublics(AMX *amx, int *number) {
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(amx->base);
+  *number = GetNumEntries(amx, hdr->publics, hdr->natives);
+  return AMX_ERR_NONE;
+}
+
+uint16_t * AMXAPI amx_Align16(uint16_t *v) {
+  return v;
+}
+
+uint32_t * AMXAPI amx_Align32(uint32_t *v) {
+  return v;
+}
+
+} // extern "C"
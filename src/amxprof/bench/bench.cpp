@@ -0,0 +1,337 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// amxprof-bench measures the cost of the profiler hooks and the speed of
+// the report writers. Results are printed to stdout as JSON.
+//
+// Usage: amxprof-bench [--depth=N] [--fanout=N] [--recursion=N]
+//                      [--natives=N] [--iterations=N] [--functions=N]
+//                      [--repeat=N] [--clock=system|tsc]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <amxprof/call_graph.h>
+#include <amxprof/call_graph_writer_dot.h>
+#include <amxprof/clock.h>
+#include <amxprof/function.h>
+#include <amxprof/function_statistics.h>
+#include <amxprof/profiler.h>
+#include <amxprof/statistics.h>
+#include <amxprof/statistics_writer_html.h>
+#include <amxprof/statistics_writer_json.h>
+#include <amxprof/statistics_writer_text.h>
+#include "synthetic_script.h"
+
+using namespace amxprof;
+using amxprof::bench::ScriptShape;
+using amxprof::bench::SyntheticScript;
+
+namespace {
+
+struct Options {
+  Options()
+   : iterations(10000),
+     functions(100000),
+     repeat(3),
+     clock("system")
+  {}
+
+  ScriptShape shape;
+  int iterations;  // public function calls per hook benchmark
+  int functions;   // size of the statistics given to the writers
+  int repeat;      // writer runs, the fastest one is reported
+  std::string clock;  // clock used by the profiler
+};
+
+struct HookBenchmark {
+  const char *name;
+  SyntheticScript::Mode mode;
+  bool call_graph;
+  bool lines;
+};
+
+const HookBenchmark kHookBenchmarks[] = {
+  {"exec",                 SyntheticScript::EXEC_ONLY, false, false},
+  {"natives",              SyntheticScript::NATIVES,   false, false},
+  {"functions",            SyntheticScript::FUNCTIONS, false, false},
+  {"functions_call_graph", SyntheticScript::FUNCTIONS, true,  false},
+  {"functions_lines",      SyntheticScript::FUNCTIONS, false, true}
+};
+
+bool ParseOption(const char *arg, const char *name, int *value) {
+  std::size_t length = std::strlen(name);
+  if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') {
+    return false;
+  }
+  *value = std::atoi(arg + length + 1);
+  return true;
+}
+
+bool ParseOption(const char *arg, const char *name, std::string *value) {
+  std::size_t length = std::strlen(name);
+  if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') {
+    return false;
+  }
+  *value = arg + length + 1;
+  return true;
+}
+
+bool ParseOptions(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (!ParseOption(arg, "--depth", &options->shape.depth)
+        && !ParseOption(arg, "--fanout", &options->shape.fanout)
+        && !ParseOption(arg, "--recursion", &options->shape.recursion)
+        && !ParseOption(arg, "--natives", &options->shape.natives)
+        && !ParseOption(arg, "--iterations", &options->iterations)
+        && !ParseOption(arg, "--functions", &options->functions)
+        && !ParseOption(arg, "--repeat", &options->repeat)
+        && !ParseOption(arg, "--clock", &options->clock)) {
+      std::fprintf(stderr, "Unknown option: %s\n", arg);
+      return false;
+    }
+  }
+  if (options->shape.depth < 0
+      || options->shape.fanout < 1
+      || options->shape.recursion < 0
+      || options->shape.natives < 0
+      || options->iterations < 1
+      || options->functions < 1
+      || options->repeat < 1
+      || (options->clock != "system" && options->clock != "tsc")) {
+    std::fprintf(stderr, "Invalid option value\n");
+    return false;
+  }
+  return true;
+}
+
+Nanoseconds RunScript(SyntheticScript *script, Profiler *profiler,
+                      int iterations) {
+  AMX *amx = script->amx();
+  int num_publics = 0;
+  amx_NumPublics(amx, &num_publics);
+
+  script->set_profiler(profiler);
+  Clock *clock = SystemClock::GetInstance();
+  TimePoint start = clock->Now();
+  for (int i = 0; i < iterations; i++) {
+    cell retval;
+    if (profiler != 0) {
+      profiler->ExecHook(&retval, i % num_publics);
+    } else {
+      amx_Exec(amx, &retval, i % num_publics);
+    }
+  }
+  return clock->Now() - start;
+}
+
+void RunHookBenchmark(const HookBenchmark &benchmark, const Options &options,
+                      Clock *clock, std::ostream &out) {
+  SyntheticScript script(options.shape);
+  script.set_mode(benchmark.mode);
+
+  // The cost of running the script without the profiler is subtracted
+  // so that only the time spent in the hooks is counted.
+  RunScript(&script, 0, options.iterations);
+  Nanoseconds baseline_time = RunScript(&script, 0, options.iterations);
+
+  Profiler profiler(script.amx(), benchmark.call_graph, clock);
+  profiler.set_line_stats_enabled(benchmark.lines);
+
+  // Warm up: the first call of each function creates its statistics.
+  RunScript(&script, &profiler, options.iterations);
+
+  uint64_t num_events = profiler.num_events();
+  Nanoseconds time = RunScript(&script, &profiler, options.iterations);
+  num_events = profiler.num_events() - num_events;
+
+  double ns_per_event = 0;
+  if (num_events > 0) {
+    ns_per_event = (time - baseline_time).count() / num_events;
+  }
+
+  out << "    {\"name\": \"" << benchmark.name << "\", "
+      << "\"events\": " << num_events << ", "
+      << "\"time_ns\": " << time.count() << ", "
+      << "\"baseline_ns\": " << baseline_time.count() << ", "
+      << "\"ns_per_event\": " << ns_per_event << "}";
+}
+
+// Builds statistics for a number of functions arranged in a tree, each
+// with some made up times.
+void FillStatistics(int num_functions, int fanout,
+                    Statistics *stats,
+                    CallGraph *call_graph,
+                    std::vector<Function*> *functions) {
+  std::vector<CallGraphNode*> nodes;
+  unsigned int seed = 1;
+
+  for (int i = 0; i < num_functions; i++) {
+    Address address = (i + 1) * sizeof(cell);
+    Function *fn = Function::Normal(address);
+    functions->push_back(fn);
+    stats->AddFunction(fn);
+
+    seed = seed * 1103515245 + 12345;
+    long num_calls = 1 + (seed >> 16) % 1000;
+    FunctionStatistics *fn_stats = stats->GetFunctionStatistics(address);
+    fn_stats->AdjustNumCalls(num_calls);
+    fn_stats->AdjustNumTimedCalls(num_calls);
+    fn_stats->AdjustSelfTime(Nanoseconds(num_calls * 250.0));
+    fn_stats->AdjustTotalTime(Nanoseconds(num_calls * 1000.0));
+    fn_stats->set_worst_self_time(Nanoseconds(500.0));
+    fn_stats->set_worst_total_time(Nanoseconds(2000.0));
+
+    if (i == 0) {
+      call_graph->set_root(call_graph->sentinel());
+    } else {
+      call_graph->set_root(nodes[(i - 1) / fanout]);
+    }
+    CallGraphEdge *edge = call_graph->AddCallee(fn_stats);
+    edge->AdjustNumCalls(num_calls);
+    edge->AdjustTime(fn_stats->total_time());
+    nodes.push_back(edge->callee());
+  }
+
+  call_graph->set_root(call_graph->sentinel());
+}
+
+void WriteReport(StatisticsWriter *writer, const Statistics *stats,
+                 const CallGraph *) {
+  writer->Write(stats);
+}
+
+void WriteReport(CallGraphWriter *writer, const Statistics *,
+                 const CallGraph *call_graph) {
+  writer->set_root_node_name("SA-MP Server");
+  writer->Write(call_graph);
+}
+
+template<typename Writer>
+void RunWriterBenchmark(const char *name, const Options &options,
+                        const Statistics *stats, const CallGraph *call_graph,
+                        std::ostream &out) {
+  Clock *clock = SystemClock::GetInstance();
+  Nanoseconds best_time;
+  std::size_t size = 0;
+
+  for (int i = 0; i < options.repeat; i++) {
+    std::ostringstream stream;
+    Writer writer;
+    writer.set_stream(&stream);
+    writer.set_script_name("bench");
+
+    TimePoint start = clock->Now();
+    WriteReport(&writer, stats, call_graph);
+    Nanoseconds time = clock->Now() - start;
+
+    if (i == 0 || time < best_time) {
+      best_time = time;
+    }
+    size = stream.str().size();
+  }
+
+  double mb_per_s = 0;
+  if (best_time.count() > 0) {
+    mb_per_s = size / Seconds(best_time).count() / 1e6;
+  }
+
+  out << "    {\"name\": \"" << name << "\", "
+      << "\"functions\": " << options.functions << ", "
+      << "\"bytes\": " << size << ", "
+      << "\"time_ns\": " << best_time.count() << ", "
+      << "\"mb_per_s\": " << mb_per_s << "}";
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    return EXIT_FAILURE;
+  }
+
+  std::ostream &out = std::cout;
+  out << std::fixed << std::setprecision(2);
+
+  out << "{\n"
+      << "  \"options\": {"
+      << "\"depth\": " << options.shape.depth << ", "
+      << "\"fanout\": " << options.shape.fanout << ", "
+      << "\"recursion\": " << options.shape.recursion << ", "
+      << "\"natives\": " << options.shape.natives << ", "
+      << "\"iterations\": " << options.iterations << ", "
+      << "\"functions\": " << options.functions << ", "
+      << "\"repeat\": " << options.repeat << ", "
+      << "\"clock\": \"" << options.clock << "\"},\n";
+
+  SystemClock system_clock;
+  TscClock *tsc_clock = 0;
+  Clock *clock = &system_clock;
+  if (options.clock == "tsc") {
+    clock = tsc_clock = new TscClock;
+  }
+
+  out << "  \"hooks\": [\n";
+  std::size_t num_hook_benchmarks =
+    sizeof(kHookBenchmarks) / sizeof(*kHookBenchmarks);
+  for (std::size_t i = 0; i < num_hook_benchmarks; i++) {
+    RunHookBenchmark(kHookBenchmarks[i], options, clock, out);
+    out << (i + 1 < num_hook_benchmarks ? ",\n" : "\n");
+  }
+  out << "  ],\n";
+  delete tsc_clock;
+
+  Statistics stats;
+  CallGraph call_graph;
+  std::vector<Function*> functions;
+  FillStatistics(options.functions, options.shape.fanout,
+                 &stats, &call_graph, &functions);
+
+  out << "  \"writers\": [\n";
+  RunWriterBenchmark<StatisticsWriterText>("text", options,
+                                           &stats, &call_graph, out);
+  out << ",\n";
+  RunWriterBenchmark<StatisticsWriterHtml>("html", options,
+                                           &stats, &call_graph, out);
+  out << ",\n";
+  RunWriterBenchmark<StatisticsWriterJson>("json", options,
+                                           &stats, &call_graph, out);
+  out << ",\n";
+  RunWriterBenchmark<CallGraphWriterDot>("dot", options,
+                                         &stats, &call_graph, out);
+  out << "\n  ]\n}\n";
+
+  for (std::size_t i = 0; i < functions.size(); i++) {
+    delete functions[i];
+  }
+
+  return EXIT_SUCCESS;
+}
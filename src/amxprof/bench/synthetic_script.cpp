@@ -0,0 +1,292 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <amxprof/amx_utils.h>
+#include <amxprof/profiler.h>
+#include "synthetic_script.h"
+
+namespace amxprof {
+namespace bench {
+
+namespace {
+
+const int kNumPublics = 4;
+
+// Cells occupied by a stack frame: argument size, return address and the
+// saved frame pointer.
+const int kFrameSize = 3;
+
+// Size of the global variables' area at the start of the data section.
+const int kNumGlobals = 16;
+
+int GetRegionSize(const ScriptShape &shape) {
+  // PROC, a statement and one CALL per callee plus one for recursion.
+  return (2 + 2 * (shape.fanout + 1)) * sizeof(cell);
+}
+
+std::string MakeName(const char *prefix, int index) {
+  char buffer[32];
+  std::sprintf(buffer, "%s%d", prefix, index);
+  return buffer;
+}
+
+} // anonymous namespace
+
+SyntheticScript::SyntheticScript(const ScriptShape &shape)
+ : shape_(shape),
+   mode_(FUNCTIONS),
+   profiler_(0)
+{
+  int num_natives = shape_.natives;
+  int num_regions = kNumPublics + num_functions();
+
+  std::string names;
+  std::vector<int> name_offsets;
+
+  int publics = sizeof(AMX_HEADER);
+  int natives = publics + kNumPublics * sizeof(AMX_FUNCSTUBNT);
+  int libraries = natives + num_natives * sizeof(AMX_FUNCSTUBNT);
+  int nametable = libraries;
+
+  for (int i = 0; i < kNumPublics; i++) {
+    name_offsets.push_back(nametable + static_cast<int>(names.size()));
+    names.append(MakeName("OnBench", i));
+    names.push_back('\0');
+  }
+  for (int i = 0; i < num_natives; i++) {
+    name_offsets.push_back(nametable + static_cast<int>(names.size()));
+    names.append(MakeName("bench_native", i));
+    names.push_back('\0');
+  }
+
+  int cod = (nametable + static_cast<int>(names.size()) + sizeof(cell) - 1)
+            & ~static_cast<int>(sizeof(cell) - 1);
+  // One more region at the end to keep the last return address inside the
+  // code section.
+  int code_size = (num_regions + 2) * GetRegionSize(shape_);
+  int dat = cod + code_size;
+  int max_frames = shape_.depth + shape_.recursion + 2;
+  int globals_size = kNumGlobals * sizeof(cell);
+  int data_size = globals_size + (max_frames * kFrameSize + 16) * sizeof(cell);
+
+  image_.assign(dat + data_size, 0);
+
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(&image_[0]);
+  hdr->size = static_cast<int32_t>(image_.size());
+  hdr->magic = AMX_MAGIC;
+  hdr->file_version = CUR_FILE_VERSION;
+  hdr->amx_version = MIN_AMX_VERSION;
+  hdr->defsize = sizeof(AMX_FUNCSTUBNT);
+  hdr->cod = cod;
+  hdr->dat = dat;
+  hdr->hea = dat + globals_size;
+  hdr->stp = dat + data_size;
+  hdr->cip = GetRegion(0);
+  hdr->publics = publics;
+  hdr->natives = natives;
+  hdr->libraries = libraries;
+  hdr->pubvars = libraries;
+  hdr->tags = libraries;
+  hdr->nametable = nametable;
+
+  AMX_FUNCSTUBNT *public_table =
+    reinterpret_cast<AMX_FUNCSTUBNT*>(&image_[publics]);
+  for (int i = 0; i < kNumPublics; i++) {
+    public_table[i].address = GetRegion(i);
+    public_table[i].nameofs = name_offsets[i];
+  }
+
+  // Natives don't have code in the image. Real native addresses point to
+  // the C functions; here we only need them to be unique.
+  AMX_FUNCSTUBNT *native_table =
+    reinterpret_cast<AMX_FUNCSTUBNT*>(&image_[natives]);
+  for (int i = 0; i < num_natives; i++) {
+    native_table[i].address = code_size + i * sizeof(cell);
+    native_table[i].nameofs = name_offsets[kNumPublics + i];
+  }
+
+  std::memcpy(&image_[nametable], names.data(), names.size());
+
+  // Emit a CALL instruction at each call site. The targets are relocated
+  // like the VM does it on load, i.e. they are absolute addresses.
+  unsigned char *code = &image_[cod];
+  cell code_base = static_cast<cell>(reinterpret_cast<std::size_t>(code));
+
+  for (int region = 0; region < num_regions; region++) {
+    int level = (region < kNumPublics) ? -1
+                                       : (region - kNumPublics) / shape_.fanout;
+    int index = (region < kNumPublics) ? 0
+                                       : (region - kNumPublics) % shape_.fanout;
+    *reinterpret_cast<cell*>(code + GetRegion(region)) = OP_PROC;
+    for (int site = 0; site <= shape_.fanout; site++) {
+      int callee;
+      if (site < shape_.fanout) {
+        if (level + 1 >= shape_.depth) {
+          continue;
+        }
+        callee = kNumPublics + (level + 1) * shape_.fanout + site;
+      } else {
+        if (level < 0) {
+          continue;
+        }
+        callee = kNumPublics + level * shape_.fanout + index;
+      }
+      cell *instr = reinterpret_cast<cell*>(code + GetCallSite(region, site));
+      instr[0] = OP_CALL;
+      instr[1] = code_base + GetRegion(callee);
+    }
+  }
+
+  std::memset(&amx_, 0, sizeof(amx_));
+  amx_.base = &image_[0];
+  amx_.flags = AMX_FLAG_NTVREG | AMX_FLAG_RELOC;
+  amx_.cip = hdr->cip;
+  amx_.hea = globals_size;
+  amx_.hlw = globals_size;
+  amx_.stp = data_size;
+  amx_.stk = data_size;
+  amx_.frm = 0;
+  amx_.userdata[0] = this;
+}
+
+int SyntheticScript::Exec(cell *retval, int index) {
+  if (index < 0 || index >= kNumPublics) {
+    return AMX_ERR_INDEX;
+  }
+
+  // amx_Exec() pushes the size of the arguments and a zero return address,
+  // then the function saves the frame pointer in its PROC instruction.
+  Push(0);
+  Push(0);
+  Push(amx_.frm);
+  amx_.frm = amx_.stk;
+
+  if (mode_ != EXEC_ONLY) {
+    RunBody(index, -1, 0, 0);
+  }
+
+  amx_.stk = amx_.frm;
+  amx_.frm = Pop();
+  Pop();
+  Pop();
+
+  if (retval != 0) {
+    *retval = 1;
+  }
+  return AMX_ERR_NONE;
+}
+
+SyntheticScript *SyntheticScript::FromAmx(AMX *amx) {
+  return static_cast<SyntheticScript*>(amx->userdata[0]);
+}
+
+Address SyntheticScript::GetRegion(int region) const {
+  // Region 0 starts after an empty one so that no function has address 0.
+  return (region + 1) * GetRegionSize(shape_);
+}
+
+Address SyntheticScript::GetCallSite(int region, int site) const {
+  return GetRegion(region) + (2 + 2 * site) * sizeof(cell);
+}
+
+void SyntheticScript::Push(cell value) {
+  amx_.stk -= sizeof(cell);
+  unsigned char *data = amx_.base + reinterpret_cast<AMX_HEADER*>(amx_.base)->dat;
+  *reinterpret_cast<cell*>(data + amx_.stk) = value;
+}
+
+cell SyntheticScript::Pop() {
+  unsigned char *data = amx_.base + reinterpret_cast<AMX_HEADER*>(amx_.base)->dat;
+  cell value = *reinterpret_cast<cell*>(data + amx_.stk);
+  amx_.stk += sizeof(cell);
+  return value;
+}
+
+void SyntheticScript::Break(Address cip) {
+  amx_.cip = cip;
+  if (profiler_ != 0) {
+    profiler_->DebugHook();
+  }
+}
+
+void SyntheticScript::Call(int caller_region, int site, int level, int index,
+                           int recursion) {
+  int region = kNumPublics + level * shape_.fanout + index;
+  Address return_address = GetCallSite(caller_region, site) + 2 * sizeof(cell);
+
+  Push(0);
+  Push(return_address);
+  Push(amx_.frm);
+  amx_.frm = amx_.stk;
+
+  Break(GetRegion(region) + sizeof(cell));
+  RunBody(region, level, index, recursion);
+
+  amx_.stk = amx_.frm;
+  amx_.frm = Pop();
+  Pop();
+  Pop();
+
+  // The next statement of the caller is where the profiler notices that
+  // the function has returned.
+  Break(return_address);
+}
+
+void SyntheticScript::CallNatives(int region) {
+  for (int i = 0; i < shape_.natives; i++) {
+    if (mode_ == FUNCTIONS) {
+      Break(GetRegion(region) + sizeof(cell));
+    }
+    // One argument: a reference to the first global variable.
+    cell params[2] = {sizeof(cell), 0};
+    cell result = 0;
+    if (profiler_ != 0) {
+      profiler_->CallbackHook(i, &result, params);
+    } else {
+      amx_Callback(&amx_, i, &result, params);
+    }
+  }
+}
+
+void SyntheticScript::RunBody(int region, int level, int index,
+                              int recursion) {
+  CallNatives(region);
+  if (mode_ != FUNCTIONS) {
+    return;
+  }
+  if (level + 1 < shape_.depth) {
+    for (int i = 0; i < shape_.fanout; i++) {
+      Call(region, i, level + 1, i, shape_.recursion);
+    }
+  } else if (level >= 0 && recursion > 0) {
+    Call(region, shape_.fanout, level, index, recursion - 1);
+  }
+}
+
+} // namespace bench
+} // namespace amxprof
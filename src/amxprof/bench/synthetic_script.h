@@ -0,0 +1,117 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_BENCH_SYNTHETIC_SCRIPT_H
+#define AMXPROF_BENCH_SYNTHETIC_SCRIPT_H
+
+#include <vector>
+#include <amxprof/amx_types.h>
+#include <amxprof/macros.h>
+
+namespace amxprof {
+
+class Profiler;
+
+namespace bench {
+
+// Describes the call tree executed by each public function of a synthetic
+// script.
+struct ScriptShape {
+  ScriptShape()
+   : depth(3),
+     fanout(4),
+     recursion(2),
+     natives(2)
+  {}
+
+  int depth;      // levels of ordinary functions below the public
+  int fanout;     // functions called by each function of the upper level
+  int recursion;  // how many times the last level recurses into itself
+  int natives;    // native calls made by each function
+};
+
+// An in-memory AMX image that pretends to be executed by the VM. It has
+// no real code, only CALL instructions at call sites and a stack, which
+// is enough for the profiler to walk the frames the same way it does for
+// real scripts. Executing a public function calls the profiler's hooks in
+// the same order as the real VM would.
+class SyntheticScript {
+ public:
+  enum Mode {
+    EXEC_ONLY,   // public functions with an empty body
+    NATIVES,     // publics calling natives (no debug hook)
+    FUNCTIONS    // publics calling the full tree of functions and natives
+  };
+
+  explicit SyntheticScript(const ScriptShape &shape);
+
+  AMX *amx() { return &amx_; }
+  const ScriptShape &shape() const { return shape_; }
+
+  Mode mode() const { return mode_; }
+  void set_mode(Mode mode) { mode_ = mode; }
+
+  // If set, the hooks of the profiler are called instead of the plain
+  // VM functions. Running without a profiler gives the cost of the
+  // simulation itself.
+  void set_profiler(Profiler *profiler) { profiler_ = profiler; }
+
+  // Number of ordinary functions in the image.
+  int num_functions() const { return shape_.depth * shape_.fanout; }
+
+  // Runs the public function; this is what amx_Exec() does for this
+  // image.
+  int Exec(cell *retval, int index);
+
+  // Retrieves the script that owns the AMX instance.
+  static SyntheticScript *FromAmx(AMX *amx);
+
+ private:
+  Address GetRegion(int region) const;
+  Address GetCallSite(int region, int site) const;
+
+  void Push(cell value);
+  cell Pop();
+
+  void Break(Address cip);
+  void Call(int caller_region, int site, int level, int index,
+            int recursion);
+  void CallNatives(int region);
+  void RunBody(int region, int level, int index, int recursion);
+
+ private:
+  ScriptShape shape_;
+  Mode mode_;
+  Profiler *profiler_;
+  std::vector<unsigned char> image_;
+  AMX amx_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(SyntheticScript);
+};
+
+} // namespace bench
+} // namespace amxprof
+
+#endif // !AMXPROF_BENCH_SYNTHETIC_SCRIPT_H
@@ -0,0 +1,185 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "benchmark.h"
+
+namespace amxprof {
+
+namespace {
+
+// Two-sided 95% critical values of Student's t-distribution for 1 to 30
+// degrees of freedom. Beyond that the normal distribution is close enough.
+const double kStudentT95[] = {
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+double StudentT95(std::size_t degrees_of_freedom) {
+  std::size_t table_size = sizeof(kStudentT95) / sizeof(*kStudentT95);
+  if (degrees_of_freedom == 0) {
+    return 0;
+  }
+  if (degrees_of_freedom <= table_size) {
+    return kStudentT95[degrees_of_freedom - 1];
+  }
+  return 1.960;
+}
+
+// Returns the p-th quantile of a sorted sample, interpolating between
+// adjacent values.
+double Quantile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  double position = p * (sorted.size() - 1);
+  std::size_t i = static_cast<std::size_t>(position);
+  if (i + 1 >= sorted.size()) {
+    return sorted.back();
+  }
+  return sorted[i] + (sorted[i + 1] - sorted[i]) * (position - i);
+}
+
+} // anonymous namespace
+
+BenchmarkSummary::BenchmarkSummary()
+ : num_samples_(0),
+   num_outliers_(0)
+{
+}
+
+void BenchmarkSummary::Compute(std::vector<double> samples) {
+  *this = BenchmarkSummary();
+  if (samples.empty()) {
+    return;
+  }
+
+  std::sort(samples.begin(), samples.end());
+
+  double q1 = Quantile(samples, 0.25);
+  double q3 = Quantile(samples, 0.75);
+  double iqr = q3 - q1;
+  std::vector<double>::iterator first =
+    std::lower_bound(samples.begin(), samples.end(), q1 - 1.5 * iqr);
+  std::vector<double>::iterator last =
+    std::upper_bound(first, samples.end(), q3 + 1.5 * iqr);
+
+  std::vector<double> kept(first, last);
+  num_samples_ = static_cast<int>(kept.size());
+  num_outliers_ = static_cast<int>(samples.size() - kept.size());
+
+  double sum = 0;
+  for (std::size_t i = 0; i < kept.size(); i++) {
+    sum += kept[i];
+  }
+  double mean = sum / kept.size();
+
+  double sum_of_squares = 0;
+  for (std::size_t i = 0; i < kept.size(); i++) {
+    sum_of_squares += (kept[i] - mean) * (kept[i] - mean);
+  }
+  double stddev = 0;
+  if (kept.size() > 1) {
+    stddev = std::sqrt(sum_of_squares / (kept.size() - 1));
+  }
+
+  mean_ = mean;
+  median_ = Quantile(kept, 0.5);
+  stddev_ = stddev;
+  min_ = kept.front();
+  max_ = kept.back();
+  ci95_ = StudentT95(kept.size() - 1) * stddev / std::sqrt(
+    static_cast<double>(kept.size()));
+}
+
+Benchmark::Benchmark(const std::string &name,
+                     const std::string &function,
+                     int index)
+ : name_(name),
+   function_(function),
+   index_(index),
+   num_iterations_(0)
+{
+}
+
+int Benchmark::Run(AMX *amx, AMX_EXEC exec, Clock *clock,
+                   int num_samples, int num_iterations, int num_warmup) {
+  int error = Exec(amx, exec, num_warmup);
+  if (error != AMX_ERR_NONE) {
+    return error;
+  }
+
+  num_iterations_ = num_iterations;
+  if (num_iterations_ <= 0) {
+    if ((error = Calibrate(amx, exec, clock)) != AMX_ERR_NONE) {
+      return error;
+    }
+  }
+
+  std::vector<double> samples;
+  samples.reserve(num_samples);
+
+  for (int i = 0; i < num_samples; i++) {
+    TimePoint start = clock->Now();
+    if ((error = Exec(amx, exec, num_iterations_)) != AMX_ERR_NONE) {
+      return error;
+    }
+    Nanoseconds time = clock->Now() - start;
+    samples.push_back(time.count() / num_iterations_);
+  }
+
+  summary_.Compute(samples);
+  return AMX_ERR_NONE;
+}
+
+int Benchmark::Exec(AMX *amx, AMX_EXEC exec, int count) {
+  for (int i = 0; i < count; i++) {
+    cell retval;
+    int error = exec(amx, &retval, index_);
+    if (error != AMX_ERR_NONE) {
+      return error;
+    }
+  }
+  return AMX_ERR_NONE;
+}
+
+int Benchmark::Calibrate(AMX *amx, AMX_EXEC exec, Clock *clock) {
+  Nanoseconds min_time = Milliseconds(kMinSampleTimeMs);
+  for (num_iterations_ = 1; ; num_iterations_ *= 2) {
+    TimePoint start = clock->Now();
+    int error = Exec(amx, exec, num_iterations_);
+    if (error != AMX_ERR_NONE) {
+      return error;
+    }
+    if (!(clock->Now() - start < min_time) || num_iterations_ >= 1 << 24) {
+      break;
+    }
+  }
+  return AMX_ERR_NONE;
+}
+
+} // namespace amxprof
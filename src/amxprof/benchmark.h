@@ -0,0 +1,103 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_BENCHMARK_H
+#define AMXPROF_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include "amx_types.h"
+#include "clock.h"
+#include "duration.h"
+
+namespace amxprof {
+
+// Summary of the per-iteration times measured by a benchmark. Samples
+// outside Tukey's fences (1.5 IQR below the first or above the third
+// quartile) are counted as outliers and left out of everything else.
+class BenchmarkSummary {
+ public:
+  BenchmarkSummary();
+
+  void Compute(std::vector<double> samples);
+
+  int num_samples() const { return num_samples_; }
+  int num_outliers() const { return num_outliers_; }
+
+  Nanoseconds mean() const { return mean_; }
+  Nanoseconds median() const { return median_; }
+  Nanoseconds stddev() const { return stddev_; }
+  Nanoseconds min() const { return min_; }
+  Nanoseconds max() const { return max_; }
+
+  // Half-width of the 95% confidence interval of the mean.
+  Nanoseconds ci95() const { return ci95_; }
+
+ private:
+  int num_samples_;
+  int num_outliers_;
+  Nanoseconds mean_;
+  Nanoseconds median_;
+  Nanoseconds stddev_;
+  Nanoseconds min_;
+  Nanoseconds max_;
+  Nanoseconds ci95_;
+};
+
+// Repeatedly calls a public function and measures how long one call takes.
+class Benchmark {
+ public:
+  // If the number of iterations per sample is not given it's chosen so
+  // that one sample takes at least this long.
+  static const int kMinSampleTimeMs = 1;
+
+  Benchmark(const std::string &name, const std::string &function, int index);
+
+  const std::string &name() const { return name_; }
+  const std::string &function() const { return function_; }
+  int index() const { return index_; }
+
+  int num_iterations() const { return num_iterations_; }
+  const BenchmarkSummary &summary() const { return summary_; }
+
+  // Runs the function num_warmup times, then collects num_samples samples
+  // of num_iterations calls each. Returns the first error reported by exec.
+  int Run(AMX *amx, AMX_EXEC exec, Clock *clock,
+          int num_samples, int num_iterations, int num_warmup);
+
+ private:
+  int Exec(AMX *amx, AMX_EXEC exec, int count);
+  int Calibrate(AMX *amx, AMX_EXEC exec, Clock *clock);
+
+ private:
+  std::string name_;
+  std::string function_;
+  int index_;
+  int num_iterations_;
+  BenchmarkSummary summary_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_BENCHMARK_H
@@ -58,7 +58,7 @@ CallGraph::~CallGraph() {
   Traverse(&deleter);
 }
 
-CallGraphNode *CallGraph::AddCallee(FunctionStatistics *stats) {
+CallGraphEdge *CallGraph::AddCallee(FunctionStatistics *stats) {
   CallGraphNode *node = 0;
   Nodes::iterator iterator = nodes_.find(stats);
   if (iterator == nodes_.end()) {
@@ -67,7 +67,7 @@ CallGraphNode *CallGraph::AddCallee(FunctionStatistics *stats) {
   } else {
     node = iterator->second;
   }
-  return root_ != 0 ? root_->AddCallee(node) : node;
+  return root_->AddCallee(node);
 }
 
 void CallGraph::Traverse(Visitor *visitor) const {
@@ -87,9 +87,28 @@ CallGraphNode::CallGraphNode(CallGraph *graph,
 {
 }
 
-CallGraphNode *CallGraphNode::AddCallee(CallGraphNode *node) {
-  callees_.insert(node);
-  return node;
+CallGraphNode::~CallGraphNode() {
+  for (Callees::const_iterator iterator = callees_.begin();
+       iterator != callees_.end(); ++iterator) {
+    delete iterator->second;
+  }
+}
+
+CallGraphEdge *CallGraphNode::AddCallee(CallGraphNode *node) {
+  Callees::iterator iterator = callees_.find(node);
+  if (iterator != callees_.end()) {
+    return iterator->second;
+  }
+  CallGraphEdge *edge = new CallGraphEdge(this, node);
+  callees_.insert(std::make_pair(node, edge));
+  return edge;
+}
+
+CallGraphEdge::CallGraphEdge(CallGraphNode *caller, CallGraphNode *callee)
+ : caller_(caller),
+   callee_(callee),
+   num_calls_(0)
+{
 }
 
 } // namespace amxprof
@@ -26,11 +26,12 @@
 #define AMXPROF_CALL_GRAPH_H
 
 #include <map>
-#include <set>
+#include "duration.h"
 #include "macros.h"
 
 namespace amxprof {
 
+class CallGraphEdge;
 class CallGraphNode;
 class FunctionStatistics;
 
@@ -59,7 +60,9 @@ class CallGraph {
 
   CallGraphNode *sentinel() const { return sentinel_; }
 
-  CallGraphNode *AddCallee(FunctionStatistics *stats);
+  // Adds a call from the current root to the specified function and
+  // returns the edge connecting them. The root is not changed.
+  CallGraphEdge *AddCallee(FunctionStatistics *stats);
 
   void Traverse(Visitor *visitor) const;
 
@@ -74,8 +77,6 @@ class CallGraph {
 
 class CallGraphNode {
  public:
-  typedef std::set<CallGraphNode*> Callees;
-
   class CompareNodes {
    public:
      bool operator()(const CallGraphNode *lhs,
@@ -84,18 +85,25 @@ class CallGraphNode {
      }
   };
 
+  typedef std::map<CallGraphNode*, CallGraphEdge*, CompareNodes> Callees;
+
   CallGraphNode(CallGraph *graph, FunctionStatistics *stats,
                 CallGraphNode *caller = 0);
+  ~CallGraphNode();
 
   void MakeRoot() { graph_->set_root(this); }
 
   CallGraph *graph() const { return graph_; }
   FunctionStatistics *stats() const { return stats_; }
 
+  // The first function seen calling this one. Other callers can be found
+  // by looking at the edges of all nodes.
   CallGraphNode *caller() const { return caller_; }
+
   const Callees &callees() const { return callees_; }
 
-  CallGraphNode *AddCallee(CallGraphNode *node);
+  // Returns the edge to the specified node, creating it if needed.
+  CallGraphEdge *AddCallee(CallGraphNode *node);
 
  private:
   CallGraph *graph_;
@@ -107,6 +115,34 @@ class CallGraphNode {
   AMXPROF_DISALLOW_COPY_AND_ASSIGN(CallGraphNode);
 };
 
+// Calls made from one function to another.
+class CallGraphEdge {
+ public:
+  CallGraphEdge(CallGraphNode *caller, CallGraphNode *callee);
+
+  CallGraphNode *caller() const { return caller_; }
+  CallGraphNode *callee() const { return callee_; }
+
+  // Number of timed calls.
+  long num_calls() const { return num_calls_; }
+  void AdjustNumCalls(long delta) { num_calls_ += delta; }
+
+  // Total time of the calls, including everything called from them.
+  // Time spent in recursive calls is counted once, as part of the
+  // outermost call.
+  Nanoseconds time() const { return time_; }
+  void AdjustTime(Nanoseconds delta) { time_ += delta; }
+
+ private:
+  CallGraphNode *caller_;
+  CallGraphNode *callee_;
+  long num_calls_;
+  Nanoseconds time_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(CallGraphEdge);
+};
+
 } // namespace amxprof
 
 #endif // !AMXPROF_CALL_GRAPH_H
@@ -22,9 +22,7 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#ifndef AMXPROF_CALL_GRAPH_WRITER_H
-#define AMXPROF_CALL_GRAPH_WRITER_H
-
+#include <iomanip>
 #include <iostream>
 #include <string>
 #include "call_graph.h"
@@ -34,6 +32,11 @@
 
 namespace amxprof {
 
+CallGraphWriterDot::CallGraphWriterDot()
+ : edge_threshold_(0)
+{
+}
+
 void CallGraphWriterDot::Write(const CallGraph *graph) {
   *stream() << 
     "digraph \"Call graph of '" << script_name() << "'\" {\n"
@@ -41,53 +44,66 @@ void CallGraphWriterDot::Write(const CallGraph *graph) {
     "  node [style=filled];\n"
     ;
 
-  WriteNode write_node(this);
-  graph->Traverse(&write_node);
-  
   ComputeMaxTime compute_max_time(this);
   graph->Traverse(&compute_max_time);
 
-  WriteNodeColor write_node_color(this, compute_max_time.max_time());
+  NodeSet written_nodes;
+  WriteNode write_node(this,
+                       compute_max_time.total_time(),
+                       compute_max_time.max_edge_time(),
+                       &written_nodes);
+  graph->Traverse(&write_node);
+
+  WriteNodeColor write_node_color(this,
+                                  compute_max_time.max_time(),
+                                  &written_nodes);
   graph->Traverse(&write_node_color);
 
   *stream() << "}\n";
 }
 
-class WriteNode : public CallGraph::Visitor {
- public:
-  virtual void Visit(const CallGraphNode *node);
-};
-
-class WriteNodeColor : public CallGraph::Visitor {
- public:
-  virtual void Visit(const CallGraphNode *node);
-};
-
-class ComputeMaxTime : public CallGraph::Visitor {
- public:
-  virtual void Visit(const CallGraphNode *node);
- private:
-  Nanoseconds max_time_;
-};
+bool CallGraphWriterDot::ShouldWriteEdge(const CallGraphEdge *edge,
+                                         Nanoseconds total_time) const {
+  if (edge_threshold_ <= 0 || total_time.count() <= 0) {
+    return true;
+  }
+  return edge->time().count() >= total_time.count() * edge_threshold_;
+}
 
 void CallGraphWriterDot::WriteNode::Visit(const CallGraphNode *node) {
   if (node->callees().empty()) {
     return;
   }
 
+  CallGraphWriterDot *writer = static_cast<CallGraphWriterDot*>(writer_);
+
   std::string caller_name;
   if (node->stats()) {
     caller_name = node->stats()->function()->name();
   } else {
-    caller_name = writer_->root_node_name();
+    caller_name = writer->root_node_name();
   }
 
-  std::ostream *stream = writer_->stream();
+  std::ostream *stream = writer->stream();
 
   for (CallGraphNode::Callees::const_iterator iterator = node->callees().begin();
        iterator != node->callees().end(); ++iterator)
   {
-    const CallGraphNode *callee = *iterator;
+    const CallGraphNode *callee = iterator->first;
+    const CallGraphEdge *edge = iterator->second;
+
+    if (!writer->ShouldWriteEdge(edge, total_time_)) {
+      continue;
+    }
+    written_nodes_->insert(node);
+    written_nodes_->insert(callee);
+
+    // Edges are 1 to 5 points wide depending on how much time went
+    // through them.
+    double ratio = 0;
+    if (max_edge_time_.count() > 0) {
+      ratio = edge->time().count() / max_edge_time_.count();
+    }
 
     *stream << "  \"" << caller_name << "\" -> \""
             << callee->stats()->function()->name() << "\" [color=\"";
@@ -103,9 +119,18 @@ void CallGraphWriterDot::WriteNode::Visit(const CallGraphNode *node) {
       case Function::NATIVE:
         *stream << "#7C4B99";
         break;
+      case Function::ZONE:
+        *stream << "#4B9965";
+        break;
     }
 
-    *stream << "\"];\n";
+    std::ostream::fmtflags flags = stream->flags();
+    *stream << "\", label=\"" << edge->num_calls() << " calls\\n"
+            << std::fixed << std::setprecision(3)
+            << Milliseconds(edge->time()).count() << " ms\""
+            << ", penwidth=" << std::setprecision(2) << 1 + ratio * 4
+            << "];\n";
+    stream->flags(flags);
   }
 }
 
@@ -117,6 +142,10 @@ void CallGraphWriterDot::WriteNodeColor::Visit(const CallGraphNode *node) {
     return;
   }
 
+  if (written_nodes_->find(node) == written_nodes_->end()) {
+    return;
+  }
+
   Nanoseconds time = node->stats()->self_time();
   double ratio = static_cast<double>(time.count()) /
                  static_cast<double>(max_time_.count());
@@ -149,12 +178,29 @@ void CallGraphWriterDot::WriteNodeColor::Visit(const CallGraphNode *node) {
     case Function::NORMAL:
       *stream << "oval";
       break;
+    case Function::ZONE:
+      *stream << "hexagon";
+      break;
   }
 
   *stream << "];\n";
 }
 
 void CallGraphWriterDot::ComputeMaxTime::Visit(const CallGraphNode *node) {
+  for (CallGraphNode::Callees::const_iterator iterator = node->callees().begin();
+       iterator != node->callees().end(); ++iterator)
+  {
+    const CallGraphEdge *edge = iterator->second;
+    if (edge->time() > max_edge_time_) {
+      max_edge_time_ = edge->time();
+    }
+    // Everything starts at the root, so the time of its edges adds up
+    // to the total.
+    if (node == node->graph()->sentinel()) {
+      total_time_ += edge->time();
+    }
+  }
+
   if (node == node->graph()->sentinel()) {
     return;
   }
@@ -166,7 +212,3 @@ void CallGraphWriterDot::ComputeMaxTime::Visit(const CallGraphNode *node) {
 }
 
 } // namespace amxprof
-
-#endif // !AMXPROF_CALL_GRAPH_WRITER_H
-
-
@@ -25,35 +25,65 @@
 #ifndef AMXPROF_CALL_GRAPH_WRITER_DOT_H
 #define AMXPROF_CALL_GRAPH_WRITER_DOT_H
 
+#include <set>
 #include "call_graph_writer.h"
 #include "duration.h"
 
 namespace amxprof {
 
+class CallGraphEdge;
 class CallGraphNode;
 
 class CallGraphWriterDot : public CallGraphWriter {
  public:
+  CallGraphWriterDot();
+
   virtual void Write(const CallGraph *graph);
 
+  // Edges that account for less than this fraction of the total run time
+  // are left out, along with the nodes that have no edges left. This keeps
+  // large graphs readable and fast to lay out. 0 (the default) keeps all
+  // edges.
+  double edge_threshold() const { return edge_threshold_; }
+  void set_edge_threshold(double threshold) { edge_threshold_ = threshold; }
+
  private:
+  typedef std::set<const CallGraphNode*> NodeSet;
+
+  bool ShouldWriteEdge(const CallGraphEdge *edge,
+                       Nanoseconds total_time) const;
+
   class WriteNode : public CallGraphWriter::Visitor {
    public:
-    WriteNode(CallGraphWriter *writer)
-     : CallGraphWriter::Visitor(writer)
+    WriteNode(CallGraphWriterDot *writer,
+              Nanoseconds total_time,
+              Nanoseconds max_edge_time,
+              NodeSet *written_nodes)
+     : CallGraphWriter::Visitor(writer),
+       total_time_(total_time),
+       max_edge_time_(max_edge_time),
+       written_nodes_(written_nodes)
     {}
     virtual void Visit(const CallGraphNode *node);
+   private:
+    Nanoseconds total_time_;
+    Nanoseconds max_edge_time_;
+    NodeSet *written_nodes_;
   };
 
   class WriteNodeColor : public CallGraphWriter::Visitor {
    public:
-    WriteNodeColor(CallGraphWriter *writer, Nanoseconds max_time)
+    WriteNodeColor(CallGraphWriter *writer,
+                   Nanoseconds max_time,
+                   const NodeSet *written_nodes)
      : CallGraphWriter::Visitor(writer),
-       max_time_(max_time)
+       max_time_(max_time),
+       written_nodes_(written_nodes)
     {}
     virtual void Visit(const CallGraphNode *node);
    private:
     Nanoseconds max_time_;
+    const NodeSet *written_nodes_;
   };
 
   class ComputeMaxTime : public CallGraphWriter::Visitor {
@@ -63,13 +93,18 @@ class CallGraphWriterDot : public CallGraphWriter {
     {}
     virtual void Visit(const CallGraphNode *node);
     Nanoseconds max_time() const { return max_time_; }
+    Nanoseconds max_edge_time() const { return max_edge_time_; }
+    Nanoseconds total_time() const { return total_time_; }
    private:
     Nanoseconds max_time_;
+    Nanoseconds max_edge_time_;
+    Nanoseconds total_time_;
   };
+
+ private:
+  double edge_threshold_;
 };
 
 } // namespace amxprof
 
 #endif // !AMXPROF_CALL_GRAPH_WRITER_DOT_H
-
-
@@ -0,0 +1,90 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_CALL_SITE_STATISTICS_H
+#define AMXPROF_CALL_SITE_STATISTICS_H
+
+#include <string>
+#include "amx_types.h"
+#include "duration.h"
+
+namespace amxprof {
+
+class Function;
+
+// Runtime information about the calls made to a function from a single
+// place in the code.
+class CallSiteStatistics {
+ public:
+  CallSiteStatistics(Function *function,
+                     Address address,
+                     const std::string &file,
+                     long line);
+
+  // The called function.
+  Function *function() const { return function_; }
+
+  // The return address of the calls, i.e. the address of the instruction
+  // following the CALL or SYSREQ.
+  Address address() const { return address_; }
+
+  // Location of the call, as found in the debug info. The file name is
+  // empty if there was no debug info for this address.
+  const std::string &file() const { return file_; }
+  long line() const { return line_; }
+
+  // Returns "file:line", or the address in hex if the location is unknown.
+  std::string GetLocationString() const;
+
+  long num_calls() const { return num_calls_; }
+  void AdjustNumCalls(long delta) { num_calls_ += delta; }
+
+  // Number of calls that were timed, see FunctionStatistics.
+  long num_timed_calls() const { return num_timed_calls_; }
+  void AdjustNumTimedCalls(long delta) { num_timed_calls_ += delta; }
+
+  // Total time of the calls made from this site. Time spent in recursive
+  // calls is counted once, as part of the outermost call. Extrapolated to
+  // all calls if only some of them were timed.
+  Nanoseconds time() const {
+    if (num_timed_calls_ == 0 || num_timed_calls_ == num_calls_) {
+      return time_;
+    }
+    return time_.count() * num_calls_ / num_timed_calls_;
+  }
+  void AdjustTime(Nanoseconds delta) { time_ += delta; }
+
+ private:
+  Function *function_;
+  Address address_;
+  std::string file_;
+  long line_;
+  long num_calls_;
+  long num_timed_calls_;
+  Nanoseconds time_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_CALL_SITE_STATISTICS_H
@@ -0,0 +1,104 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "call_site_statistics.h"
+#include "call_site_table.h"
+#include "function.h"
+#include "stdint.h"
+
+namespace amxprof {
+
+namespace {
+
+const std::size_t kInitialCapacity = 64;
+
+} // anonymous namespace
+
+CallSiteTable::CallSiteTable()
+ : slots_(kInitialCapacity),
+   size_(0)
+{
+}
+
+CallSiteStatistics *CallSiteTable::Find(Address function,
+                                        Address address) const {
+  std::size_t mask = slots_.size() - 1;
+  for (std::size_t i = Hash(function, address) & mask; ; i = (i + 1) & mask) {
+    CallSiteStatistics *site = slots_[i];
+    if (site == 0) {
+      return 0;
+    }
+    if (site->address() == address
+        && site->function()->address() == function) {
+      return site;
+    }
+  }
+}
+
+void CallSiteTable::Insert(CallSiteStatistics *site) {
+  if ((size_ + 1) * 2 > slots_.size()) {
+    Grow();
+  }
+  std::size_t mask = slots_.size() - 1;
+  std::size_t i = Hash(site->function()->address(), site->address()) & mask;
+  while (slots_[i] != 0) {
+    i = (i + 1) & mask;
+  }
+  slots_[i] = site;
+  size_++;
+}
+
+void CallSiteTable::GetAll(std::vector<CallSiteStatistics*> &sites) const {
+  for (std::size_t i = 0; i < slots_.size(); i++) {
+    if (slots_[i] != 0) {
+      sites.push_back(slots_[i]);
+    }
+  }
+}
+
+std::size_t CallSiteTable::Hash(Address function, Address address) {
+  // Both are code offsets, so the low bits carry little information
+  // until they are mixed (this is MurmurHash3's finalizer).
+  uint32_t h = static_cast<uint32_t>(function) * 0x9e3779b1u
+             ^ static_cast<uint32_t>(address);
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}
+
+void CallSiteTable::Grow() {
+  std::vector<CallSiteStatistics*> old_slots(slots_.size() * 2);
+  old_slots.swap(slots_);
+  size_ = 0;
+  for (std::size_t i = 0; i < old_slots.size(); i++) {
+    if (old_slots[i] != 0) {
+      Insert(old_slots[i]);
+    }
+  }
+}
+
+} // namespace amxprof
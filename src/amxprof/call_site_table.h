@@ -0,0 +1,66 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_CALL_SITE_TABLE_H
+#define AMXPROF_CALL_SITE_TABLE_H
+
+#include <cstddef>
+#include <vector>
+#include "amx_types.h"
+#include "macros.h"
+
+namespace amxprof {
+
+class CallSiteStatistics;
+
+// Maps (function, return address) pairs to call site statistics. This is
+// looked up on every call, so instead of a std::map it uses a flat open
+// addressing table with linear probing that is kept at most half full.
+// The table doesn't own the statistics.
+class CallSiteTable {
+ public:
+  CallSiteTable();
+
+  CallSiteStatistics *Find(Address function, Address address) const;
+  void Insert(CallSiteStatistics *site);
+
+  std::size_t size() const { return size_; }
+
+  void GetAll(std::vector<CallSiteStatistics*> &sites) const;
+
+ private:
+  static std::size_t Hash(Address function, Address address);
+  void Grow();
+
+ private:
+  std::vector<CallSiteStatistics*> slots_;
+  std::size_t size_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(CallSiteTable);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_CALL_SITE_TABLE_H
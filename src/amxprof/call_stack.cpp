@@ -28,13 +28,28 @@
 
 namespace amxprof {
 
-void CallStack::Push(Function *function, Address frame) {
+CallStack::CallStack()
+ : clock_(SystemClock::GetInstance()),
+   cpu_clock_(0),
+   perf_counters_(0)
+{
+}
+
+void CallStack::Push(Function *function, Address frame, bool start_timer) {
   FunctionCall *parent = calls_.empty() ? 0 : &calls_.back();
-  Push(FunctionCall(function, frame, parent));
+  if (start_timer) {
+    Push(FunctionCall(function, frame, parent));
+  } else {
+    calls_.push_back(FunctionCall(function, frame, parent));
+  }
 }
 
 void CallStack::Push(const FunctionCall &call) {
   calls_.push_back(call);
+  calls_.back().timer()->set_clock(clock_);
+  calls_.back().timer()->set_cpu_clock(cpu_clock_);
+  calls_.back().timer()->set_perf_counters(perf_counters_);
+  calls_.back().timer()->set_overhead(inner_overhead_, full_overhead_);
   calls_.back().timer()->Start();
 }
 
@@ -27,19 +27,50 @@
 
 #include <list>
 #include "amx_types.h"
+#include "clock.h"
+#include "duration.h"
 #include "function_call.h"
 
 namespace amxprof {
 
 class Function;
+class PerfCounters;
 
 class CallStack {
  public:
-  void Push(Function *function, Address frame);
+  typedef std::list<FunctionCall>::const_iterator const_iterator;
+
+  CallStack();
+
+  // Pushes a new call onto the stack. If start_timer is false the call's
+  // timer is not started and the call is not timed.
+  void Push(Function *function, Address frame, bool start_timer = true);
   void Push(const FunctionCall &call);
 
   FunctionCall Pop();
 
+  // Profiler overhead to be excluded from the time of each call, see
+  // PerformanceCounter::set_overhead().
+  void set_overhead(Nanoseconds inner, Nanoseconds full) {
+    inner_overhead_ = inner;
+    full_overhead_ = full;
+  }
+
+  // The clock used by the timers of the calls.
+  Clock *clock() const { return clock_; }
+  void set_clock(Clock *clock) { clock_ = clock; }
+
+  // The CPU clock used by the timers of the calls, or null if CPU time
+  // is not measured.
+  Clock *cpu_clock() const { return cpu_clock_; }
+  void set_cpu_clock(Clock *clock) { cpu_clock_ = clock; }
+
+  // Perf counters read by the timers of the calls, or null.
+  PerfCounters *perf_counters() const { return perf_counters_; }
+  void set_perf_counters(PerfCounters *counters) {
+    perf_counters_ = counters;
+  }
+
   bool is_empty() const { return calls_.empty(); }
 
   FunctionCall *top() { return &calls_.back(); }
@@ -47,9 +78,18 @@ class CallStack {
 
   FunctionCall *bottom() { return &calls_.front(); }
   const FunctionCall *bottom() const { return &calls_.front(); }
+
+  // Iterate over the calls from the bottom of the stack to the top.
+  const_iterator begin() const { return calls_.begin(); }
+  const_iterator end() const { return calls_.end(); }
   
  private:
   std::list<FunctionCall> calls_;
+  Clock *clock_;
+  Clock *cpu_clock_;
+  PerfCounters *perf_counters_;
+  Nanoseconds inner_overhead_;
+  Nanoseconds full_overhead_;
 };
 
 } // namespace amxprof
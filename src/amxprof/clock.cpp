@@ -0,0 +1,94 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#if defined _MSC_VER
+  #include <intrin.h>
+#endif
+#include "clock.h"
+#include "stdint.h"
+
+#if (defined _MSC_VER && (defined _M_IX86 || defined _M_X64)) \
+    || (defined __GNUC__ && (defined __i386__ || defined __x86_64__))
+  #define AMXPROF_HAVE_TSC
+#endif
+
+namespace amxprof {
+
+namespace {
+
+#ifdef AMXPROF_HAVE_TSC
+
+uint64_t ReadTsc() {
+  #if defined _MSC_VER
+    return __rdtsc();
+  #else
+    uint32_t low, high;
+    __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+    return (static_cast<uint64_t>(high) << 32) | low;
+  #endif
+}
+
+#endif
+
+} // anonymous namespace
+
+SystemClock *SystemClock::GetInstance() {
+  static SystemClock instance;
+  return &instance;
+}
+
+ThreadCpuClock *ThreadCpuClock::GetInstance() {
+  static ThreadCpuClock instance;
+  return &instance;
+}
+
+TscClock::TscClock()
+ : ns_per_tick_(0)
+{
+  #ifdef AMXPROF_HAVE_TSC
+    // Count ticks over a 10 millisecond interval.
+    SystemClock *system_clock = SystemClock::GetInstance();
+    TimePoint start = system_clock->Now();
+    uint64_t start_ticks = ReadTsc();
+    Nanoseconds elapsed;
+    do {
+      elapsed = system_clock->Now() - start;
+    } while (elapsed < Nanoseconds(10000000.0));
+    uint64_t ticks = ReadTsc() - start_ticks;
+    if (ticks > 0) {
+      ns_per_tick_ = elapsed.count() / static_cast<double>(ticks);
+    }
+  #endif
+}
+
+TimePoint TscClock::Now() {
+  #ifdef AMXPROF_HAVE_TSC
+    if (ns_per_tick_ > 0) {
+      return Nanoseconds(static_cast<double>(ReadTsc()) * ns_per_tick_);
+    }
+  #endif
+  return SystemClock::GetInstance()->Now();
+}
+
+} // namespace amxprof
@@ -47,9 +47,72 @@ class TimePoint {
   Nanoseconds time_;
 };
 
+// Source of time for performance counters. The profiler can be given any
+// clock, e.g. a ManualClock to get exact and reproducible times.
 class Clock {
  public:
-  static TimePoint Now();
+  virtual ~Clock() {}
+  virtual TimePoint Now() = 0;
+};
+
+// The operating system's monotonic clock. This is the default clock.
+class SystemClock : public Clock {
+ public:
+  virtual TimePoint Now();
+
+  // Returns the instance used by default.
+  static SystemClock *GetInstance();
+};
+
+// CPU time consumed by the calling thread. Unlike the other clocks it
+// does not advance while the thread is blocked (sleeping, waiting for
+// I/O, etc), so comparing it to wall time shows where time is spent
+// off the CPU.
+class ThreadCpuClock : public Clock {
+ public:
+  virtual TimePoint Now();
+
+  static ThreadCpuClock *GetInstance();
+};
+
+// Reads the CPU's time stamp counter, which is cheaper than SystemClock
+// but only reliable on CPUs with an invariant TSC. The tick rate is
+// measured against SystemClock at construction. On platforms without a
+// TSC this falls back to SystemClock.
+class TscClock : public Clock {
+ public:
+  TscClock();
+  virtual TimePoint Now();
+
+  double ns_per_tick() const { return ns_per_tick_; }
+
+ private:
+  double ns_per_tick_;
+};
+
+// A clock that only changes when told to. If step is non-zero the clock
+// also advances by step after each call to Now().
+class ManualClock : public Clock {
+ public:
+  ManualClock(Nanoseconds now = 0, Nanoseconds step = 0)
+   : now_(now),
+     step_(step)
+  {}
+
+  virtual TimePoint Now() {
+    TimePoint now = now_;
+    now_ += step_;
+    return now;
+  }
+
+  void set_now(Nanoseconds now) { now_ = now; }
+  void set_step(Nanoseconds step) { step_ = step; }
+
+  void Advance(Nanoseconds delta) { now_ += delta; }
+
+ private:
+  Nanoseconds now_;
+  Nanoseconds step_;
 };
 
 } // namespace amxprof
@@ -29,8 +29,7 @@
 
 namespace amxprof {
 
-// static
-TimePoint Clock::Now() {
+TimePoint SystemClock::Now() {
   struct timespec ts;
 
   if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) {
@@ -41,4 +40,15 @@ TimePoint Clock::Now() {
   return Nanoseconds(ns);
 }
 
+TimePoint ThreadCpuClock::Now() {
+  struct timespec ts;
+
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == -1) {
+    throw SystemError("clock_gettime");
+  }
+
+  int64_t ns = static_cast<int64_t>(ts.tv_sec) * 1000000000L + ts.tv_nsec;
+  return Nanoseconds(ns);
+}
+
 } // namespace amxprof
@@ -29,8 +29,7 @@
 
 namespace amxprof {
 
-// static
-TimePoint Clock::Now() {
+TimePoint SystemClock::Now() {
   LARGE_INTEGER freq;
   if (QueryPerformanceFrequency(&freq) == 0) {
     throw SystemError("QueryPerformanceFrequency");
@@ -46,4 +45,26 @@ TimePoint Clock::Now() {
   return Nanoseconds(ns_per_tick * count.QuadPart);
 }
 
+TimePoint ThreadCpuClock::Now() {
+  FILETIME creation_time;
+  FILETIME exit_time;
+  FILETIME kernel_time;
+  FILETIME user_time;
+
+  if (GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time,
+                     &kernel_time, &user_time) == 0) {
+    throw SystemError("GetThreadTimes");
+  }
+
+  // Both times are in 100-nanosecond units.
+  ULARGE_INTEGER kernel;
+  kernel.LowPart = kernel_time.dwLowDateTime;
+  kernel.HighPart = kernel_time.dwHighDateTime;
+  ULARGE_INTEGER user;
+  user.LowPart = user_time.dwLowDateTime;
+  user.HighPart = user_time.dwHighDateTime;
+
+  return Nanoseconds((kernel.QuadPart + user.QuadPart) * 100);
+}
+
 } // namespace amxprof
@@ -0,0 +1,65 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_COUNTER_STATISTICS_H
+#define AMXPROF_COUNTER_STATISTICS_H
+
+#include <string>
+#include "amx_types.h"
+
+namespace amxprof {
+
+// A named value that the script sets from time to time, such as the
+// number of vehicles or the size of a queue, see Profiler::SetCounter().
+class CounterStatistics {
+ public:
+  CounterStatistics(int id, const std::string &name);
+
+  int id() const { return id_; }
+  const std::string &name() const { return name_; }
+
+  // Number of times the counter was set and the values it was set to.
+  long num_samples() const { return num_samples_; }
+  cell last_value() const { return last_value_; }
+  cell min_value() const { return min_value_; }
+  cell max_value() const { return max_value_; }
+  double average_value() const {
+    return num_samples_ > 0 ? total_value_ / num_samples_ : 0;
+  }
+
+  void AddSample(cell value);
+
+ private:
+  int id_;
+  std::string name_;
+  long num_samples_;
+  cell last_value_;
+  cell min_value_;
+  cell max_value_;
+  double total_value_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_COUNTER_STATISTICS_H
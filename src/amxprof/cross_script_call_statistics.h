@@ -0,0 +1,70 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_CROSS_SCRIPT_CALL_STATISTICS_H
+#define AMXPROF_CROSS_SCRIPT_CALL_STATISTICS_H
+
+#include <string>
+#include "duration.h"
+
+namespace amxprof {
+
+// Calls from one script to a public function of another script, e.g.
+// through CallRemoteFunction. Both the calling and the called script
+// keep a copy, so each report shows the calls in both directions.
+class CrossScriptCallStatistics {
+ public:
+  CrossScriptCallStatistics(const std::string &caller_script,
+                            const std::string &caller,
+                            const std::string &callee_script,
+                            const std::string &callee);
+
+  // Name of the calling script and its call stack at the time of the
+  // call, as in "OnPlayerConnect > CallRemoteFunction".
+  const std::string &caller_script() const { return caller_script_; }
+  const std::string &caller() const { return caller_; }
+
+  // Name of the called script and public function.
+  const std::string &callee_script() const { return callee_script_; }
+  const std::string &callee() const { return callee_; }
+
+  long num_calls() const { return num_calls_; }
+  void AdjustNumCalls(long delta) { num_calls_ += delta; }
+
+  // Wall time spent in the called public, measured by the callee.
+  Nanoseconds time() const { return time_; }
+  void AdjustTime(Nanoseconds delta) { time_ += delta; }
+
+ private:
+  std::string caller_script_;
+  std::string caller_;
+  std::string callee_script_;
+  std::string callee_;
+  long num_calls_;
+  Nanoseconds time_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_CROSS_SCRIPT_CALL_STATISTICS_H
@@ -0,0 +1,66 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_EXECUTION_CONTEXT_H
+#define AMXPROF_EXECUTION_CONTEXT_H
+
+#include <vector>
+#include "macros.h"
+
+namespace amxprof {
+
+class Profiler;
+
+// Process-wide list of the profilers whose scripts are currently being
+// executed, innermost last. When a script calls a public function of
+// another script (e.g. via CallRemoteFunction), this is how the callee's
+// profiler finds out which script and function the call came from.
+//
+// Like the AMX itself this is not thread-safe.
+class ExecutionContext {
+ public:
+  static ExecutionContext *GetInstance();
+
+  void Enter(Profiler *profiler) { profilers_.push_back(profiler); }
+  void Leave() { profilers_.pop_back(); }
+
+  // Returns the profiler of the innermost executing script, or null if
+  // no profiled script is running.
+  Profiler *current() const {
+    return profilers_.empty() ? 0 : profilers_.back();
+  }
+
+ private:
+  ExecutionContext() {}
+
+ private:
+  std::vector<Profiler*> profilers_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(ExecutionContext);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_EXECUTION_CONTEXT_H
@@ -0,0 +1,88 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_FILE_STATISTICS_H
+#define AMXPROF_FILE_STATISTICS_H
+
+#include <string>
+#include "duration.h"
+
+namespace amxprof {
+
+// Statistics rolled up over all functions defined in a source file, or in
+// all files of a directory, or over all natives implemented by a module.
+class FileStatistics {
+ public:
+  explicit FileStatistics(const std::string &name);
+
+  // Path of the file or directory, as found in the debug info, or the
+  // name of the module.
+  const std::string &name() const { return name_; }
+
+  long num_functions() const { return num_functions_; }
+  void AdjustNumFunctions(long delta) { num_functions_ += delta; }
+
+  long num_calls() const { return num_calls_; }
+  void AdjustNumCalls(long delta) { num_calls_ += delta; }
+
+  // Number of calls that were timed, see FunctionStatistics.
+  long num_timed_calls() const { return num_timed_calls_; }
+  void AdjustNumTimedCalls(long delta) { num_timed_calls_ += delta; }
+
+  // Sum of the self times of the functions.
+  Nanoseconds self_time() const { return Extrapolate(self_time_); }
+  void AdjustSelfTime(Nanoseconds delta) { self_time_ += delta; }
+
+  // Time between entering the file (or directory) and leaving it, i.e.
+  // the total time of calls made from other files. Calls from the file
+  // to itself are not counted twice.
+  Nanoseconds total_time() const { return Extrapolate(total_time_); }
+  void AdjustTotalTime(Nanoseconds delta) { total_time_ += delta; }
+
+  // Called on entering and leaving one of the functions. LeaveCall()
+  // returns true if the call was the outermost call into the file.
+  void EnterCall() { num_active_calls_++; }
+  bool LeaveCall() { return --num_active_calls_ == 0; }
+
+ private:
+  Nanoseconds Extrapolate(Nanoseconds time) const {
+    if (num_timed_calls_ == 0 || num_timed_calls_ == num_calls_) {
+      return time;
+    }
+    return time.count() * num_calls_ / num_timed_calls_;
+  }
+
+ private:
+  std::string name_;
+  long num_functions_;
+  long num_calls_;
+  long num_timed_calls_;
+  long num_active_calls_;
+  Nanoseconds self_time_;
+  Nanoseconds total_time_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_FILE_STATISTICS_H
@@ -0,0 +1,188 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include "flight_recorder.h"
+#include "function.h"
+
+namespace amxprof {
+
+namespace {
+
+const char kMagic[8] = {'A', 'M', 'X', 'P', 'F', 'R', '0', '1'};
+
+// Enough for several thousand function names.
+const uint32_t kNamesSize = 256 * 1024;
+
+std::string FormatAddress(uint32_t address) {
+  std::stringstream ss;
+  ss << std::setw(8) << std::setfill('0') << std::hex << address;
+  return ss.str();
+}
+
+} // anonymous namespace
+
+FlightRecorder::FlightRecorder() {
+}
+
+bool FlightRecorder::Open(const std::string &path, uint32_t num_events) {
+  std::size_t size = sizeof(Header)
+                   + sizeof(Event) * static_cast<std::size_t>(num_events)
+                   + kNamesSize;
+  if (num_events == 0 || !file_.Open(path, size)) {
+    return false;
+  }
+  if (!file_.is_reused() || !IsValid(num_events)) {
+    std::memcpy(header()->magic, kMagic, sizeof(kMagic));
+    header()->max_events = num_events;
+    header()->names_size = kNamesSize;
+    Reset();
+  }
+  return true;
+}
+
+void FlightRecorder::Close() {
+  file_.Close();
+}
+
+bool FlightRecorder::IsValid(uint32_t max_events) const {
+  const Header *header = this->header();
+  return std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0
+      && header->max_events == max_events
+      && header->names_size == kNamesSize
+      && header->names_length <= kNamesSize;
+}
+
+void FlightRecorder::Reset() {
+  header()->next_event = 0;
+  header()->names_length = 0;
+}
+
+uint32_t FlightRecorder::num_events() const {
+  const Header *header = this->header();
+  if (header->next_event < header->max_events) {
+    return static_cast<uint32_t>(header->next_event);
+  }
+  return header->max_events;
+}
+
+void FlightRecorder::AddFunction(const Function *fn) {
+  std::string line = FormatAddress(static_cast<uint32_t>(fn->address()));
+  line.append(" ").append(fn->name()).append("\n");
+
+  Header *header = this->header();
+  if (header->names_length + line.length() > header->names_size) {
+    return;
+  }
+  std::memcpy(names() + header->names_length, line.data(), line.length());
+  header->names_length += static_cast<uint32_t>(line.length());
+}
+
+void FlightRecorder::Dump(std::ostream &stream, Nanoseconds max_age) const {
+  const Header *header = this->header();
+
+  std::map<uint32_t, std::string> names;
+  std::istringstream names_stream(
+    std::string(this->names(), header->names_length));
+  std::string line;
+  while (std::getline(names_stream, line)) {
+    std::string::size_type space = line.find(' ');
+    if (space != std::string::npos) {
+      uint32_t address = 0;
+      std::istringstream(line.substr(0, space)) >> std::hex >> address;
+      names[address] = line.substr(space + 1);
+    }
+  }
+
+  uint64_t end = header->next_event;
+  uint64_t begin = end - num_events();
+  const Event *events = this->events();
+
+  if (begin != end && max_age.count() > 0) {
+    int64_t last_time = events[(end - 1) % header->max_events].time;
+    int64_t min_time = last_time - static_cast<int64_t>(max_age.count());
+    while (events[begin % header->max_events].time < min_time) {
+      begin++;
+    }
+  }
+
+  stream << "Flight recorder: " << end - begin << " events";
+  if (begin == end) {
+    stream << std::endl;
+    return;
+  }
+  int64_t start_time = events[begin % header->max_events].time;
+  int64_t end_time = events[(end - 1) % header->max_events].time;
+  stream << " over "
+         << std::fixed << std::setprecision(3)
+         << Milliseconds(Nanoseconds(
+              static_cast<double>(end_time - start_time))).count()
+         << " ms" << std::endl
+         << std::endl;
+
+  // The first events may belong to calls that started before them, these
+  // are shown without their times.
+  std::vector<std::pair<uint32_t, int64_t> > stack;
+
+  for (uint64_t i = begin; i != end; i++) {
+    const Event &event = events[i % header->max_events];
+
+    std::string name;
+    std::map<uint32_t, std::string>::const_iterator it =
+      names.find(event.address);
+    if (it != names.end()) {
+      name = it->second;
+    } else {
+      name = "unknown@" + FormatAddress(event.address);
+    }
+
+    double time = Milliseconds(Nanoseconds(
+      static_cast<double>(event.time - start_time))).count();
+    stream << std::setw(12) << time << " ms  ";
+
+    if (event.type == ENTER) {
+      stream << std::string(stack.size() * 2, ' ') << "> " << name;
+      stack.push_back(std::make_pair(event.address, event.time));
+    } else {
+      if (!stack.empty() && stack.back().first == event.address) {
+        int64_t call_time = event.time - stack.back().second;
+        stack.pop_back();
+        stream << std::string(stack.size() * 2, ' ') << "< " << name
+               << " (" << Milliseconds(Nanoseconds(
+                            static_cast<double>(call_time))).count()
+               << " ms)";
+      } else {
+        stream << std::string(stack.size() * 2, ' ') << "< " << name;
+      }
+    }
+    stream << std::endl;
+  }
+}
+
+} // namespace amxprof
@@ -0,0 +1,126 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_FLIGHT_RECORDER_H
+#define AMXPROF_FLIGHT_RECORDER_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include "amx_types.h"
+#include "clock.h"
+#include "macros.h"
+#include "mapped_file.h"
+#include "stdint.h"
+
+namespace amxprof {
+
+class Function;
+
+// Keeps the most recent function enter and leave events in a ring buffer
+// that lives in a memory-mapped file. Recording an event is just a store
+// to memory, so the recorder can stay on all the time, and the events
+// survive a crash of the process: they can be dumped the next time the
+// same file is opened.
+//
+// Function names are stored in the file as well, so that a dump doesn't
+// depend on the profiler that recorded the events.
+class FlightRecorder {
+ public:
+  enum EventType {
+    ENTER,
+    LEAVE
+  };
+
+  FlightRecorder();
+
+  // Maps the file, creating it if needed, with room for num_events
+  // events. If the file holds events from a previous run they are kept
+  // until Reset() is called.
+  bool Open(const std::string &path, uint32_t num_events);
+  void Close();
+
+  bool is_open() const { return file_.is_open(); }
+
+  // Forgets all events and function names.
+  void Reset();
+
+  // Number of events in the buffer.
+  uint32_t num_events() const;
+
+  // Remembers the function's name for dumps. Names that don't fit in the
+  // file are shown as addresses.
+  void AddFunction(const Function *fn);
+
+  void RecordEvent(EventType type, Address address, TimePoint time) {
+    Header *header = this->header();
+    Event *event = &events()[header->next_event % header->max_events];
+    event->time = static_cast<int64_t>((time - TimePoint()).count());
+    event->address = static_cast<uint32_t>(address);
+    event->type = static_cast<uint32_t>(type);
+    header->next_event++;
+  }
+
+  // Writes the events of the last max_age nanoseconds (or all of them if
+  // max_age is zero) as an indented call trace.
+  void Dump(std::ostream &stream, Nanoseconds max_age = Nanoseconds(0)) const;
+
+ private:
+  struct Header {
+    char magic[8];
+    uint32_t max_events;
+    uint32_t names_size;
+    uint64_t next_event;
+    uint32_t names_length;
+    uint32_t reserved;
+  };
+
+  struct Event {
+    int64_t time;
+    uint32_t address;
+    uint32_t type;
+  };
+
+  Header *header() const {
+    return static_cast<Header*>(file_.data());
+  }
+  Event *events() const {
+    return reinterpret_cast<Event*>(header() + 1);
+  }
+  char *names() const {
+    return reinterpret_cast<char*>(events() + header()->max_events);
+  }
+
+  bool IsValid(uint32_t max_events) const;
+
+ private:
+  MappedFile file_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(FlightRecorder);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_FLIGHT_RECORDER_H
@@ -23,19 +23,36 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include <cassert>
+#include <cstddef>
 #include <iomanip>
 #include <sstream>
 #include <string>
 #include "amx_utils.h"
 #include "debug_info.h"
 #include "function.h"
+#include "module_utils.h"
 
 namespace amxprof {
 
-Function::Function(Type type, Address address, std::string name)
+namespace {
+
+std::string LookupFile(Address address, DebugInfo *debug_info) {
+  if (address != 0 && debug_info != 0 && debug_info->is_loaded()) {
+    return debug_info->LookupFile(address);
+  }
+  return std::string();
+}
+
+} // anonymous namespace
+
+Function::Function(Type type,
+                   Address address,
+                   std::string name,
+                   std::string file)
  : type_(type),
    address_(address),
-   name_(name)
+   name_(name),
+   file_(file)
 {
 }
 
@@ -53,17 +70,41 @@ Function *Function::Normal(Address address, DebugInfo *debug_info) {
     name.append("unknown@").append(ss.str());
   }
 
-  return new Function(NORMAL, address, name);
+  return new Function(NORMAL, address, name, LookupFile(address, debug_info));
 }
 
 // static
-Function *Function::Public(AMX *amx, PublicTableIndex index) {
-  return new Function(PUBLIC, GetPublicAddress(amx, index), GetPublicName(amx, index));
+Function *Function::Public(AMX *amx,
+                           PublicTableIndex index,
+                           DebugInfo *debug_info) {
+  Address address = GetPublicAddress(amx, index);
+  return new Function(PUBLIC, address, GetPublicName(amx, index),
+                      LookupFile(address, debug_info));
 }
 
 // static
 Function *Function::Native(AMX *amx, NativeTableIndex index) {
-  return new Function(NATIVE, GetNativeAddress(amx, index), GetNativeName(amx, index));
+  Address address = GetNativeAddress(amx, index);
+  Function *fn = new Function(NATIVE, address, GetNativeName(amx, index));
+
+  // Once registered, the address of a native is a pointer to the C
+  // function implementing it.
+  fn->module_ = GetModuleName(reinterpret_cast<void*>(
+    static_cast<std::size_t>(static_cast<ucell>(address))));
+
+  return fn;
+}
+
+// static
+Function *Function::Zone(const std::string &name) {
+  Function *fn = new Function(ZONE, 0, name);
+
+  // Zones aren't part of the script's code, so they are identified by
+  // the address of their Function object instead. That can't be taken
+  // by a native's C function either.
+  fn->address_ = static_cast<Address>(reinterpret_cast<std::size_t>(fn));
+
+  return fn;
 }
 
 const char *Function::GetTypeString() const {
@@ -74,6 +115,8 @@ const char *Function::GetTypeString() const {
       return "public";
     case NATIVE:
       return "native";
+    case ZONE:
+      return "zone";
     default:
       return "unknown";
   }
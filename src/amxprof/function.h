@@ -37,13 +37,16 @@ class Function {
   enum Type {
     NORMAL, // non-public functions
     PUBLIC, // public functions
-    NATIVE  // native functions
+    NATIVE, // native functions
+    ZONE    // zones marked by the script, see Profiler::BeginZone()
   };
 
   // Caller is reponsible for deleting returned Function objects.
   static Function *Normal(Address address, DebugInfo *debug_info = 0);
-  static Function *Public(AMX *amx, PublicTableIndex index);
+  static Function *Public(AMX *amx, PublicTableIndex index,
+                          DebugInfo *debug_info = 0);
   static Function *Native(AMX *amx, NativeTableIndex index);
+  static Function *Zone(const std::string &name);
 
   // Returns the type of the function.
   Type type() const {
@@ -70,6 +73,20 @@ class Function {
     return name_;
   }
 
+  // Returns the source file the function is defined in, as found in the
+  // debug info. This is looked up once when the function is created and
+  // is empty for natives or if there was no debug info.
+  std::string file() const {
+    return file_;
+  }
+
+  // Returns the file name of the plugin (or the server executable) that
+  // implements a native function, as in "streamer.so". This is empty for
+  // other functions or if the module could not be determined.
+  std::string module() const {
+    return module_;
+  }
+
   // Comparison operators.
   bool operator==(const Function &other) const {
     return address_ == other.address_;
@@ -82,12 +99,15 @@ class Function {
   }
 
  private:
-  Function(Type type, Address address, std::string name);
+  Function(Type type, Address address, std::string name,
+           std::string file = std::string());
 
  private:
   Type type_;
   Address address_;
   std::string name_;
+  std::string file_;
+  std::string module_;
 };
 
 } // namespace amxprof
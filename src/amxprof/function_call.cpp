@@ -29,13 +29,22 @@ namespace amxprof {
 FunctionCall::FunctionCall(Function *function, Address frame, FunctionCall *parent)
  : fn_(function),
    parent_(parent),
-   frame_(frame)
+   frame_(frame),
+   recursion_depth_(0),
+   stack_base_(0),
+   stack_low_(0),
+   heap_base_(0),
+   heap_high_(0),
+   call_site_(0),
+   call_graph_edge_(0),
+   player_stats_(0)
 {
   FunctionCall *current = parent;
 
   while (current != 0) {
     if (current->fn_ == this->fn_) {
       timer_.set_shadow(current->timer());
+      recursion_depth_ = current->recursion_depth_ + 1;
       break;
     }
     current = current->parent_;
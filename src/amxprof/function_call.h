@@ -30,7 +30,10 @@
 
 namespace amxprof {
 
+class CallGraphEdge;
+class CallSiteStatistics;
 class Function;
+class PlayerStatistics;
 
 class FunctionCall {
  public:
@@ -44,6 +47,42 @@ class FunctionCall {
 
   Address frame() const { return frame_; }
 
+  // Number of calls to the same function further down the stack.
+  int recursion_depth() const { return recursion_depth_; }
+
+  // Where the function was called from, if known.
+  CallSiteStatistics *call_site() const { return call_site_; }
+  void set_call_site(CallSiteStatistics *call_site) { call_site_ = call_site; }
+
+  // The call graph edge this call is counted in, if any.
+  CallGraphEdge *call_graph_edge() const { return call_graph_edge_; }
+  void set_call_graph_edge(CallGraphEdge *edge) { call_graph_edge_ = edge; }
+
+  // The player the call is made for, if it's a player callback.
+  PlayerStatistics *player_stats() const { return player_stats_; }
+  void set_player_stats(PlayerStatistics *stats) { player_stats_ = stats; }
+
+  // Stack pointer and heap top when the call was entered and the lowest
+  // stack pointer and highest heap top seen since, including in callees.
+  // Only tracked if Profiler::memory_stats_enabled() is set.
+  cell stack_base() const { return stack_base_; }
+  cell stack_low() const { return stack_low_; }
+  cell heap_base() const { return heap_base_; }
+  cell heap_high() const { return heap_high_; }
+
+  void InitMemory(cell stk, cell hea) {
+    stack_base_ = stack_low_ = stk;
+    heap_base_ = heap_high_ = hea;
+  }
+  void UpdateMemory(cell stk, cell hea) {
+    if (stk < stack_low_) {
+      stack_low_ = stk;
+    }
+    if (hea > heap_high_) {
+      heap_high_ = hea;
+    }
+  }
+
   PerformanceCounter *timer() { return &timer_; }
   const PerformanceCounter *timer() const { return &timer_; }
 
@@ -51,6 +90,14 @@ class FunctionCall {
   Function *fn_;
   FunctionCall *parent_;
   Address frame_;
+  int recursion_depth_;
+  cell stack_base_;
+  cell stack_low_;
+  cell heap_base_;
+  cell heap_high_;
+  CallSiteStatistics *call_site_;
+  CallGraphEdge *call_graph_edge_;
+  PlayerStatistics *player_stats_;
   PerformanceCounter timer_;
 };
 
@@ -28,10 +28,29 @@ namespace amxprof {
 
 FunctionStatistics::FunctionStatistics(Function *fn)
  : fn_(fn),
-   num_calls_(0)
+   num_calls_(0),
+   num_timed_calls_(0),
+   file_stats_(0),
+   directory_stats_(0),
+   module_stats_(0),
+   max_stack_usage_(0),
+   max_heap_usage_(0),
+   heap_growth_(0),
+   max_recursion_depth_(0)
 {
 }
 
+EventCounts FunctionStatistics::self_counts() const {
+  if (num_timed_calls_ == 0 || num_timed_calls_ == num_calls_) {
+    return self_counts_;
+  }
+  EventCounts counts;
+  for (int i = 0; i < EventCounts::kMaxEvents; i++) {
+    counts[i] = self_counts_[i] * num_calls_ / num_timed_calls_;
+  }
+  return counts;
+}
+
 void FunctionStatistics::AdjustSelfTime(Nanoseconds delta) {
   self_time_ += delta;
 }
@@ -40,4 +59,8 @@ void FunctionStatistics::AdjustTotalTime(Nanoseconds delta) {
   total_time_ += delta;
 }
 
+void FunctionStatistics::AdjustCpuTime(Nanoseconds delta) {
+  cpu_time_ += delta;
+}
+
 } // namespace amxprof
@@ -25,10 +25,13 @@
 #ifndef AMXPROF_FUNCTION_INFO_H
 #define AMXPROF_FUNCTION_INFO_H
 
+#include "amx_types.h"
 #include "duration.h"
+#include "perf_counters.h"
 
 namespace amxprof {
 
+class FileStatistics;
 class Function;
 
 // Various runtime information about a function.
@@ -42,8 +45,31 @@ class FunctionStatistics {
   long num_calls() const { return num_calls_; }
   void AdjustNumCalls(long delta) { num_calls_ += delta; }
 
-  Nanoseconds self_time() const { return self_time_; }
-  Nanoseconds total_time() const { return total_time_; }
+  // Number of calls that were actually timed. This can be less than
+  // num_calls() when call sampling is enabled.
+  long num_timed_calls() const { return num_timed_calls_; }
+  void AdjustNumTimedCalls(long delta) { num_timed_calls_ += delta; }
+
+  // Self and total time of all calls. If only some of the calls were
+  // timed the result is extrapolated from those calls.
+  Nanoseconds self_time() const { return Extrapolate(self_time_); }
+  Nanoseconds total_time() const { return Extrapolate(total_time_); }
+
+  // CPU time of all calls including child calls, extrapolated like the
+  // other times. Only measured if the profiler has a CPU clock.
+  Nanoseconds cpu_time() const { return Extrapolate(cpu_time_); }
+
+  // The part of total_time() the thread spent off the CPU, e.g. waiting
+  // for a blocking native to return.
+  Nanoseconds off_cpu_time() const {
+    Nanoseconds off_cpu_time = total_time() - cpu_time();
+    return off_cpu_time > Nanoseconds(0) ? off_cpu_time : Nanoseconds(0);
+  }
+
+  // Events counted in the function itself, see PerfCounters. These are
+  // extrapolated too.
+  EventCounts self_counts() const;
+  void AdjustSelfCounts(const EventCounts &delta) { self_counts_ += delta; }
 
   Nanoseconds worst_self_time() const { return worst_self_time_; }
   Nanoseconds worst_total_time() const { return worst_total_time_; }
@@ -56,16 +82,80 @@ class FunctionStatistics {
     worst_total_time_ = worst_total_time;
   }
 
+  // Most stack and heap space used by a single call including its
+  // callees, in bytes. The stack usage doesn't include the call's own
+  // arguments.
+  cell max_stack_usage() const { return max_stack_usage_; }
+  void UpdateMaxStackUsage(cell usage) {
+    if (usage > max_stack_usage_) {
+      max_stack_usage_ = usage;
+    }
+  }
+
+  cell max_heap_usage() const { return max_heap_usage_; }
+  void UpdateMaxHeapUsage(cell usage) {
+    if (usage > max_heap_usage_) {
+      max_heap_usage_ = usage;
+    }
+  }
+
+  // Heap space still allocated when calls returned, summed over all
+  // calls. Anything but zero means the function leaks heap memory or
+  // returns some to its caller.
+  cell heap_growth() const { return heap_growth_; }
+  void AdjustHeapGrowth(cell delta) { heap_growth_ += delta; }
+
+  // Deepest recursion seen, i.e. the most calls to the function that
+  // were on the stack at once minus one.
+  int max_recursion_depth() const { return max_recursion_depth_; }
+  void UpdateMaxRecursionDepth(int depth) {
+    if (depth > max_recursion_depth_) {
+      max_recursion_depth_ = depth;
+    }
+  }
+
   void AdjustSelfTime(Nanoseconds delta);
   void AdjustTotalTime(Nanoseconds delta);
+  void AdjustCpuTime(Nanoseconds delta);
+
+  // Statistics of the file and directory the function is defined in,
+  // or null if unknown.
+  FileStatistics *file_stats() const { return file_stats_; }
+  FileStatistics *directory_stats() const { return directory_stats_; }
+
+  void set_file_stats(FileStatistics *stats) { file_stats_ = stats; }
+  void set_directory_stats(FileStatistics *stats) { directory_stats_ = stats; }
+
+  // Statistics of the module (plugin) implementing a native function,
+  // or null if it's not a native or the module is unknown.
+  FileStatistics *module_stats() const { return module_stats_; }
+  void set_module_stats(FileStatistics *stats) { module_stats_ = stats; }
+
+ private:
+  Nanoseconds Extrapolate(Nanoseconds time) const {
+    if (num_timed_calls_ == 0 || num_timed_calls_ == num_calls_) {
+      return time;
+    }
+    return time.count() * num_calls_ / num_timed_calls_;
+  }
 
  private:
   Function *fn_;
   long num_calls_;
+  long num_timed_calls_;
+  FileStatistics *file_stats_;
+  FileStatistics *directory_stats_;
+  FileStatistics *module_stats_;
   Nanoseconds self_time_;
   Nanoseconds total_time_;
+  Nanoseconds cpu_time_;
+  EventCounts self_counts_;
   Nanoseconds worst_self_time_;
   Nanoseconds worst_total_time_;
+  cell max_stack_usage_;
+  cell max_heap_usage_;
+  cell heap_growth_;
+  int max_recursion_depth_;
 };
 
 } // namespace amxprof
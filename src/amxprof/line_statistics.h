@@ -0,0 +1,76 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_LINE_STATISTICS_H
+#define AMXPROF_LINE_STATISTICS_H
+
+#include <string>
+#include "amx_types.h"
+#include "duration.h"
+
+namespace amxprof {
+
+// Runtime information about a single line of code (i.e. a statement
+// marked with a BREAK instruction).
+class LineStatistics {
+ public:
+  LineStatistics(Address address, const std::string &file, long line);
+
+  Address address() const { return address_; }
+
+  // File name and line number, as found in the debug info. The file name
+  // is empty if there was no debug info for this address.
+  const std::string &file() const { return file_; }
+  long line() const { return line_; }
+
+  long num_hits() const { return num_hits_; }
+  void AdjustNumHits(long delta) { num_hits_ += delta; }
+
+  // Number of hits that were timed, see FunctionStatistics.
+  long num_timed_hits() const { return num_timed_hits_; }
+  void AdjustNumTimedHits(long delta) { num_timed_hits_ += delta; }
+
+  // Time elapsed between hitting this line and hitting the next one,
+  // including time spent in native functions called from this line.
+  // Extrapolated to all hits if only some of them were timed.
+  Nanoseconds time() const {
+    if (num_timed_hits_ == 0 || num_timed_hits_ == num_hits_) {
+      return time_;
+    }
+    return time_.count() * num_hits_ / num_timed_hits_;
+  }
+  void AdjustTime(Nanoseconds delta) { time_ += delta; }
+
+ private:
+  Address address_;
+  std::string file_;
+  long line_;
+  long num_hits_;
+  long num_timed_hits_;
+  Nanoseconds time_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_LINE_STATISTICS_H
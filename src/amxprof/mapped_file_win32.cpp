@@ -0,0 +1,92 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <windows.h>
+#include "mapped_file.h"
+
+namespace amxprof {
+
+MappedFile::MappedFile()
+ : data_(0),
+   size_(0),
+   reused_(false)
+{
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+bool MappedFile::Open(const std::string &path, std::size_t size) {
+  Close();
+
+  HANDLE file = CreateFileA(path.c_str(),
+                            GENERIC_READ | GENERIC_WRITE,
+                            FILE_SHARE_READ,
+                            NULL,
+                            OPEN_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL,
+                            NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  reused_ = GetFileSizeEx(file, &file_size)
+            && file_size.QuadPart == static_cast<LONGLONG>(size);
+
+  // The mapping grows the file to its size if it's smaller. A larger
+  // file is never shrunk but only its first size bytes are used.
+  HANDLE mapping = CreateFileMappingA(file,
+                                      NULL,
+                                      PAGE_READWRITE,
+                                      0,
+                                      static_cast<DWORD>(size),
+                                      NULL);
+  CloseHandle(file);
+  if (mapping == NULL) {
+    return false;
+  }
+
+  // The view keeps both the mapping and the file open.
+  void *data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+  CloseHandle(mapping);
+  if (data == NULL) {
+    return false;
+  }
+
+  data_ = data;
+  size_ = size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_ != 0) {
+    UnmapViewOfFile(data_);
+    data_ = 0;
+    size_ = 0;
+  }
+}
+
+} // namespace amxprof
@@ -0,0 +1,89 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <istream>
+#include <ostream>
+#include "native_log.h"
+
+namespace amxprof {
+namespace native_log {
+
+const char kMagic[8] = "AMXNLOG";
+
+void WriteUnsigned(std::ostream &stream, uint32_t value) {
+  while (value >= 0x80) {
+    stream.put(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  stream.put(static_cast<char>(value));
+}
+
+void WriteSigned(std::ostream &stream, int32_t value) {
+  WriteUnsigned(stream, (static_cast<uint32_t>(value) << 1)
+                        ^ static_cast<uint32_t>(value >> 31));
+}
+
+void WriteString(std::ostream &stream, const std::string &value) {
+  WriteUnsigned(stream, static_cast<uint32_t>(value.length()));
+  stream.write(value.data(), value.length());
+}
+
+bool ReadUnsigned(std::istream &stream, uint32_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    int byte = stream.get();
+    if (byte == std::istream::traits_type::eof()) {
+      return false;
+    }
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReadSigned(std::istream &stream, int32_t &value) {
+  uint32_t encoded;
+  if (!ReadUnsigned(stream, encoded)) {
+    return false;
+  }
+  value = static_cast<int32_t>((encoded >> 1) ^ (~(encoded & 1) + 1));
+  return true;
+}
+
+bool ReadString(std::istream &stream, std::string &value) {
+  uint32_t length;
+  if (!ReadUnsigned(stream, length)) {
+    return false;
+  }
+  value.resize(length);
+  if (length > 0) {
+    stream.read(&value[0], length);
+  }
+  return stream.good();
+}
+
+} // namespace native_log
+} // namespace amxprof
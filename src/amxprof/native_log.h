@@ -0,0 +1,70 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_NATIVE_LOG_H
+#define AMXPROF_NATIVE_LOG_H
+
+#include <iosfwd>
+#include <string>
+#include "stdint.h"
+
+namespace amxprof {
+
+// Format of the native call logs written by NativeRecorder and read by
+// NativeReplayer. All numbers are stored as variable-length integers
+// (LEB128), signed ones are zigzag-encoded first.
+//
+//   header:   "AMXNLOG" version num_natives name...
+//   snapshot: 'S' hea num_cells cell...
+//   exec:     'E' index num_args arg... hea num_heap_cells cell...
+//   native:   'N' index num_params param... result error
+//             num_writes (address num_cells cell...)...
+//
+// The snapshot holds the data and heap at the start of the recording.
+// Exec records mark calls to public functions, including those made from
+// natives. A native record comes after the calls made from that native
+// and lists the memory it changed.
+namespace native_log {
+
+extern const char kMagic[8];
+const uint32_t kVersion = 1;
+
+enum RecordType {
+  RECORD_SNAPSHOT = 'S',
+  RECORD_EXEC = 'E',
+  RECORD_NATIVE = 'N'
+};
+
+void WriteUnsigned(std::ostream &stream, uint32_t value);
+void WriteSigned(std::ostream &stream, int32_t value);
+void WriteString(std::ostream &stream, const std::string &value);
+
+bool ReadUnsigned(std::istream &stream, uint32_t &value);
+bool ReadSigned(std::istream &stream, int32_t &value);
+bool ReadString(std::istream &stream, std::string &value);
+
+} // namespace native_log
+} // namespace amxprof
+
+#endif // !AMXPROF_NATIVE_LOG_H
@@ -0,0 +1,229 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "amx_utils.h"
+#include "native_log.h"
+#include "native_recorder.h"
+
+namespace amxprof {
+
+namespace {
+
+void WriteCells(std::ostream &stream, const cell *cells, int num_cells) {
+  native_log::WriteUnsigned(stream, num_cells);
+  for (int i = 0; i < num_cells; i++) {
+    native_log::WriteSigned(stream, cells[i]);
+  }
+}
+
+// Returns the number of cells that can be read at address before the end
+// of the heap or the stack, or 0 if it's not a valid address. Values below
+// kMinDataAddress are most likely plain numbers and are not considered.
+int GetMaxBufferSize(AMX *amx, cell address) {
+  if (address < NativeRecorder::kMinDataAddress
+      || address % sizeof(cell) != 0) {
+    return 0;
+  }
+  cell end;
+  if (address < amx->hea) {
+    end = amx->hea;
+  } else if (address >= amx->stk && address < amx->stp) {
+    end = amx->stp;
+  } else {
+    return 0;
+  }
+  cell size = (end - address) / static_cast<cell>(sizeof(cell));
+  return size < NativeRecorder::kMaxBufferSize
+         ? size
+         : NativeRecorder::kMaxBufferSize;
+}
+
+// Guesses the size of the buffer passed as the index'th parameter. Natives
+// that write to an array usually take its size as the next parameter (as in
+// GetPlayerName(playerid, name[], len)); otherwise the buffer is assumed to
+// end at the first zero cell, which covers strings and single variables
+// passed by reference.
+int GetBufferSize(AMX *amx, const cell *params, int index) {
+  int max_size = GetMaxBufferSize(amx, params[index]);
+  if (max_size == 0) {
+    return 0;
+  }
+  int num_params = static_cast<int>(params[0] / sizeof(cell));
+  if (index < num_params
+      && params[index + 1] > 0
+      && params[index + 1] <= max_size) {
+    return params[index + 1];
+  }
+  const cell *start =
+    reinterpret_cast<cell*>(GetAmxDataPtr(amx) + params[index]);
+  int size = 0;
+  while (size < max_size && start[size] != 0) {
+    size++;
+  }
+  return size < max_size ? size + 1 : size;
+}
+
+} // anonymous namespace
+
+NativeRecorder::NativeRecorder()
+ : recording_(false)
+{
+}
+
+bool NativeRecorder::Open(const std::string &filename, AMX *amx) {
+  Close();
+  stream_.open(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream_.is_open()) {
+    return false;
+  }
+
+  int num_natives = 0;
+  amx_NumNatives(amx, &num_natives);
+
+  stream_.write(native_log::kMagic, sizeof(native_log::kMagic));
+  native_log::WriteUnsigned(stream_, native_log::kVersion);
+  native_log::WriteUnsigned(stream_, num_natives);
+  for (int i = 0; i < num_natives; i++) {
+    native_log::WriteString(stream_, GetNativeName(amx, i));
+  }
+  return true;
+}
+
+void NativeRecorder::Close() {
+  if (stream_.is_open()) {
+    stream_.close();
+  }
+  recording_ = false;
+  native_buffers_.clear();
+}
+
+void NativeRecorder::RecordExec(AMX *amx, int index, bool is_top_level) {
+  if (!stream_.is_open()) {
+    return;
+  }
+  if (!recording_) {
+    if (!is_top_level) {
+      return;
+    }
+    WriteSnapshot(amx);
+    recording_ = true;
+  }
+
+  unsigned char *data = GetAmxDataPtr(amx);
+
+  stream_.put(native_log::RECORD_EXEC);
+  native_log::WriteSigned(stream_, index);
+  WriteCells(stream_, reinterpret_cast<cell*>(data + amx->stk),
+             amx->paramcount);
+
+  // Arguments passed by reference (e.g. strings) are stored on the heap.
+  native_log::WriteSigned(stream_, amx->hea);
+  WriteCells(stream_, reinterpret_cast<cell*>(data + amx->hlw),
+             (amx->hea - amx->hlw) / sizeof(cell));
+}
+
+void NativeRecorder::BeginNative(AMX *amx, const cell *params) {
+  if (!recording_) {
+    return;
+  }
+
+  unsigned char *data = GetAmxDataPtr(amx);
+  int num_params = params[0] / sizeof(cell);
+
+  native_buffers_.push_back(Buffers());
+  Buffers &buffers = native_buffers_.back();
+
+  for (int i = 1; i <= num_params; i++) {
+    int size = GetBufferSize(amx, params, i);
+    if (size > 0) {
+      const cell *start = reinterpret_cast<cell*>(data + params[i]);
+      buffers.push_back(Buffer());
+      buffers.back().address = params[i];
+      buffers.back().contents.assign(start, start + size);
+    }
+  }
+}
+
+void NativeRecorder::EndNative(AMX *amx, cell index, const cell *params,
+                               cell result, int error) {
+  if (!recording_ || native_buffers_.empty()) {
+    return;
+  }
+
+  unsigned char *data = GetAmxDataPtr(amx);
+  int num_params = params[0] / sizeof(cell);
+
+  stream_.put(native_log::RECORD_NATIVE);
+  native_log::WriteUnsigned(stream_, index);
+  WriteCells(stream_, params + 1, num_params);
+  native_log::WriteSigned(stream_, result);
+  native_log::WriteSigned(stream_, error);
+
+  // Only the changed part of each buffer is written: from the first to the
+  // last cell that is different.
+  Buffers &buffers = native_buffers_.back();
+  std::vector<std::pair<cell, std::pair<int, int> > > writes;
+
+  for (Buffers::const_iterator iterator = buffers.begin();
+       iterator != buffers.end(); ++iterator) {
+    const cell *now = reinterpret_cast<cell*>(data + iterator->address);
+    int size = static_cast<int>(iterator->contents.size());
+    int first = 0;
+    while (first < size && now[first] == iterator->contents[first]) {
+      first++;
+    }
+    if (first == size) {
+      continue;
+    }
+    int last = size - 1;
+    while (now[last] == iterator->contents[last]) {
+      last--;
+    }
+    writes.push_back(std::make_pair(iterator->address,
+                                    std::make_pair(first, last + 1)));
+  }
+
+  native_log::WriteUnsigned(stream_, static_cast<uint32_t>(writes.size()));
+  for (std::size_t i = 0; i < writes.size(); i++) {
+    cell address = writes[i].first;
+    int first = writes[i].second.first;
+    int end = writes[i].second.second;
+    native_log::WriteSigned(stream_, address + first * sizeof(cell));
+    WriteCells(stream_,
+               reinterpret_cast<cell*>(data + address) + first,
+               end - first);
+  }
+
+  native_buffers_.pop_back();
+}
+
+void NativeRecorder::WriteSnapshot(AMX *amx) {
+  unsigned char *data = GetAmxDataPtr(amx);
+  stream_.put(native_log::RECORD_SNAPSHOT);
+  native_log::WriteSigned(stream_, amx->hea);
+  WriteCells(stream_, reinterpret_cast<cell*>(data),
+             amx->hea / sizeof(cell));
+}
+
+} // namespace amxprof
@@ -0,0 +1,90 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_NATIVE_RECORDER_H
+#define AMXPROF_NATIVE_RECORDER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "amx_types.h"
+#include "macros.h"
+
+namespace amxprof {
+
+// Records native calls made by a script, along with their results and the
+// memory they change, so that the script can later be re-run without the
+// server by NativeReplayer. See native_log.h for the file format.
+//
+// Which memory a native changes is guessed: every argument that looks like
+// an address of a variable is assumed to point to a buffer, which is
+// compared before and after the call. The buffer ends at the size passed
+// in the next argument or at the first zero cell, and is never longer than
+// kMaxBufferSize cells. Arguments below kMinDataAddress are taken for
+// numbers, so natives that write to the first few global variables can't
+// be replayed exactly.
+class NativeRecorder {
+ public:
+  static const int kMaxBufferSize = 1024;
+  static const int kMinDataAddress = 256;
+
+  NativeRecorder();
+
+  // Opens the log and writes the names of the script's natives. Nothing is
+  // recorded until the next top-level call to a public function.
+  bool Open(const std::string &filename, AMX *amx);
+  void Close();
+
+  bool is_open() const { return stream_.is_open(); }
+
+  // Called by the profiler before a public function is executed, after its
+  // arguments have been pushed.
+  void RecordExec(AMX *amx, int index, bool is_top_level);
+
+  // Called by the profiler before and after a native call.
+  void BeginNative(AMX *amx, const cell *params);
+  void EndNative(AMX *amx, cell index, const cell *params,
+                 cell result, int error);
+
+ private:
+  struct Buffer {
+    cell address;
+    std::vector<cell> contents;
+  };
+  typedef std::vector<Buffer> Buffers;
+
+  void WriteSnapshot(AMX *amx);
+
+ private:
+  std::ofstream stream_;
+  bool recording_;
+  std::vector<Buffers> native_buffers_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(NativeRecorder);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_NATIVE_RECORDER_H
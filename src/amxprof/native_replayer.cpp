@@ -0,0 +1,218 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+#include <vector>
+#include "amx_utils.h"
+#include "native_log.h"
+#include "native_replayer.h"
+
+namespace amxprof {
+
+NativeReplayer::NativeReplayer()
+ : exec_(0),
+   num_mismatches_(0)
+{
+}
+
+bool NativeReplayer::Open(const std::string &filename, AMX *amx) {
+  stream_.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream_.is_open()) {
+    error_ = "could not open " + filename;
+    return false;
+  }
+
+  char magic[sizeof(native_log::kMagic)];
+  uint32_t version;
+  stream_.read(magic, sizeof(magic));
+  if (!stream_.good()
+      || std::memcmp(magic, native_log::kMagic, sizeof(magic)) != 0
+      || !native_log::ReadUnsigned(stream_, version)
+      || version != native_log::kVersion) {
+    error_ = "not a native log or unsupported version";
+    return false;
+  }
+
+  uint32_t num_natives;
+  int script_num_natives = 0;
+  amx_NumNatives(amx, &script_num_natives);
+  if (!native_log::ReadUnsigned(stream_, num_natives)
+      || num_natives != static_cast<uint32_t>(script_num_natives)) {
+    error_ = "the log was recorded with a different script";
+    return false;
+  }
+  for (uint32_t i = 0; i < num_natives; i++) {
+    std::string name;
+    if (!native_log::ReadString(stream_, name)
+        || name != GetNativeName(amx, i)) {
+      error_ = "the log was recorded with a different script";
+      return false;
+    }
+  }
+
+  if (stream_.peek() == native_log::RECORD_SNAPSHOT) {
+    stream_.get();
+    int32_t hea;
+    if (!native_log::ReadSigned(stream_, hea) || !ReadCells(amx, 0)) {
+      error_ = "truncated log";
+      return false;
+    }
+    amx->hea = hea;
+  }
+  return true;
+}
+
+bool NativeReplayer::NextExec(AMX *amx, int &index) {
+  int type = stream_.get();
+  if (type == std::ifstream::traits_type::eof()) {
+    return false;
+  }
+  if (type != native_log::RECORD_EXEC) {
+    error_ = "expected a public function call";
+    return false;
+  }
+  return ReadExec(amx, index);
+}
+
+int NativeReplayer::Call(AMX *amx, cell index, cell *result, cell *params) {
+  // Calls to public functions made by this native come first.
+  while (stream_.peek() == native_log::RECORD_EXEC) {
+    stream_.get();
+    int exec_index;
+    if (!ReadExec(amx, exec_index)) {
+      return AMX_ERR_CALLBACK;
+    }
+    cell retval;
+    AMX_EXEC exec = exec_ != 0 ? exec_ : ::amx_Exec;
+    exec(amx, &retval, exec_index);
+  }
+
+  uint32_t logged_index;
+  uint32_t num_params;
+  if (stream_.get() != native_log::RECORD_NATIVE
+      || !native_log::ReadUnsigned(stream_, logged_index)
+      || !native_log::ReadUnsigned(stream_, num_params)) {
+    error_ = "expected a native call";
+    return AMX_ERR_CALLBACK;
+  }
+  if (logged_index != static_cast<uint32_t>(index)) {
+    error_ = "the script called a different native than in the log";
+    return AMX_ERR_CALLBACK;
+  }
+
+  bool mismatch = num_params != params[0] / sizeof(cell);
+  for (uint32_t i = 0; i < num_params; i++) {
+    int32_t param;
+    if (!native_log::ReadSigned(stream_, param)) {
+      error_ = "truncated log";
+      return AMX_ERR_CALLBACK;
+    }
+    if (!mismatch && param != params[i + 1]) {
+      mismatch = true;
+    }
+  }
+  if (mismatch) {
+    num_mismatches_++;
+  }
+
+  int32_t logged_result;
+  int32_t logged_error;
+  uint32_t num_writes;
+  if (!native_log::ReadSigned(stream_, logged_result)
+      || !native_log::ReadSigned(stream_, logged_error)
+      || !native_log::ReadUnsigned(stream_, num_writes)) {
+    error_ = "truncated log";
+    return AMX_ERR_CALLBACK;
+  }
+  for (uint32_t i = 0; i < num_writes; i++) {
+    int32_t address;
+    if (!native_log::ReadSigned(stream_, address)
+        || !ReadCells(amx, address)) {
+      error_ = "truncated log";
+      return AMX_ERR_CALLBACK;
+    }
+  }
+
+  *result = logged_result;
+  return logged_error;
+}
+
+bool NativeReplayer::ReadExec(AMX *amx, int &index) {
+  int32_t logged_index;
+  uint32_t num_args;
+  if (!native_log::ReadSigned(stream_, logged_index)
+      || !native_log::ReadUnsigned(stream_, num_args)) {
+    error_ = "truncated log";
+    return false;
+  }
+
+  std::vector<cell> args(num_args);
+  for (uint32_t i = 0; i < num_args; i++) {
+    int32_t arg;
+    if (!native_log::ReadSigned(stream_, arg)) {
+      error_ = "truncated log";
+      return false;
+    }
+    args[i] = arg;
+  }
+
+  int32_t hea;
+  if (!native_log::ReadSigned(stream_, hea) || !ReadCells(amx, amx->hlw)) {
+    error_ = "truncated log";
+    return false;
+  }
+  amx->hea = hea;
+
+  // The arguments were logged in stack order (first argument first).
+  for (uint32_t i = num_args; i > 0; i--) {
+    amx_Push(amx, args[i - 1]);
+  }
+
+  index = logged_index;
+  return true;
+}
+
+bool NativeReplayer::ReadCells(AMX *amx, cell address) {
+  uint32_t num_cells;
+  if (!native_log::ReadUnsigned(stream_, num_cells)) {
+    return false;
+  }
+  if (address < 0
+      || address % sizeof(cell) != 0
+      || num_cells > static_cast<uint32_t>((amx->stp - address) / sizeof(cell))) {
+    return false;
+  }
+  unsigned char *data = GetAmxDataPtr(amx);
+  cell *cells = reinterpret_cast<cell*>(data + address);
+  for (uint32_t i = 0; i < num_cells; i++) {
+    int32_t value;
+    if (!native_log::ReadSigned(stream_, value)) {
+      return false;
+    }
+    cells[i] = value;
+  }
+  return true;
+}
+
+} // namespace amxprof
@@ -0,0 +1,80 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_NATIVE_REPLAYER_H
+#define AMXPROF_NATIVE_REPLAYER_H
+
+#include <fstream>
+#include <string>
+#include "amx_types.h"
+#include "macros.h"
+
+namespace amxprof {
+
+// Re-runs a script from a log written by NativeRecorder: the recorded
+// public function calls are made again in the same order and each native
+// call returns the recorded result and makes the same changes to the
+// script's memory instead of doing the real work.
+class NativeReplayer {
+ public:
+  NativeReplayer();
+
+  // Opens the log and restores the script's memory to the state it was in
+  // when the recording started.
+  bool Open(const std::string &filename, AMX *amx);
+
+  // Sets the function that is called to run a public function, the
+  // default is amx_Exec().
+  void set_exec(AMX_EXEC exec) { exec_ = exec; }
+
+  // Reads the next top-level public function call and pushes its
+  // arguments. Returns false at the end of the log.
+  bool NextExec(AMX *amx, int &index);
+
+  // Must be installed as (or called from) the AMX callback.
+  int Call(AMX *amx, cell index, cell *result, cell *params);
+
+  // Number of native calls whose arguments were different from the ones
+  // in the log, which means the script went off the recorded path.
+  long num_mismatches() const { return num_mismatches_; }
+
+  const std::string &error() const { return error_; }
+
+ private:
+  bool ReadExec(AMX *amx, int &index);
+  bool ReadCells(AMX *amx, cell address);
+
+ private:
+  std::ifstream stream_;
+  AMX_EXEC exec_;
+  long num_mismatches_;
+  std::string error_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(NativeReplayer);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_NATIVE_REPLAYER_H
@@ -0,0 +1,95 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "perf_counters.h"
+
+namespace amxprof {
+
+namespace {
+
+const char *const kHardwareEventNames[EventCounts::kMaxEvents] = {
+  "Cycles",
+  "Instructions",
+  "Cache Misses",
+  "Branch Misses"
+};
+
+const char *const kSoftwareEventNames[EventCounts::kMaxEvents] = {
+  "Task Clock",
+  "Page Faults",
+  "Context Switches",
+  "CPU Migrations"
+};
+
+} // anonymous namespace
+
+EventCounts::EventCounts() {
+  for (int i = 0; i < kMaxEvents; i++) {
+    counts_[i] = 0;
+  }
+}
+
+EventCounts &EventCounts::operator+=(const EventCounts &other) {
+  for (int i = 0; i < kMaxEvents; i++) {
+    counts_[i] += other.counts_[i];
+  }
+  return *this;
+}
+
+EventCounts &EventCounts::operator-=(const EventCounts &other) {
+  for (int i = 0; i < kMaxEvents; i++) {
+    counts_[i] -= other.counts_[i];
+  }
+  return *this;
+}
+
+PerfCounters::PerfCounters()
+ : hardware_(false),
+   num_events_(0)
+{
+  for (int i = 0; i < EventCounts::kMaxEvents; i++) {
+    fds_[i] = -1;
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  Close();
+}
+
+bool PerfCounters::Open() {
+  Close();
+  if (OpenGroup(true)) {
+    return true;
+  }
+  return OpenGroup(false);
+}
+
+const char *PerfCounters::event_name(int index) const {
+  if (index < 0 || index >= num_events_) {
+    return "";
+  }
+  return hardware_ ? kHardwareEventNames[index] : kSoftwareEventNames[index];
+}
+
+} // namespace amxprof
@@ -0,0 +1,107 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_PERF_COUNTERS_H
+#define AMXPROF_PERF_COUNTERS_H
+
+#include "macros.h"
+#include "stdint.h"
+
+namespace amxprof {
+
+// Counts of the events measured by PerfCounters, in the same order as
+// PerfCounters::event_name().
+class EventCounts {
+ public:
+  static const int kMaxEvents = 4;
+
+  EventCounts();
+
+  uint64_t operator[](int index) const { return counts_[index]; }
+  uint64_t &operator[](int index) { return counts_[index]; }
+
+  EventCounts &operator+=(const EventCounts &other);
+  EventCounts &operator-=(const EventCounts &other);
+
+  EventCounts operator-(const EventCounts &other) const {
+    EventCounts result = *this;
+    return result -= other;
+  }
+
+ private:
+  uint64_t counts_[kMaxEvents];
+};
+
+// Performance monitoring counters of the calling thread. If the CPU's
+// PMU is available the counted events are cycles, instructions, cache
+// misses and branch misses. Otherwise (e.g. in most virtual machines)
+// software events are counted instead: task clock (in nanoseconds), page
+// faults, context switches and CPU migrations.
+//
+// This is only implemented on Linux, where it uses perf_event_open().
+// On other systems Open() always fails.
+class PerfCounters {
+ public:
+  // Indices of the hardware events in EventCounts.
+  enum HardwareEvent {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES
+  };
+
+  PerfCounters();
+  ~PerfCounters();
+
+  // Starts counting. Returns false if neither hardware nor software
+  // events could be opened, e.g. because of perf_event_paranoid.
+  bool Open();
+  void Close();
+
+  bool is_open() const { return num_events_ > 0; }
+
+  // Whether the hardware events are counted rather than software ones.
+  bool is_hardware() const { return hardware_; }
+
+  int num_events() const { return num_events_; }
+  const char *event_name(int index) const;
+
+  // Reads the current counts of all events at once.
+  void Read(EventCounts *counts);
+
+ private:
+  bool OpenGroup(bool hardware);
+
+ private:
+  bool hardware_;
+  int num_events_;
+  int fds_[EventCounts::kMaxEvents];
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(PerfCounters);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_PERF_COUNTERS_H
@@ -0,0 +1,121 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "perf_counters.h"
+#include "system_error.h"
+
+namespace amxprof {
+
+namespace {
+
+const uint64_t kHardwareEvents[EventCounts::kMaxEvents] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+
+const uint64_t kSoftwareEvents[EventCounts::kMaxEvents] = {
+  PERF_COUNT_SW_TASK_CLOCK,
+  PERF_COUNT_SW_PAGE_FAULTS,
+  PERF_COUNT_SW_CONTEXT_SWITCHES,
+  PERF_COUNT_SW_CPU_MIGRATIONS
+};
+
+// glibc has no wrapper for this system call.
+int PerfEventOpen(struct perf_event_attr *attr, int group_fd) {
+  // Count for the calling thread on whatever CPU it runs on.
+  return static_cast<int>(syscall(__NR_perf_event_open, attr, 0, -1,
+                                  group_fd, 0));
+}
+
+} // anonymous namespace
+
+bool PerfCounters::OpenGroup(bool hardware) {
+  const uint64_t *events = hardware ? kHardwareEvents : kSoftwareEvents;
+
+  for (int i = 0; i < EventCounts::kMaxEvents; i++) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = hardware ? PERF_TYPE_HARDWARE : PERF_TYPE_SOFTWARE;
+    attr.config = events[i];
+    attr.read_format = PERF_FORMAT_GROUP;
+    // Only the group leader starts disabled, the others follow it.
+    attr.disabled = i == 0;
+    // Kernel events require more privileges and aren't interesting here.
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    int fd = PerfEventOpen(&attr, i == 0 ? -1 : fds_[0]);
+    if (fd == -1) {
+      Close();
+      return false;
+    }
+    fds_[i] = fd;
+    num_events_ = i + 1;
+  }
+
+  ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+  hardware_ = hardware;
+  return true;
+}
+
+void PerfCounters::Close() {
+  for (int i = 0; i < EventCounts::kMaxEvents; i++) {
+    if (fds_[i] != -1) {
+      close(fds_[i]);
+      fds_[i] = -1;
+    }
+  }
+  hardware_ = false;
+  num_events_ = 0;
+}
+
+void PerfCounters::Read(EventCounts *counts) {
+  if (num_events_ == 0) {
+    return;
+  }
+
+  // With PERF_FORMAT_GROUP the leader returns the number of events
+  // followed by their values.
+  uint64_t data[1 + EventCounts::kMaxEvents];
+  if (read(fds_[0], data, sizeof(data)) == -1) {
+    throw SystemError("read");
+  }
+
+  int num_events = static_cast<int>(data[0]);
+  for (int i = 0; i < num_events && i < EventCounts::kMaxEvents; i++) {
+    (*counts)[i] = data[1 + i];
+  }
+}
+
+} // namespace amxprof
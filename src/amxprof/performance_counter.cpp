@@ -30,13 +30,22 @@ PerformanceCounter::PerformanceCounter(PerformanceCounter *parent,
                                        PerformanceCounter *shadow) 
  : started_(false),
    parent_(parent),
-   shadow_(shadow)
+   shadow_(shadow),
+   clock_(SystemClock::GetInstance()),
+   cpu_clock_(0),
+   perf_counters_(0)
 {
 }
 
 void PerformanceCounter::Start() {
   if (!started_) {
-    start_point_ = Clock::Now();
+    start_point_ = clock_->Now();
+    if (cpu_clock_ != 0) {
+      cpu_start_point_ = cpu_clock_->Now();
+    }
+    if (perf_counters_ != 0) {
+      perf_counters_->Read(&start_counts_);
+    }
     ResetTimes();
     started_ = true;
   }
@@ -44,24 +53,42 @@ void PerformanceCounter::Start() {
 
 void PerformanceCounter::Stop() {
   if (started_) {
-    Nanoseconds time = QueryTotalTime();
+    // Exclude the cost of timing this call and the calls made from it.
+    Nanoseconds time = QueryTotalTime() - inner_overhead_ - child_overhead_;
+    if (time < Nanoseconds(0)) {
+      time = 0;
+    }
 
-    if (shadow_ != 0) {
-      latest_total_time_ = 0;
-      latest_child_time_ = child_time_;
-    } else {
-      latest_total_time_ = time;
-      latest_child_time_ = child_time_;
+    Nanoseconds cpu_time;
+    if (cpu_clock_ != 0) {
+      // The profiler's overhead is CPU work too.
+      cpu_time = cpu_clock_->Now() - cpu_start_point_
+               - inner_overhead_ - child_overhead_;
+      if (cpu_time < Nanoseconds(0)) {
+        cpu_time = 0;
+      }
+    }
+
+    if (perf_counters_ != 0) {
+      perf_counters_->Read(&total_counts_);
+      total_counts_ -= start_counts_;
     }
 
-    total_time_ = time;
+    self_time_ = time - child_time_;
     if (parent_ != 0) {
       parent_->child_time_ += time;
+      parent_->child_overhead_ += child_overhead_ + full_overhead_;
+      parent_->child_counts_ += total_counts_;
     }
 
+    // A recursive call is part of the outer call to the same function (the
+    // shadow), so its time already counts towards the outer call's total.
     if (shadow_ != 0) {
-      shadow_->total_time_ -= total_time_;
-      shadow_->child_time_ -= self_time();
+      total_time_ = 0;
+      total_cpu_time_ = 0;
+    } else {
+      total_time_ = time;
+      total_cpu_time_ = cpu_time;
     }
 
     started_ = false;
@@ -69,10 +96,13 @@ void PerformanceCounter::Stop() {
 }
 
 void PerformanceCounter::ResetTimes() {
-  latest_total_time_ = 0;
-  latest_child_time_ = 0;
+  self_time_ = 0;
   total_time_ = 0;
+  total_cpu_time_ = 0;
+  total_counts_ = EventCounts();
+  child_counts_ = EventCounts();
   child_time_ = 0;
+  child_overhead_ = 0;
 }
 
 } // namespace amxprof
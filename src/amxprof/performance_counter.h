@@ -26,6 +26,7 @@
 #define AMXPROF_PERFORMANCE_COUNTER_H
 
 #include "clock.h"
+#include "perf_counters.h"
 
 namespace amxprof {
 
@@ -40,24 +41,56 @@ class PerformanceCounter {
   void ResetTimes();
 
   Nanoseconds QueryTotalTime() const {
-    return Clock::Now() - start_point_;
+    return clock_->Now() - start_point_;
+  }
+
+  // The clock used for measuring time, SystemClock by default.
+  Clock *clock() const { return clock_; }
+  void set_clock(Clock *clock) { clock_ = clock; }
+
+  // An optional second clock that measures CPU time rather than wall
+  // time, e.g. ThreadCpuClock. If set, total_cpu_time() is measured
+  // alongside total_time().
+  Clock *cpu_clock() const { return cpu_clock_; }
+  void set_cpu_clock(Clock *clock) { cpu_clock_ = clock; }
+
+  // If set, the events counted by these counters are measured as well.
+  PerfCounters *perf_counters() const { return perf_counters_; }
+  void set_perf_counters(PerfCounters *counters) {
+    perf_counters_ = counters;
   }
 
   void set_parent(PerformanceCounter *parent) { parent_ = parent; }
   void set_shadow(PerformanceCounter *shadow) { shadow_ = shadow; }
 
-  Nanoseconds latest_total_time() const { return latest_total_time_; }
-  Nanoseconds latest_child_time() const { return latest_child_time_; }
-
-  Nanoseconds latest_self_time() const {
-    return latest_total_time_ - latest_child_time_;
+  // Sets the profiler's overhead that should be excluded from measured
+  // times: inner is the part of the cost of timing a call that ends up
+  // in the call's own time, full is the whole cost, which ends up in the
+  // time of the caller.
+  void set_overhead(Nanoseconds inner, Nanoseconds full) {
+    inner_overhead_ = inner;
+    full_overhead_ = full;
   }
 
+  // Time spent in the call itself, excluding child calls.
+  Nanoseconds self_time() const { return self_time_; }
+
+  // Time spent in child calls.
   Nanoseconds child_time() const { return child_time_; }
+
+  // Time spent in the call, including child calls. This is zero for
+  // recursive calls (if there is a shadow), whose time is included in the
+  // total time of the outermost call to the same function.
   Nanoseconds total_time() const { return total_time_; }
 
-  Nanoseconds self_time() const {
-    return total_time_ - child_time_;
+  // CPU time spent in the call, including child calls. This is zero if
+  // there is no CPU clock and for recursive calls.
+  Nanoseconds total_cpu_time() const { return total_cpu_time_; }
+
+  // Events counted in the call itself, excluding child calls. All zero
+  // if there are no perf counters.
+  EventCounts self_counts() const {
+    return total_counts_ - child_counts_;
   }
 
  private:
@@ -66,12 +99,25 @@ class PerformanceCounter {
   PerformanceCounter *parent_;
   PerformanceCounter *shadow_;
 
+  Clock *clock_;
   TimePoint start_point_;
 
-  Nanoseconds latest_total_time_;
-  Nanoseconds latest_child_time_;
+  Clock *cpu_clock_;
+  TimePoint cpu_start_point_;
+
+  PerfCounters *perf_counters_;
+  EventCounts start_counts_;
+  EventCounts total_counts_;
+  EventCounts child_counts_;
+
+  Nanoseconds self_time_;
   Nanoseconds child_time_;
   Nanoseconds total_time_;
+  Nanoseconds total_cpu_time_;
+
+  Nanoseconds inner_overhead_;
+  Nanoseconds full_overhead_;
+  Nanoseconds child_overhead_;
 };
 
 } // namespace amxprof
@@ -0,0 +1,92 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_PLAYER_STATISTICS_H
+#define AMXPROF_PLAYER_STATISTICS_H
+
+#include "amx_types.h"
+#include "duration.h"
+
+namespace amxprof {
+
+class Function;
+
+// Calls to callbacks made on behalf of a single player, i.e. those with
+// the player's ID as their first argument.
+class PlayerStatistics {
+ public:
+  // Player IDs range from 0 to kMaxPlayers - 1 (MAX_PLAYERS in SA-MP).
+  static const int kMaxPlayers = 1000;
+
+  explicit PlayerStatistics(cell playerid = -1);
+
+  cell playerid() const { return playerid_; }
+
+  long num_calls() const { return num_calls_; }
+  void AdjustNumCalls(long delta) { num_calls_ += delta; }
+
+  // Number of calls that were timed, see FunctionStatistics.
+  long num_timed_calls() const { return num_timed_calls_; }
+  void AdjustNumTimedCalls(long delta) { num_timed_calls_ += delta; }
+
+  // Self time of the callbacks themselves and their total time including
+  // everything called from them. Extrapolated to all calls if only some
+  // of them were timed.
+  Nanoseconds self_time() const { return Extrapolate(self_time_); }
+  void AdjustSelfTime(Nanoseconds delta) { self_time_ += delta; }
+
+  Nanoseconds total_time() const { return Extrapolate(total_time_); }
+  void AdjustTotalTime(Nanoseconds delta) { total_time_ += delta; }
+
+  // The longest single call and the callback that was called.
+  Nanoseconds worst_time() const { return worst_time_; }
+  Function *worst_function() const { return worst_function_; }
+  void AddCall(Function *fn, Nanoseconds time) {
+    if (worst_function_ == 0 || time > worst_time_) {
+      worst_time_ = time;
+      worst_function_ = fn;
+    }
+  }
+
+ private:
+  Nanoseconds Extrapolate(Nanoseconds time) const {
+    if (num_timed_calls_ == 0 || num_timed_calls_ == num_calls_) {
+      return time;
+    }
+    return time.count() * num_calls_ / num_timed_calls_;
+  }
+
+ private:
+  cell playerid_;
+  long num_calls_;
+  long num_timed_calls_;
+  Nanoseconds self_time_;
+  Nanoseconds total_time_;
+  Nanoseconds worst_time_;
+  Function *worst_function_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_PLAYER_STATISTICS_H
@@ -23,19 +23,77 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include <cassert>
+#include <cstddef>
 #include "amx_utils.h"
+#include "call_site_statistics.h"
+#include "counter_statistics.h"
+#include "cross_script_call_statistics.h"
+#include "execution_context.h"
+#include "file_statistics.h"
+#include "flight_recorder.h"
 #include "function.h"
 #include "function_call.h"
 #include "function_statistics.h"
+#include "line_statistics.h"
+#include "module_utils.h"
+#include "native_recorder.h"
 #include "profiler.h"
+#include "public_caller_statistics.h"
+#include "redundant_call_statistics.h"
+#include "timer_statistics.h"
 
 namespace amxprof {
 
-Profiler::Profiler(AMX *amx, bool enable_call_graph)
+namespace {
+
+void EnterFile(FileStatistics *file_stats, bool timing) {
+  if (file_stats != 0) {
+    file_stats->AdjustNumCalls(1);
+    if (timing) {
+      file_stats->AdjustNumTimedCalls(1);
+    }
+    file_stats->EnterCall();
+  }
+}
+
+void LeaveFile(FileStatistics *file_stats,
+               const FunctionCall &fn_call,
+               bool timing) {
+  if (file_stats != 0) {
+    bool is_outermost = file_stats->LeaveCall();
+    if (timing) {
+      file_stats->AdjustSelfTime(fn_call.timer()->self_time());
+      if (is_outermost) {
+        file_stats->AdjustTotalTime(fn_call.timer()->total_time());
+      }
+    }
+  }
+}
+
+} // anonymous namespace
+
+Profiler::Profiler(AMX *amx, bool enable_call_graph, Clock *clock)
  : amx_(amx),
+   clock_(clock),
    debug_info_(0),
-   call_graph_enabled_(enable_call_graph)
+   call_graph_enabled_(enable_call_graph),
+   line_stats_enabled_(false),
+   call_site_stats_enabled_(false),
+   tick_stats_enabled_(false),
+   timer_stats_enabled_(false),
+   redundant_call_stats_enabled_(false),
+   memory_stats_enabled_(false),
+   timing_(true),
+   callback_depth_(0),
+   num_events_(0),
+   native_recorder_(0),
+   flight_recorder_(0),
+   current_line_(0),
+   stats_(clock),
+   pending_zone_begin_(0),
+   pending_zone_end_(false)
 {
+  call_stack_.set_clock(clock);
 }
 
 Profiler::~Profiler() {
@@ -43,9 +101,23 @@ Profiler::~Profiler() {
        iterator != functions_.end(); ++iterator) {
     delete *iterator;
   }
+  for (std::vector<Function*>::const_iterator iterator = zones_.begin();
+       iterator != zones_.end(); ++iterator) {
+    if (functions_.find(*iterator) == functions_.end()) {
+      delete *iterator;
+    }
+  }
 }
 
 int Profiler::DebugHook(AMX_DEBUG debug) {
+  if (line_stats_enabled_) {
+    EnterLine(amx_->cip);
+  }
+
+  if (memory_stats_enabled_) {
+    UpdateMemoryUsage();
+  }
+
   Address prev_frame = amx_->stp;
 
   if (!call_stack_.is_empty()) {
@@ -59,14 +131,23 @@ int Profiler::DebugHook(AMX_DEBUG debug) {
         Function *fn = stats_.GetFunction(address);
         if (fn == 0) {
           fn = Function::Normal(address, debug_info_);
-          functions_.insert(fn);
-          stats_.AddFunction(fn);
+          AddFunction(fn);
         }
-        EnterFunction(address, amx_->frm);
+        EnterFunction(address, amx_->frm,
+                      GetReturnAddress(amx_, amx_->frm));
       }
     }
   } else if (amx_->frm > prev_frame) {
-    if (call_stack_.top()->function()->type() == Function::NORMAL) {
+    // Zones still running when the function that started them returned
+    // end with it.
+    while (call_stack_.top()->function()->type() == Function::ZONE) {
+      LeaveFunction();
+      if (call_stack_.is_empty()) {
+        break;
+      }
+    }
+    if (!call_stack_.is_empty()
+        && call_stack_.top()->function()->type() == Function::NORMAL) {
       LeaveFunction();
     }
   }
@@ -85,97 +166,716 @@ int Profiler::CallbackHook(cell index, cell *result, cell *params, AMX_CALLBACK
 
   if (index >= 0) {
     Address address = GetNativeAddress(amx_, index);
+    Function *fn = 0;
+    // CIP points past the SYSREQ instruction.
+    Address call_site = amx_->cip;
     if (address != 0) {
-      Function *fn = stats_.GetFunction(address);
+      fn = stats_.GetFunction(address);
       if (fn == 0) {
         fn = Function::Native(amx_, index);
-        functions_.insert(fn);
-        stats_.AddFunction(fn);
+        AddFunction(fn);
       }
-      EnterFunction(address, amx_->frm);
+      EnterFunction(address, amx_->frm, call_site);
     }
+    if (native_recorder_ != 0) {
+      native_recorder_->BeginNative(amx_, params);
+    }
+    bool is_redundant = redundant_call_stats_enabled_
+                        && fn != 0
+                        && redundant_call_detector_.CheckCall(address, params);
+    TimePoint native_start;
+    if (is_redundant && timing_) {
+      native_start = clock_->Now();
+    }
+    callback_depth_++;
     int error = callback(amx_, index, result, params);
+    callback_depth_--;
+    if (is_redundant) {
+      AddRedundantCall(fn, call_site,
+                       timing_ ? clock_->Now() - native_start
+                               : Nanoseconds(0));
+    }
+    if (native_recorder_ != 0) {
+      native_recorder_->EndNative(amx_, index, params, *result, error);
+    }
+    if (timer_stats_enabled_ && fn != 0 && error == AMX_ERR_NONE) {
+      TrackTimerNative(fn, call_site, params, *result);
+    }
     if (address != 0) {
       LeaveFunction(address);
     }
+    if (pending_zone_begin_ != 0 || pending_zone_end_) {
+      RunPendingZoneOp();
+    }
     return error;
   }
 
   return callback(amx_, index, result, params);
 }
 
-int Profiler::ExecHook(cell *retval, int index, AMX_EXEC exec) {
+int Profiler::ExecHook(cell *retval,
+                       int index,
+                       AMX_EXEC exec,
+                       const void *return_address) {
   if (exec == 0) {
     exec = ::amx_Exec;
   }
 
   if (index >= 0 || index == AMX_EXEC_MAIN) {
+    // Whether the call is timed or not is decided once per top-level call
+    // and applies to everything called from it.
+    bool is_top_level = call_stack_.is_empty();
+    TimePoint start;
+    if (is_top_level) {
+      if (redundant_call_stats_enabled_) {
+        redundant_call_detector_.Reset();
+      }
+      timing_ = sampler_.SampleNextCall();
+      if (sampler_.is_adaptive()) {
+        start = clock_->Now();
+      }
+    }
+    // If another profiled script is running this call came from one of
+    // its natives, e.g. CallRemoteFunction.
+    ExecutionContext *context = ExecutionContext::GetInstance();
+    Profiler *caller = context->current();
+    if (caller == this || (caller != 0 && caller->call_stack_.is_empty())) {
+      caller = 0;
+    }
+    Function *fn = 0;
     Address address = GetPublicAddress(amx_, index);
     if (address != 0) {
-      Function *fn = stats_.GetFunction(address);
+      fn = stats_.GetFunction(address);
       if (fn == 0) {
-        fn = Function::Public(amx_, index);
-        functions_.insert(fn);
-        stats_.AddFunction(fn);
+        fn = Function::Public(amx_, index, debug_info_);
+        AddFunction(fn);
       }
       EnterFunction(address, amx_->stk - 3 * sizeof(cell));
+      // The arguments have been pushed in reverse order, so the first one
+      // is on top of the stack.
+      if (!player_callbacks_.empty()
+          && amx_->paramcount > 0
+          && player_callbacks_.find(index) != player_callbacks_.end()) {
+        cell playerid =
+          *reinterpret_cast<cell*>(GetAmxDataPtr(amx_) + amx_->stk);
+        PlayerStatistics *player_stats = stats_.GetPlayerStatistics(playerid);
+        if (player_stats != 0) {
+          player_stats->AdjustNumCalls(1);
+          if (timing_) {
+            player_stats->AdjustNumTimedCalls(1);
+          }
+          call_stack_.top()->set_player_stats(player_stats);
+        }
+      }
+    }
+    if (native_recorder_ != 0) {
+      native_recorder_->RecordExec(amx_, index, is_top_level);
     }
+    // Timers are run by the server between script calls.
+    TimerStatistics *timer_stats = 0;
+    if (timer_stats_enabled_ && is_top_level && caller == 0 && fn != 0) {
+      TimerStatistics *fired_stats =
+        timer_tracker_.FireTimer(fn, clock_->Now());
+      if (fired_stats != 0 && timing_) {
+        fired_stats->AdjustNumTimedFires(1);
+        timer_stats = fired_stats;
+      }
+    }
+    // Only timed calls need their time added to the calling module.
+    PublicCallerStatistics *caller_stats = 0;
+    if (return_address != 0 && fn != 0) {
+      PublicCallerStatistics *module_stats =
+        stats_.GetOrAddPublicCaller(GetCallerModule(return_address), fn);
+      module_stats->AdjustNumCalls(1);
+      if (timing_) {
+        module_stats->AdjustNumTimedCalls(1);
+        caller_stats = module_stats;
+      }
+    }
+    TimePoint exec_start;
+    if (caller != 0 || caller_stats != 0 || timer_stats != 0) {
+      exec_start = clock_->Now();
+    }
+    context->Enter(this);
     int error = exec(amx_, retval, index);
+    context->Leave();
+    if (caller != 0 || caller_stats != 0 || timer_stats != 0) {
+      Nanoseconds exec_time = clock_->Now() - exec_start;
+      if (caller != 0 && fn != 0) {
+        AddCrossScriptCall(caller, fn, exec_time);
+      }
+      if (caller_stats != 0) {
+        caller_stats->AdjustTime(exec_time);
+      }
+      if (timer_stats != 0) {
+        timer_stats->AdjustTime(exec_time);
+      }
+    }
     if (address != 0) {
       LeaveFunction(address);
     }
+    if (call_stack_.is_empty()) {
+      LeaveLine();
+    }
+    if (is_top_level && sampler_.is_adaptive()) {
+      sampler_.AddScriptTime(clock_->Now() - start);
+    }
     return error;
   }
 
   return exec(amx_, retval, index);
 }
 
-void Profiler::EnterFunction(Address address, Address frm) {
+void Profiler::CheckSlowCall(const FunctionCall &fn_call, Nanoseconds time) {
+  // Calls shorter than this are not worth showing as part of a slow call.
+  static const int kFrameThresholdDivisor = 10;
+  static const std::size_t kMaxFrames = 256;
+
+  if (time.count() < slow_call_threshold_.count() / kFrameThresholdDivisor) {
+    return;
+  }
+
+  // The call has already been popped off the stack.
+  std::string stack;
+  int depth = 0;
+  for (CallStack::const_iterator iterator = call_stack_.begin();
+       iterator != call_stack_.end(); ++iterator) {
+    stack.append(iterator->function()->name()).append(" > ");
+    depth++;
+  }
+  stack.append(fn_call.function()->name());
+
+  SlowCallFrame frame(stack, depth, time);
+
+  if (fn_call.function()->type() == Function::PUBLIC
+      && time > slow_call_threshold_) {
+    // Frames are added as calls return, so the ones made from this call
+    // are those at the end that are deeper than it.
+    std::vector<SlowCallFrame>::size_type first = slow_frames_.size();
+    while (first > 0 && slow_frames_[first - 1].depth() > depth) {
+      first--;
+    }
+    std::vector<SlowCallFrame> frames(slow_frames_.begin() + first,
+                                      slow_frames_.end());
+    stats_.slow_calls()->Add(SlowCall(frame, frames));
+  }
+
+  if (slow_frames_.size() < kMaxFrames) {
+    slow_frames_.push_back(frame);
+  }
+}
+
+void Profiler::RunPendingZoneOp() {
+  if (pending_zone_begin_ != 0) {
+    if (functions_.find(pending_zone_begin_) == functions_.end()) {
+      AddFunction(pending_zone_begin_);
+    }
+    // Zones don't have a frame of their own, so they share the frame of
+    // the function that started them.
+    EnterFunction(pending_zone_begin_->address(), amx_->frm);
+    pending_zone_begin_ = 0;
+  }
+  if (pending_zone_end_) {
+    if (!call_stack_.is_empty()
+        && call_stack_.top()->function()->type() == Function::ZONE) {
+      LeaveFunction(call_stack_.top()->function()->address());
+    }
+    pending_zone_end_ = false;
+  }
+}
+
+void Profiler::AddRedundantCall(Function *native,
+                                Address call_site,
+                                Nanoseconds time) {
+  RedundantCallStatistics *call_stats =
+    stats_.GetRedundantCallStatistics(native->address(), call_site);
+  if (call_stats == 0) {
+    std::string file;
+    long line = 0;
+    if (debug_info_ != 0 && debug_info_->is_loaded()) {
+      file = debug_info_->LookupFile(call_site - sizeof(cell));
+      line = debug_info_->LookupLine(call_site - sizeof(cell));
+    }
+    call_stats = stats_.AddRedundantCall(native, call_site, file, line);
+  }
+  call_stats->AdjustNumCalls(1);
+  if (timing_) {
+    call_stats->AdjustNumTimedCalls(1);
+    call_stats->AdjustTime(time);
+  }
+}
+
+void Profiler::UpdateMemoryUsage() {
+  if (!call_stack_.is_empty()) {
+    call_stack_.top()->UpdateMemory(amx_->stk, amx_->hea);
+  }
+  stats_.UpdateMemoryUsage(amx_->stp - amx_->stk, amx_->hea - amx_->hlw);
+}
+
+const std::string &Profiler::GetCallerModule(const void *return_address) {
+  std::map<const void*, std::string>::iterator iterator =
+    caller_modules_.find(return_address);
+  if (iterator == caller_modules_.end()) {
+    std::string module = GetModuleName(return_address);
+    if (module.empty()) {
+      module = "unknown";
+    }
+    iterator =
+      caller_modules_.insert(std::make_pair(return_address, module)).first;
+  }
+  return iterator->second;
+}
+
+void Profiler::AddCrossScriptCall(Profiler *caller,
+                                  Function *callee,
+                                  Nanoseconds time) {
+  // The caller's stack ends with the native that made the call.
+  std::string caller_stack;
+  for (CallStack::const_iterator iterator = caller->call_stack_.begin();
+       iterator != caller->call_stack_.end(); ++iterator) {
+    if (!caller_stack.empty()) {
+      caller_stack.append(" > ");
+    }
+    caller_stack.append(iterator->function()->name());
+  }
+
+  Statistics *all_stats[] = {&caller->stats_, &stats_};
+  for (std::size_t i = 0; i < sizeof(all_stats) / sizeof(*all_stats); i++) {
+    CrossScriptCallStatistics *call_stats =
+      all_stats[i]->GetOrAddCrossScriptCall(caller->name_, caller_stack,
+                                            name_, callee->name());
+    call_stats->AdjustNumCalls(1);
+    call_stats->AdjustTime(time);
+  }
+}
+
+void Profiler::Calibrate(bool compensate) {
+  static const int kNumRounds = 5;
+  static const int kNumCalls = 1000;
+
+  // Fake function addresses. They don't need to be valid because the
+  // calls are made on a separate profiler instance.
+  static const Address kCallerAddress = 1;
+  static const Address kCalleeAddress = 2;
+  static const Address kCallSiteAddress = 3;
+
+  Nanoseconds min_inner_time;
+  Nanoseconds min_full_time;
+
+  // Take the best of several rounds to filter out interruptions.
+  for (int i = 0; i < kNumRounds; i++) {
+    Profiler profiler(amx_, call_graph_enabled_, clock_);
+    profiler.set_call_site_stats_enabled(call_site_stats_enabled_);
+    profiler.set_cpu_clock(cpu_clock());
+    profiler.set_perf_counters(perf_counters());
+    Function *caller = Function::Normal(kCallerAddress);
+    Function *callee = Function::Normal(kCalleeAddress);
+    profiler.functions_.insert(caller);
+    profiler.functions_.insert(callee);
+    profiler.stats_.AddFunction(caller);
+    profiler.stats_.AddFunction(callee);
+
+    profiler.EnterFunction(kCallerAddress, 0);
+    TimePoint start = clock_->Now();
+    for (int j = 0; j < kNumCalls; j++) {
+      profiler.EnterFunction(kCalleeAddress, 0, kCallSiteAddress);
+      profiler.LeaveFunction(kCalleeAddress);
+    }
+    Nanoseconds full_time = (clock_->Now() - start).count() / kNumCalls;
+    profiler.LeaveFunction(kCallerAddress);
+
+    // Calls to the callee take no time by themselves, so whatever was
+    // measured is the part of the overhead included in the call's time.
+    FunctionStatistics *callee_stats =
+      profiler.stats_.GetFunctionStatistics(kCalleeAddress);
+    Nanoseconds inner_time = callee_stats->total_time().count() / kNumCalls;
+
+    if (i == 0 || full_time < min_full_time) {
+      min_full_time = full_time;
+    }
+    if (i == 0 || inner_time < min_inner_time) {
+      min_inner_time = inner_time;
+    }
+  }
+
+  call_overhead_ = min_full_time;
+  if (compensate) {
+    call_stack_.set_overhead(min_inner_time, min_full_time);
+  }
+}
+
+int Profiler::GetZoneId(const std::string &name) {
+  std::map<std::string, int>::const_iterator iterator = zone_ids_.find(name);
+  if (iterator != zone_ids_.end()) {
+    return iterator->second;
+  }
+  // The zone is added to the statistics when it's first entered.
+  Function *zone = Function::Zone(name);
+  int id = static_cast<int>(zones_.size());
+  zones_.push_back(zone);
+  zone_ids_.insert(std::make_pair(name, id));
+  return id;
+}
+
+bool Profiler::BeginZone(int id) {
+  if (id < 0 || id >= static_cast<int>(zones_.size())) {
+    return false;
+  }
+  pending_zone_begin_ = zones_[id];
+  if (callback_depth_ == 0) {
+    RunPendingZoneOp();
+  }
+  return true;
+}
+
+bool Profiler::EndZone() {
+  // When called from a native the zone is below the native's call.
+  const FunctionCall *call = 0;
+  if (!call_stack_.is_empty()) {
+    call = call_stack_.top();
+    if (callback_depth_ > 0
+        && call->function()->type() == Function::NATIVE) {
+      call = call->parent();
+    }
+  }
+  if (call == 0 || call->function()->type() != Function::ZONE) {
+    return false;
+  }
+  pending_zone_end_ = true;
+  if (callback_depth_ == 0) {
+    RunPendingZoneOp();
+  }
+  return true;
+}
+
+int Profiler::GetCounterId(const std::string &name) {
+  std::map<std::string, int>::const_iterator iterator =
+    counter_ids_.find(name);
+  if (iterator != counter_ids_.end()) {
+    return iterator->second;
+  }
+  int id = stats_.AddCounter(name)->id();
+  counter_ids_.insert(std::make_pair(name, id));
+  return id;
+}
+
+bool Profiler::SetCounter(int id, cell value) {
+  CounterStatistics *counter_stats = stats_.GetCounterStatistics(id);
+  if (counter_stats == 0) {
+    return false;
+  }
+  counter_stats->AddSample(value);
+  return true;
+}
+
+void Profiler::set_memory_stats_enabled(bool enabled) {
+  memory_stats_enabled_ = enabled;
+  stats_.set_memory_measured(enabled);
+  stats_.set_stack_heap_size(amx_->stp - amx_->hlw);
+}
+
+int Profiler::SetPlayerCallbacks(const std::vector<std::string> &names) {
+  player_callbacks_.clear();
+  for (std::vector<std::string>::const_iterator it = names.begin();
+       it != names.end(); ++it) {
+    int index;
+    if (amx_FindPublic(amx_, it->c_str(), &index) == AMX_ERR_NONE) {
+      player_callbacks_.insert(index);
+    }
+  }
+  return static_cast<int>(player_callbacks_.size());
+}
+
+void Profiler::EndTick() {
+  assert(call_stack_.is_empty());
+  if (tick_stats_enabled_) {
+    TimePoint now = clock_->Now();
+    Nanoseconds interval;
+    if (stats_.ticks()->num_ticks() > 0) {
+      interval = now - last_tick_end_;
+    }
+    stats_.ticks()->EndTick(interval);
+    last_tick_end_ = now;
+  }
+  if (timer_stats_enabled_) {
+    timer_tracker_.EndTick();
+  }
+  tick_script_time_ = Nanoseconds();
+}
+
+void Profiler::TrackTimerNative(Function *native,
+                                Address call_site,
+                                const cell *params,
+                                cell result) {
+  const std::string &name = native->name();
+
+  if (name == "KillTimer") {
+    timer_tracker_.KillTimer(params[1]);
+    return;
+  }
+  if ((name != "SetTimer" && name != "SetTimerEx") || result == 0) {
+    return;
+  }
+
+  int index;
+  std::string public_name = GetAmxString(amx_, params[1]);
+  if (amx_FindPublic(amx_, public_name.c_str(), &index) != AMX_ERR_NONE) {
+    return;
+  }
+  Address address = GetPublicAddress(amx_, index);
+  Function *fn = stats_.GetFunction(address);
+  if (fn == 0) {
+    fn = Function::Public(amx_, index, debug_info_);
+    AddFunction(fn);
+  }
+
+  TimerStatistics *timer_stats =
+    stats_.GetTimerStatistics(address, call_site);
+  if (timer_stats == 0) {
+    std::string file;
+    long line = 0;
+    if (debug_info_ != 0 && debug_info_->is_loaded()) {
+      file = debug_info_->LookupFile(call_site - sizeof(cell));
+      line = debug_info_->LookupLine(call_site - sizeof(cell));
+    }
+    timer_stats = stats_.AddTimer(fn, call_site, file, line);
+  }
+
+  Milliseconds interval(static_cast<double>(params[2]));
+  bool repeating = params[3] != 0;
+  timer_stats->AddTimer(interval, repeating);
+  timer_tracker_.AddTimer(result, fn, timer_stats, interval, repeating,
+                          clock_->Now());
+}
+
+void Profiler::set_flight_recorder(FlightRecorder *recorder) {
+  flight_recorder_ = recorder;
+  if (recorder != 0) {
+    for (std::set<Function*>::const_iterator it = functions_.begin();
+         it != functions_.end(); ++it) {
+      recorder->AddFunction(*it);
+    }
+  }
+}
+
+void Profiler::AddFunction(Function *fn) {
+  functions_.insert(fn);
+  stats_.AddFunction(fn);
+  if (flight_recorder_ != 0) {
+    flight_recorder_->AddFunction(fn);
+  }
+}
+
+void Profiler::EnterFunction(Address address, Address frm, Address call_site) {
   assert(address != 0);
+  num_events_++;
+
+  if (flight_recorder_ != 0) {
+    flight_recorder_->RecordEvent(FlightRecorder::ENTER,
+                                  address,
+                                  clock_->Now());
+  }
+
+  bool measure_cost = sampler_.ShouldMeasureEvent();
+  TimePoint start;
+  if (measure_cost) {
+    start = clock_->Now();
+  }
+
   FunctionStatistics *fn_stats = stats_.GetFunctionStatistics(address);
 
   assert(fn_stats != 0);
   fn_stats->AdjustNumCalls(1);
 
-  call_stack_.Push(fn_stats->function(), frm);
-  if (call_graph_enabled_) {
-    call_graph_.AddCallee(fn_stats)->MakeRoot();
+  EnterFile(fn_stats->file_stats(), timing_);
+  EnterFile(fn_stats->directory_stats(), timing_);
+  EnterFile(fn_stats->module_stats(), timing_);
+
+  if (memory_stats_enabled_) {
+    UpdateMemoryUsage();
+  }
+
+  call_stack_.Push(fn_stats->function(), frm, timing_);
+
+  if (memory_stats_enabled_) {
+    call_stack_.top()->InitMemory(amx_->stk, amx_->hea);
+  }
+
+  if (call_site != 0 && call_site_stats_enabled_) {
+    CallSiteStatistics *site_stats =
+      stats_.GetCallSiteStatistics(address, call_site);
+    if (site_stats == 0) {
+      // The return address may already belong to the next line, so look
+      // up the location of the call instruction's last cell instead.
+      std::string file;
+      long line = 0;
+      if (debug_info_ != 0 && debug_info_->is_loaded()) {
+        file = debug_info_->LookupFile(call_site - sizeof(cell));
+        line = debug_info_->LookupLine(call_site - sizeof(cell));
+      }
+      site_stats = stats_.AddCallSite(fn_stats->function(), call_site,
+                                      file, line);
+    }
+    site_stats->AdjustNumCalls(1);
+    if (timing_) {
+      site_stats->AdjustNumTimedCalls(1);
+    }
+    call_stack_.top()->set_call_site(site_stats);
+  }
+
+  if (timing_) {
+    fn_stats->AdjustNumTimedCalls(1);
+    if (call_graph_enabled_) {
+      CallGraphEdge *edge = call_graph_.AddCallee(fn_stats);
+      edge->AdjustNumCalls(1);
+      edge->callee()->MakeRoot();
+      call_stack_.top()->set_call_graph_edge(edge);
+    }
+  }
+
+  if (measure_cost) {
+    sampler_.AddEventCost(clock_->Now() - start);
   }
 }
 
 void Profiler::LeaveFunction(Address address) {
   assert(!call_stack_.is_empty());
   assert(address == 0 || stats_.GetFunction(address) != 0);
+  num_events_++;
+
+  bool measure_cost = sampler_.ShouldMeasureEvent();
+  TimePoint start;
+  if (measure_cost) {
+    start = clock_->Now();
+  }
+
+  TimePoint leave_time;
+  if (flight_recorder_ != 0) {
+    leave_time = clock_->Now();
+  }
 
   while (true) {
     FunctionCall fn_call = call_stack_.Pop();
-
     FunctionStatistics *fn_stats =
       stats_.GetFunctionStatistics(fn_call.function()->address());
     assert(fn_stats != 0);
 
-    fn_stats->AdjustSelfTime(fn_call.timer()->self_time());
-    fn_stats->AdjustTotalTime(fn_call.timer()->total_time());
-
-    Nanoseconds total_time = fn_call.timer()->latest_total_time();
-    if (total_time > fn_stats->worst_total_time()) {
-      fn_stats->set_worst_total_time(total_time);
+    if (flight_recorder_ != 0) {
+      flight_recorder_->RecordEvent(FlightRecorder::LEAVE,
+                                    fn_call.function()->address(),
+                                    leave_time);
     }
 
-    Nanoseconds self_time = fn_call.timer()->latest_self_time();
-    if (self_time > fn_stats->worst_self_time()) {
-      fn_stats->set_worst_self_time(self_time);
+    LeaveFile(fn_stats->file_stats(), fn_call, timing_);
+    LeaveFile(fn_stats->directory_stats(), fn_call, timing_);
+    LeaveFile(fn_stats->module_stats(), fn_call, timing_);
+
+    if (memory_stats_enabled_) {
+      fn_call.UpdateMemory(amx_->stk, amx_->hea);
+      fn_stats->UpdateMaxStackUsage(fn_call.stack_base()
+                                    - fn_call.stack_low());
+      fn_stats->UpdateMaxHeapUsage(fn_call.heap_high()
+                                   - fn_call.heap_base());
+      fn_stats->AdjustHeapGrowth(amx_->hea - fn_call.heap_base());
+      fn_stats->UpdateMaxRecursionDepth(fn_call.recursion_depth());
+      if (!call_stack_.is_empty()) {
+        call_stack_.top()->UpdateMemory(fn_call.stack_low(),
+                                        fn_call.heap_high());
+      }
     }
 
-    if (call_graph_enabled_) {
-      assert(call_graph_.root() != call_graph_.sentinel());
-      call_graph_.set_root(call_graph_.root()->caller());
+    if (timing_) {
+
+      fn_stats->AdjustSelfTime(fn_call.timer()->self_time());
+      fn_stats->AdjustTotalTime(fn_call.timer()->total_time());
+      fn_stats->AdjustCpuTime(fn_call.timer()->total_cpu_time());
+      fn_stats->AdjustSelfCounts(fn_call.timer()->self_counts());
+
+      Nanoseconds total_time = fn_call.timer()->total_time();
+      if (total_time > fn_stats->worst_total_time()) {
+        fn_stats->set_worst_total_time(total_time);
+      }
+
+      Nanoseconds self_time = fn_call.timer()->self_time();
+      if (self_time > fn_stats->worst_self_time()) {
+        fn_stats->set_worst_self_time(self_time);
+      }
+
+      if (fn_call.call_site() != 0) {
+        fn_call.call_site()->AdjustTime(total_time);
+      }
+
+      PlayerStatistics *player_stats = fn_call.player_stats();
+      if (player_stats != 0) {
+        player_stats->AdjustSelfTime(self_time);
+        player_stats->AdjustTotalTime(total_time);
+        player_stats->AddCall(fn_call.function(), total_time);
+      }
+
+      // A function can be called from several places, so the new root
+      // is wherever this particular call came from.
+      CallGraphEdge *edge = fn_call.call_graph_edge();
+      if (edge != 0) {
+        edge->AdjustTime(total_time);
+        call_graph_.set_root(edge->caller());
+      }
+
+      if (slow_call_threshold_ > Nanoseconds(0)) {
+        CheckSlowCall(fn_call, total_time);
+      }
+
+      tick_script_time_ += self_time;
+      if (tick_stats_enabled_) {
+        stats_.ticks()->AddTime(fn_call.function(), self_time);
+      }
     }
 
     if (address == 0 || fn_call.function()->address() == address) {
       break;
     }
   }
+
+  if (call_stack_.is_empty()) {
+    slow_frames_.clear();
+  }
+
+  if (measure_cost) {
+    sampler_.AddEventCost(clock_->Now() - start);
+  }
+}
+
+void Profiler::EnterLine(Address address) {
+  LineStatistics *line_stats = stats_.GetLineStatistics(address);
+  if (line_stats == 0) {
+    std::string file;
+    long line = 0;
+    if (debug_info_ != 0 && debug_info_->is_loaded()) {
+      file = debug_info_->LookupFile(address);
+      line = debug_info_->LookupLine(address);
+    }
+    line_stats = stats_.AddLine(address, file, line);
+  }
+
+  line_stats->AdjustNumHits(1);
+  if (!timing_) {
+    return;
+  }
+
+  TimePoint now = clock_->Now();
+  if (current_line_ != 0) {
+    current_line_->AdjustTime(now - current_line_start_);
+  }
+
+  line_stats->AdjustNumTimedHits(1);
+  current_line_ = line_stats;
+  current_line_start_ = now;
+}
+
+void Profiler::LeaveLine() {
+  if (current_line_ != 0) {
+    current_line_->AdjustTime(clock_->Now() - current_line_start_);
+    current_line_ = 0;
+  }
 }
 
 } // namespace amxprof
@@ -25,28 +25,85 @@
 #ifndef AMXPROF_PROFILER_H
 #define AMXPROF_PROFILER_H
 
+#include <map>
 #include <set>
+#include <string>
+#include <vector>
 #include "amx_types.h"
 #include "call_graph.h"
 #include "call_stack.h"
+#include "clock.h"
 #include "debug_info.h"
 #include "function_statistics.h"
 #include "macros.h"
+#include "redundant_call_detector.h"
+#include "sampler.h"
 #include "statistics.h"
+#include "stdint.h"
+#include "timer_tracker.h"
 
 namespace amxprof {
 
+class FlightRecorder;
+class LineStatistics;
+class NativeRecorder;
+
 class Profiler {
  public:
-  Profiler(AMX *amx, bool enable_call_graph = false);
+  // All times are measured with the given clock. The clock must outlive
+  // the profiler.
+  Profiler(AMX *amx,
+           bool enable_call_graph = false,
+           Clock *clock = SystemClock::GetInstance());
   ~Profiler();
 
  public:
   const Statistics *stats() const { return &stats_; }
 
+  // Name of the script, used to identify it in calls between scripts.
+  const std::string &name() const { return name_; }
+  void set_name(const std::string &name) { name_ = name; }
+
+  Clock *clock() const { return clock_; }
+
+  // If set, CPU time is measured with this clock alongside wall time,
+  // which exposes time spent blocked outside the CPU (e.g. in natives
+  // doing I/O). Must be set before Calibrate().
+  Clock *cpu_clock() const { return call_stack_.cpu_clock(); }
+  void set_cpu_clock(Clock *clock) {
+    call_stack_.set_cpu_clock(clock);
+    stats_.set_cpu_time_measured(clock != 0);
+  }
+
+  // If set, the counters' events (cycles, instructions, etc) are counted
+  // for each function alongside its time. The counters must be open and
+  // outlive the profiler. Must be set before Calibrate().
+  PerfCounters *perf_counters() const { return call_stack_.perf_counters(); }
+  void set_perf_counters(PerfCounters *counters) {
+    call_stack_.set_perf_counters(counters);
+    stats_.set_perf_counters(counters);
+  }
+
   const CallStack *call_stack() const { return &call_stack_; }
   const CallGraph *call_graph() const { return &call_graph_; }
 
+  // Controls which public function calls are timed. By default all calls
+  // are timed.
+  Sampler *sampler() { return &sampler_; }
+  const Sampler *sampler() const { return &sampler_; }
+
+  // Measures how long it takes the profiler to time a single function
+  // call. If compensate is true this overhead will be subtracted from
+  // the measured times of all subsequent calls.
+  void Calibrate(bool compensate = true);
+
+  // The cost of timing a call (one enter and one leave event), as
+  // measured by Calibrate().
+  Nanoseconds call_overhead() const { return call_overhead_; }
+
+  // Total number of enter and leave events processed so far.
+  uint64_t num_events() const { return num_events_; }
+
   // Debug info is needed for function names. If not set the functions
   // will be shown as "unknown@XXXXXXXX" where XXXXXXXX is the AMX code
   // offset (except for public functions, whose names are duplicated
@@ -55,6 +112,101 @@ class Profiler {
     debug_info_ = debug_info;
   }
 
+  // Enables collection of per-line statistics in DebugHook(). This only
+  // works if the debug hook is called on every statement, i.e. when the
+  // script is compiled with -d2 or -d3.
+  bool line_stats_enabled() const { return line_stats_enabled_; }
+  void set_line_stats_enabled(bool enabled) {
+    line_stats_enabled_ = enabled;
+  }
+
+  // Enables collection of per-call site statistics for natives and
+  // normal functions.
+  bool call_site_stats_enabled() const { return call_site_stats_enabled_; }
+  void set_call_site_stats_enabled(bool enabled) {
+    call_site_stats_enabled_ = enabled;
+  }
+
+  // Public function calls taking longer than this are recorded in
+  // stats()->slow_calls() along with their slowest nested calls. Zero
+  // (the default) disables this. Only timed calls are checked.
+  Nanoseconds slow_call_threshold() const { return slow_call_threshold_; }
+  void set_slow_call_threshold(Nanoseconds threshold) {
+    slow_call_threshold_ = threshold;
+  }
+
+  // Enables splitting the time of timed calls into ticks, which are
+  // ended by EndTick(). See Statistics::ticks().
+  bool tick_stats_enabled() const { return tick_stats_enabled_; }
+  void set_tick_stats_enabled(bool enabled) {
+    tick_stats_enabled_ = enabled;
+  }
+
+  // Enables tracking of timers started by SetTimer() and SetTimerEx(),
+  // see Statistics::GetTimerStatistics(). This needs the callback hook
+  // to see the natives and EndTick() to find fires on the same tick.
+  bool timer_stats_enabled() const { return timer_stats_enabled_; }
+  void set_timer_stats_enabled(bool enabled) {
+    timer_stats_enabled_ = enabled;
+  }
+
+  // Enables detection of native calls that repeat an earlier call with
+  // the same arguments within the same top-level public call, see
+  // Statistics::GetRedundantCallStatistics(). This needs the callback
+  // hook to see the natives.
+  bool redundant_call_stats_enabled() const {
+    return redundant_call_stats_enabled_;
+  }
+  void set_redundant_call_stats_enabled(bool enabled) {
+    redundant_call_stats_enabled_ = enabled;
+  }
+
+  // Enables tracking of the stack and heap space used by each function
+  // and of recursion depth, see Statistics::GetMemoryStatistics(). The
+  // stack and heap are sampled on function entry and exit and on every
+  // line, so usage within a line that calls no functions can be missed.
+  bool memory_stats_enabled() const { return memory_stats_enabled_; }
+  void set_memory_stats_enabled(bool enabled);
+
+  // Sets the publics whose first parameter is a player ID, such as
+  // OnPlayerUpdate. Their calls are also counted per player, see
+  // Statistics::GetPlayerStatistics(). Names of publics that the script
+  // doesn't have are ignored. Returns the number of publics found.
+  int SetPlayerCallbacks(const std::vector<std::string> &names);
+
+  // Returns the ID of the zone with the given name, creating it on first
+  // use. Zones are parts of the code marked by BeginZone() and EndZone()
+  // calls that are profiled as if they were functions.
+  int GetZoneId(const std::string &name);
+
+  // Starts a zone, which then nests in the call stack like a function
+  // call. When called from a native, which is how scripts do it, the
+  // zone starts once the native returns. Returns false if the ID is
+  // invalid.
+  bool BeginZone(int id);
+
+  // Ends the innermost zone. Zones that are still running when the
+  // function that started them returns end with it. Returns false if
+  // there is no zone to end.
+  bool EndZone();
+
+  // Returns the ID of the counter with the given name, creating it on
+  // first use. SetCounter() adds a sample to the counter's statistics,
+  // see Statistics::GetCounterStatistics(). Returns false if the ID is
+  // invalid.
+  int GetCounterId(const std::string &name);
+  bool SetCounter(int id, cell value);
+
+  // If set, calls to natives and public functions are written to the
+  // recorder's log.
+  void set_native_recorder(NativeRecorder *recorder) {
+    native_recorder_ = recorder;
+  }
+
+  // If set, every enter and leave event is written to the recorder,
+  // whether the call is timed or not. The recorder must be open.
+  void set_flight_recorder(FlightRecorder *recorder);
+
  public:
   // This method should be called from within your AMX debug hook (see
   // amx_SetDebugHook). It collects statistics for ordinary functions.
@@ -68,25 +220,113 @@ class Profiler {
                    AMX_CALLBACK callback = 0);
 
   // This method should be called instead of amx_Exec().
-  // It collects statistics for public functions.
-  int ExecHook(cell *retval, int index, AMX_EXEC exec = 0);
+  // It collects statistics for public functions. return_address is the
+  // return address of the amx_Exec() call, if known; the calls are then
+  // also grouped by the module (server or plugin) they came from.
+  int ExecHook(cell *retval,
+               int index,
+               AMX_EXEC exec = 0,
+               const void *return_address = 0);
+
+  // Ends the current tick. This should be called once per server tick,
+  // outside of any script calls, if tick or timer statistics are enabled
+  // or tick_script_time() is used.
+  void EndTick();
+
+  // Self time of the timed calls made since the last EndTick().
+  Nanoseconds tick_script_time() const { return tick_script_time_; }
 
  private:
   Profiler();
 
+  // Registers a newly created function with the statistics.
+  void AddFunction(Function *fn);
+
   // BeginFunction() and EndFunction() are called when entering
-  // a function and returning from it respectively.
-  void EnterFunction(Address address, Address frm);
+  // a function and returning from it respectively. call_site is the
+  // return address of the call or 0 if the caller is not a script.
+  void EnterFunction(Address address, Address frm, Address call_site = 0);
   void LeaveFunction(Address address = 0);
 
+  // EnterLine() is called when the VM reaches a BREAK instruction, the
+  // time since the previous call is charged to the previous line.
+  // LeaveLine() stops timing the current line.
+  void EnterLine(Address address);
+  void LeaveLine();
+
+  // Called for each timed call on leaving it. Remembers calls that took
+  // a significant part of the slow call threshold and records a slow call
+  // if the call is a public that took longer than the threshold.
+  void CheckSlowCall(const FunctionCall &fn_call, Nanoseconds time);
+
+  // Called after a call to SetTimer(), SetTimerEx() or KillTimer()
+  // returned. call_site is the return address of the call.
+  void TrackTimerNative(Function *native,
+                        Address call_site,
+                        const cell *params,
+                        cell result);
+
+  // Runs the BeginZone() or EndZone() that was put off until the native
+  // calling it returned.
+  void RunPendingZoneOp();
+
+  // Called after a native call that repeated an earlier one returned.
+  // time is how long it took, if the call was timed.
+  void AddRedundantCall(Function *native,
+                        Address call_site,
+                        Nanoseconds time);
+
+  // Returns the name of the module containing the given return address.
+  // The results are cached as there are usually only a few call sites.
+  const std::string &GetCallerModule(const void *return_address);
+
+  // Records a call from the script of another profiler to one of this
+  // script's publics in the statistics of both.
+  void AddCrossScriptCall(Profiler *caller, Function *callee,
+                          Nanoseconds time);
+
+  // Samples the current stack pointer and heap top for the call on top
+  // of the stack and the script as a whole.
+  void UpdateMemoryUsage();
+
  private:
   AMX *amx_;
+  std::string name_;
+  Clock *clock_;
   DebugInfo *debug_info_;
   bool call_graph_enabled_;
+  bool line_stats_enabled_;
+  bool call_site_stats_enabled_;
+  bool tick_stats_enabled_;
+  bool timer_stats_enabled_;
+  bool redundant_call_stats_enabled_;
+  bool memory_stats_enabled_;
+  bool timing_;
+  int callback_depth_;
+  Sampler sampler_;
+  Nanoseconds call_overhead_;
+  uint64_t num_events_;
+  NativeRecorder *native_recorder_;
+  FlightRecorder *flight_recorder_;
+  LineStatistics *current_line_;
+  TimePoint current_line_start_;
   CallStack call_stack_;
   CallGraph call_graph_;
   Statistics stats_;
   std::set<Function*> functions_;
+  std::map<const void*, std::string> caller_modules_;
+  std::set<PublicTableIndex> player_callbacks_;
+  Nanoseconds slow_call_threshold_;
+  TimePoint last_tick_end_;
+  Nanoseconds tick_script_time_;
+  TimerTracker timer_tracker_;
+  RedundantCallDetector redundant_call_detector_;
+  std::vector<Function*> zones_;
+  std::map<std::string, int> zone_ids_;
+  std::map<std::string, int> counter_ids_;
+  Function *pending_zone_begin_;
+  bool pending_zone_end_;
+  std::vector<SlowCallFrame> slow_frames_;
 
  private:
   AMXPROF_DISALLOW_COPY_AND_ASSIGN(Profiler);
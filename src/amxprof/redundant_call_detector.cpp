@@ -0,0 +1,108 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "redundant_call_detector.h"
+
+namespace amxprof {
+
+namespace {
+
+const std::size_t kInitialCapacity = 64;
+
+} // anonymous namespace
+
+RedundantCallDetector::RedundantCallDetector()
+ : slots_(kInitialCapacity),
+   size_(0),
+   generation_(1)
+{
+  // Slots from an older generation are free, so generation 0 marks the
+  // ones that were never used.
+  for (std::size_t i = 0; i < slots_.size(); i++) {
+    slots_[i].generation = 0;
+  }
+}
+
+void RedundantCallDetector::Reset() {
+  size_ = 0;
+  if (++generation_ == 0) {
+    for (std::size_t i = 0; i < slots_.size(); i++) {
+      slots_[i].generation = 0;
+    }
+    generation_ = 1;
+  }
+}
+
+bool RedundantCallDetector::CheckCall(Address native, const cell *params) {
+  if ((size_ + 1) * 2 > slots_.size()) {
+    Grow();
+  }
+  uint64_t key = Hash(native, params);
+  std::size_t mask = slots_.size() - 1;
+  std::size_t i = static_cast<std::size_t>(key ^ (key >> 32)) & mask;
+  while (slots_[i].generation == generation_) {
+    if (slots_[i].key == key) {
+      return true;
+    }
+    i = (i + 1) & mask;
+  }
+  slots_[i].key = key;
+  slots_[i].generation = generation_;
+  size_++;
+  return false;
+}
+
+uint64_t RedundantCallDetector::Hash(Address native, const cell *params) {
+  // FNV-1a over the address and the arguments, one cell at a time.
+  uint64_t h = 14695981039346656037ULL;
+  h = (h ^ static_cast<uint64_t>(native)) * 1099511628211ULL;
+  std::size_t num_params = params[0] / sizeof(cell);
+  for (std::size_t i = 1; i <= num_params; i++) {
+    h = (h ^ static_cast<uint64_t>(static_cast<ucell>(params[i])))
+        * 1099511628211ULL;
+  }
+  return h;
+}
+
+void RedundantCallDetector::Grow() {
+  std::vector<Slot> old_slots(slots_.size() * 2);
+  old_slots.swap(slots_);
+  for (std::size_t i = 0; i < slots_.size(); i++) {
+    slots_[i].generation = 0;
+  }
+  std::size_t mask = slots_.size() - 1;
+  for (std::size_t i = 0; i < old_slots.size(); i++) {
+    if (old_slots[i].generation != generation_) {
+      continue;
+    }
+    uint64_t key = old_slots[i].key;
+    std::size_t j = static_cast<std::size_t>(key ^ (key >> 32)) & mask;
+    while (slots_[j].generation == generation_) {
+      j = (j + 1) & mask;
+    }
+    slots_[j] = old_slots[i];
+  }
+}
+
+} // namespace amxprof
@@ -0,0 +1,75 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_REDUNDANT_CALL_DETECTOR_H
+#define AMXPROF_REDUNDANT_CALL_DETECTOR_H
+
+#include <cstddef>
+#include <vector>
+#include "amx_types.h"
+#include "macros.h"
+#include "stdint.h"
+
+namespace amxprof {
+
+// Remembers the natives called since the last Reset() together with
+// their arguments, e.g. within a single top-level public call, to find
+// calls that repeat an earlier one. Calls are identified by a 64-bit
+// hash of the native's address and its argument cells, so arguments
+// passed by reference (arrays and strings) compare equal if they are at
+// the same address, whatever they contain.
+class RedundantCallDetector {
+ public:
+  RedundantCallDetector();
+
+  // Forgets all calls seen so far. This takes constant time.
+  void Reset();
+
+  // Returns true if the native was already called with the same
+  // arguments since the last Reset(), otherwise remembers the call and
+  // returns false. params are the native's parameters, params[0] being
+  // their size in bytes.
+  bool CheckCall(Address native, const cell *params);
+
+ private:
+  struct Slot {
+    uint64_t key;
+    uint32_t generation;
+  };
+
+  static uint64_t Hash(Address native, const cell *params);
+  void Grow();
+
+ private:
+  std::vector<Slot> slots_;
+  std::size_t size_;
+  uint32_t generation_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(RedundantCallDetector);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_REDUNDANT_CALL_DETECTOR_H
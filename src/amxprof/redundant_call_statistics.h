@@ -0,0 +1,87 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_REDUNDANT_CALL_STATISTICS_H
+#define AMXPROF_REDUNDANT_CALL_STATISTICS_H
+
+#include <string>
+#include "amx_types.h"
+#include "duration.h"
+
+namespace amxprof {
+
+class Function;
+
+// Calls to a native from a single place in the code that repeated an
+// earlier call with the same arguments within the same public call, see
+// RedundantCallDetector.
+class RedundantCallStatistics {
+ public:
+  RedundantCallStatistics(Function *native,
+                          Address call_site,
+                          const std::string &file,
+                          long line);
+
+  Function *native() const { return native_; }
+
+  // The return address of the repeated call and its location as found
+  // in the debug info.
+  Address call_site() const { return call_site_; }
+  const std::string &file() const { return file_; }
+  long line() const { return line_; }
+
+  // Returns "file:line", or the address in hex if the location is unknown.
+  std::string GetLocationString() const;
+
+  long num_calls() const { return num_calls_; }
+  void AdjustNumCalls(long delta) { num_calls_ += delta; }
+
+  // Number of calls that were timed, see FunctionStatistics.
+  long num_timed_calls() const { return num_timed_calls_; }
+  void AdjustNumTimedCalls(long delta) { num_timed_calls_ += delta; }
+
+  // Time spent in the repeated calls, i.e. the time that could be saved
+  // by reusing the earlier result. Extrapolated to all calls if only some
+  // of them were timed.
+  Nanoseconds time() const {
+    if (num_timed_calls_ == 0 || num_timed_calls_ == num_calls_) {
+      return time_;
+    }
+    return time_.count() * num_calls_ / num_timed_calls_;
+  }
+  void AdjustTime(Nanoseconds delta) { time_ += delta; }
+
+ private:
+  Function *native_;
+  Address call_site_;
+  std::string file_;
+  long line_;
+  long num_calls_;
+  long num_timed_calls_;
+  Nanoseconds time_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_REDUNDANT_CALL_STATISTICS_H
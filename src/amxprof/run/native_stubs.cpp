@@ -0,0 +1,109 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "native_stubs.h"
+
+namespace amxprof {
+namespace run {
+
+namespace {
+
+// Never actually called because NativeStubs::Call() handles stubs before
+// amx_Callback() gets to them, it only has to exist for amx_Register().
+cell AMX_NATIVE_CALL StubNative(AMX *amx, cell *params) {
+  (void)amx;
+  (void)params;
+  return 0;
+}
+
+} // anonymous namespace
+
+void NativeStubs::SetResult(const std::string &name, cell result) {
+  named_results_[name] = result;
+}
+
+int NativeStubs::Register(AMX *amx) {
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(amx->base);
+  AMX_FUNCSTUBNT *natives =
+    reinterpret_cast<AMX_FUNCSTUBNT*>(amx->base + hdr->natives);
+
+  int num_natives = 0;
+  amx_NumNatives(amx, &num_natives);
+
+  int name_length = 0;
+  amx_NameLength(amx, &name_length);
+
+  std::vector<char> name(name_length + 1);
+  std::vector<std::string> names;
+
+  is_stub_.assign(num_natives, false);
+  results_.assign(num_natives, 0);
+
+  for (int i = 0; i < num_natives; i++) {
+    if (natives[i].address != 0) {
+      continue;
+    }
+    amx_GetNative(amx, i, &name[0]);
+    names.push_back(&name[0]);
+    is_stub_[i] = true;
+
+    std::map<std::string, cell>::const_iterator iterator =
+      named_results_.find(names.back());
+    if (iterator != named_results_.end()) {
+      results_[i] = iterator->second;
+    }
+  }
+
+  if (names.empty()) {
+    return AMX_ERR_NONE;
+  }
+
+  std::vector<AMX_NATIVE_INFO> native_info(names.size());
+  for (std::size_t i = 0; i < names.size(); i++) {
+    native_info[i].name = names[i].c_str();
+    native_info[i].func = StubNative;
+  }
+  return amx_Register(amx, &native_info[0], static_cast<int>(names.size()));
+}
+
+int NativeStubs::num_stubs() const {
+  int count = 0;
+  for (std::size_t i = 0; i < is_stub_.size(); i++) {
+    if (is_stub_[i]) {
+      count++;
+    }
+  }
+  return count;
+}
+
+int NativeStubs::Call(AMX *amx, cell index, cell *result, cell *params) {
+  if (IsStub(index)) {
+    *result = results_[index];
+    return AMX_ERR_NONE;
+  }
+  return amx_Callback(amx, index, result, params);
+}
+
+} // namespace run
+} // namespace amxprof
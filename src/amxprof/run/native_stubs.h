@@ -0,0 +1,68 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_RUN_NATIVE_STUBS_H
+#define AMXPROF_RUN_NATIVE_STUBS_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <amx/amx.h>
+
+namespace amxprof {
+namespace run {
+
+// Stands in for the natives that are not available outside the server.
+// A stub does nothing but return a constant (0 unless configured).
+class NativeStubs {
+ public:
+  // Sets the value returned by the named native.
+  void SetResult(const std::string &name, cell result);
+
+  // Registers a stub for each native that has no implementation yet.
+  // Natives registered earlier (e.g. by amx_CoreInit) are left alone.
+  int Register(AMX *amx);
+
+  bool IsStub(cell index) const {
+    return index >= 0
+        && index < static_cast<cell>(is_stub_.size())
+        && is_stub_[index];
+  }
+
+  int num_stubs() const;
+
+  // Calls the native: stubs return their value, everything else is
+  // passed to amx_Callback().
+  int Call(AMX *amx, cell index, cell *result, cell *params);
+
+ private:
+  std::map<std::string, cell> named_results_;
+  std::vector<bool> is_stub_;
+  std::vector<cell> results_;
+};
+
+} // namespace run
+} // namespace amxprof
+
+#endif // !AMXPROF_RUN_NATIVE_STUBS_H
@@ -0,0 +1,499 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// amxprof-run loads an .amx file into a Pawn VM, runs some of its public
+// functions under the profiler and writes the same reports as the plugin.
+// Natives that the VM doesn't provide are replaced with stubs.
+//
+// Usage: amxprof-run [options] <script.amx> [public[:arg,...]] ...
+//
+// If no publics are given main() is run. Options:
+//
+//   --level=publics|natives|functions|lines   (default: functions)
+//   --format=html|txt|json|gprof              (default: txt)
+//   --output=<file>          (default: <script>-profile.<format>)
+//   --call-graph=<file>      write a call graph in DOT format
+//   --native=<name>=<value>  make the stub of a native return a value
+//   --iterations=<n>         run the publics n times (default: 1)
+//   --clock=system|tsc       (default: system)
+//   --no-compensate          don't subtract the profiler's overhead
+//   --cpu-time               also measure CPU time (off-CPU column)
+//   --perf-counters          count cycles, instructions, etc (Linux only)
+//   --record=<file>          record native calls (see NativeRecorder)
+//   --replay=<file>          re-run the calls recorded in a log instead of
+//                            the given publics
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <amx/amx.h>
+#include <amx/amxaux.h>
+#include <amxprof/call_graph_writer_dot.h>
+#include <amxprof/clock.h>
+#include <amxprof/debug_info.h>
+#include <amxprof/native_recorder.h>
+#include <amxprof/native_replayer.h>
+#include <amxprof/perf_counters.h>
+#include <amxprof/profiler.h>
+#include <amxprof/statistics_writer_gprof.h>
+#include <amxprof/statistics_writer_html.h>
+#include <amxprof/statistics_writer_json.h>
+#include <amxprof/statistics_writer_text.h>
+#include "native_stubs.h"
+
+// Core natives (numargs, getarg, strlen, etc), see src/amx/amxcore.c.
+extern "C" int AMXAPI amx_CoreInit(AMX *amx);
+
+using namespace amxprof;
+using amxprof::run::NativeStubs;
+
+namespace {
+
+enum Level {
+  LEVEL_PUBLICS,
+  LEVEL_NATIVES,
+  LEVEL_FUNCTIONS,
+  LEVEL_LINES
+};
+
+struct Entry {
+  std::string name;
+  std::vector<cell> args;
+};
+
+struct Options {
+  Options()
+   : level(LEVEL_FUNCTIONS),
+     level_name("functions"),
+     format("txt"),
+     call_graph_threshold(0),
+     iterations(1),
+     clock("system"),
+     compensate(true),
+     cpu_time(false),
+     perf_counters(false)
+  {}
+
+  Level level;
+  std::string level_name;
+  std::string format;
+  std::string output;
+  std::string call_graph;
+  double call_graph_threshold;
+  std::vector<std::pair<std::string, cell> > natives;
+  int iterations;
+  std::string clock;
+  bool compensate;
+  bool cpu_time;
+  bool perf_counters;
+  std::string record;
+  std::string replay;
+  std::string script;
+  std::vector<Entry> entries;
+};
+
+Profiler *profiler = 0;
+NativeStubs *native_stubs = 0;
+NativeReplayer *native_replayer = 0;
+
+int AMXAPI NativeCallback(AMX *amx, cell index, cell *result, cell *params) {
+  if (native_replayer != 0) {
+    return native_replayer->Call(amx, index, result, params);
+  }
+  return native_stubs->Call(amx, index, result, params);
+}
+
+int AMXAPI ProfiledExec(AMX *amx, cell *retval, int index) {
+  (void)amx;
+  return profiler->ExecHook(retval, index, amx_Exec);
+}
+
+int AMXAPI DebugHook(AMX *amx) {
+  (void)amx;
+  return profiler->DebugHook();
+}
+
+int AMXAPI CallbackHook(AMX *amx, cell index, cell *result, cell *params) {
+  (void)amx;
+  return profiler->CallbackHook(index, result, params, NativeCallback);
+}
+
+bool ParseOption(const char *arg, const char *name, std::string *value) {
+  std::size_t length = std::strlen(name);
+  if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') {
+    return false;
+  }
+  *value = arg + length + 1;
+  return true;
+}
+
+bool ParseLevel(const std::string &name, Level *level) {
+  static const struct {
+    const char *name;
+    Level level;
+  } levels[] = {
+    {"publics",   LEVEL_PUBLICS},
+    {"natives",   LEVEL_NATIVES},
+    {"functions", LEVEL_FUNCTIONS},
+    {"lines",     LEVEL_LINES}
+  };
+  for (std::size_t i = 0; i < sizeof(levels) / sizeof(*levels); i++) {
+    if (name == levels[i].name) {
+      *level = levels[i].level;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses "name" or "name:arg,arg,...".
+Entry ParseEntry(const std::string &text) {
+  Entry entry;
+  std::string::size_type colon = text.find(':');
+  entry.name = text.substr(0, colon);
+  if (colon != std::string::npos && colon + 1 < text.length()) {
+    std::string::size_type start = colon + 1;
+    while (start <= text.length()) {
+      std::string::size_type comma = text.find(',', start);
+      if (comma == std::string::npos) {
+        comma = text.length();
+      }
+      entry.args.push_back(std::atoi(text.substr(start, comma - start).c_str()));
+      start = comma + 1;
+    }
+  }
+  return entry;
+}
+
+bool ParseOptions(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    std::string value;
+    if (std::strncmp(arg, "--", 2) != 0) {
+      if (options->script.empty()) {
+        options->script = arg;
+      } else {
+        options->entries.push_back(ParseEntry(arg));
+      }
+    } else if (ParseOption(arg, "--level", &value)) {
+      if (!ParseLevel(value, &options->level)) {
+        std::fprintf(stderr, "Unknown level: %s\n", value.c_str());
+        return false;
+      }
+      options->level_name = value;
+    } else if (ParseOption(arg, "--format", &value)) {
+      options->format = value;
+    } else if (ParseOption(arg, "--output", &value)) {
+      options->output = value;
+    } else if (ParseOption(arg, "--call-graph", &value)) {
+      options->call_graph = value;
+    } else if (ParseOption(arg, "--call-graph-threshold", &value)) {
+      options->call_graph_threshold = std::atof(value.c_str()) / 100;
+    } else if (ParseOption(arg, "--native", &value)) {
+      std::string::size_type equals = value.find('=');
+      if (equals == std::string::npos) {
+        std::fprintf(stderr, "Expected --native=<name>=<value>\n");
+        return false;
+      }
+      options->natives.push_back(std::make_pair(
+        value.substr(0, equals),
+        static_cast<cell>(std::atoi(value.substr(equals + 1).c_str()))));
+    } else if (ParseOption(arg, "--iterations", &value)) {
+      options->iterations = std::atoi(value.c_str());
+    } else if (ParseOption(arg, "--clock", &value)) {
+      options->clock = value;
+    } else if (ParseOption(arg, "--record", &value)) {
+      options->record = value;
+    } else if (ParseOption(arg, "--replay", &value)) {
+      options->replay = value;
+    } else if (std::strcmp(arg, "--no-compensate") == 0) {
+      options->compensate = false;
+    } else if (std::strcmp(arg, "--cpu-time") == 0) {
+      options->cpu_time = true;
+    } else if (std::strcmp(arg, "--perf-counters") == 0) {
+      options->perf_counters = true;
+    } else {
+      std::fprintf(stderr, "Unknown option: %s\n", arg);
+      return false;
+    }
+  }
+  if (options->script.empty()) {
+    std::fprintf(stderr,
+      "Usage: amxprof-run [options] <script.amx> [public[:arg,...]] ...\n");
+    return false;
+  }
+  if (options->iterations < 1
+      || (options->clock != "system" && options->clock != "tsc")) {
+    std::fprintf(stderr, "Invalid option value\n");
+    return false;
+  }
+  if (!options->record.empty() && options->level < LEVEL_NATIVES) {
+    std::fprintf(stderr, "Recording natives requires level natives or higher\n");
+    return false;
+  }
+  if (options->entries.empty()) {
+    Entry main_entry;
+    main_entry.name = "main";
+    options->entries.push_back(main_entry);
+  }
+  if (options->output.empty()) {
+    std::string base = options->script;
+    std::string::size_type dot = base.rfind(".amx");
+    if (dot != std::string::npos && dot + 4 == base.length()) {
+      base.erase(dot);
+    }
+    options->output = base + "-profile." + options->format;
+  }
+  return true;
+}
+
+bool Execute(AMX *amx, const Entry &entry) {
+  int index = AMX_EXEC_MAIN;
+  if (entry.name != "main") {
+    if (amx_FindPublic(amx, entry.name.c_str(), &index) != AMX_ERR_NONE) {
+      std::fprintf(stderr, "Public function not found: %s\n",
+                   entry.name.c_str());
+      return false;
+    }
+  }
+
+  // Arguments are pushed in reverse order.
+  for (std::size_t i = entry.args.size(); i > 0; i--) {
+    amx_Push(amx, entry.args[i - 1]);
+  }
+
+  cell retval;
+  int error = profiler->ExecHook(&retval, index, amx_Exec);
+  if (error != AMX_ERR_NONE) {
+    std::fprintf(stderr, "Run time error %d in %s: %s\n",
+                 error, entry.name.c_str(), aux_StrError(error));
+    return false;
+  }
+  return true;
+}
+
+bool Replay(AMX *amx) {
+  int index;
+  long num_calls = 0;
+  while (native_replayer->NextExec(amx, index)) {
+    cell retval;
+    int error = profiler->ExecHook(&retval, index, amx_Exec);
+    if (error != AMX_ERR_NONE) {
+      std::fprintf(stderr, "Run time error %d: %s\n",
+                   error, aux_StrError(error));
+      break;
+    }
+    num_calls++;
+  }
+  std::printf("Replayed %ld calls (%ld native calls with different "
+              "arguments)\n", num_calls, native_replayer->num_mismatches());
+  if (!native_replayer->error().empty()) {
+    std::fprintf(stderr, "Replay failed: %s\n",
+                 native_replayer->error().c_str());
+    return false;
+  }
+  return true;
+}
+
+bool WriteProfile(const Options &options, const Profiler &profiler) {
+  StatisticsWriter *writer = 0;
+  if (options.format == "html") {
+    writer = new StatisticsWriterHtml;
+  } else if (options.format == "txt" || options.format == "text") {
+    writer = new StatisticsWriterText;
+  } else if (options.format == "json") {
+    writer = new StatisticsWriterJson;
+  } else if (options.format == "gprof") {
+    StatisticsWriterGprof *gprof_writer = new StatisticsWriterGprof;
+    gprof_writer->set_call_graph(profiler.call_graph());
+    writer = gprof_writer;
+  } else {
+    std::fprintf(stderr, "Unsupported output format: %s\n",
+                 options.format.c_str());
+    return false;
+  }
+
+  std::ofstream stream(options.output.c_str());
+  if (!stream.is_open()) {
+    std::fprintf(stderr, "Error opening %s for writing\n",
+                 options.output.c_str());
+    delete writer;
+    return false;
+  }
+
+  std::printf("Writing profile to %s\n", options.output.c_str());
+  writer->set_stream(&stream);
+  writer->set_script_name(options.script);
+  writer->set_print_date(true);
+  writer->set_print_run_time(true);
+  writer->AddMetadata("Level", options.level_name);
+  writer->AddMetadata("Clock", options.clock);
+  writer->Write(profiler.stats());
+  delete writer;
+  return true;
+}
+
+bool WriteCallGraph(const Options &options, const Profiler &profiler) {
+  std::ofstream stream(options.call_graph.c_str());
+  if (!stream.is_open()) {
+    std::fprintf(stderr, "Error opening %s for writing\n",
+                 options.call_graph.c_str());
+    return false;
+  }
+
+  std::printf("Writing call graph to %s\n", options.call_graph.c_str());
+  CallGraphWriterDot writer;
+  writer.set_stream(&stream);
+  writer.set_script_name(options.script);
+  writer.set_root_node_name("amxprof-run");
+  writer.set_edge_threshold(options.call_graph_threshold);
+  writer.Write(profiler.call_graph());
+  return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    return EXIT_FAILURE;
+  }
+
+  AMX amx;
+  int error = aux_LoadProgram(&amx, options.script.c_str(), 0);
+  if (error != AMX_ERR_NONE) {
+    std::fprintf(stderr, "Could not load %s: %s\n",
+                 options.script.c_str(), aux_StrError(error));
+    return EXIT_FAILURE;
+  }
+
+  amx_CoreInit(&amx);
+
+  NativeStubs stubs;
+  for (std::size_t i = 0; i < options.natives.size(); i++) {
+    stubs.SetResult(options.natives[i].first, options.natives[i].second);
+  }
+  stubs.Register(&amx);
+  native_stubs = &stubs;
+
+  DebugInfo debug_info;
+  if (HasDebugInfo(&amx) && !debug_info.Load(options.script)) {
+    std::fprintf(stderr, "Could not load debug info: %s\n",
+                 aux_StrError(debug_info.last_error()));
+  }
+
+  SystemClock system_clock;
+  TscClock *tsc_clock = 0;
+  Clock *clock = &system_clock;
+  if (options.clock == "tsc") {
+    clock = tsc_clock = new TscClock;
+  }
+
+  // The gprof format is made from the call graph.
+  Profiler script_profiler(&amx,
+                           !options.call_graph.empty()
+                           || options.format == "gprof",
+                           clock);
+  if (debug_info.is_loaded()) {
+    script_profiler.set_debug_info(&debug_info);
+  }
+  script_profiler.set_line_stats_enabled(options.level >= LEVEL_LINES);
+  if (options.cpu_time) {
+    script_profiler.set_cpu_clock(ThreadCpuClock::GetInstance());
+  }
+  PerfCounters perf_counters;
+  if (options.perf_counters) {
+    if (perf_counters.Open()) {
+      script_profiler.set_perf_counters(&perf_counters);
+    } else {
+      std::fprintf(stderr, "Could not open performance counters\n");
+    }
+  }
+  script_profiler.Calibrate(options.compensate);
+  profiler = &script_profiler;
+
+  // Stubs must be called even if natives aren't profiled.
+  amx.sysreq_d = 0;
+  if (options.level >= LEVEL_NATIVES) {
+    amx_SetCallback(&amx, CallbackHook);
+  } else {
+    amx_SetCallback(&amx, NativeCallback);
+  }
+  if (options.level >= LEVEL_FUNCTIONS) {
+    amx_SetDebugHook(&amx, DebugHook);
+  }
+
+  std::printf("Loaded %s (%d natives stubbed)\n",
+              options.script.c_str(), stubs.num_stubs());
+
+  NativeRecorder recorder;
+  if (!options.record.empty()) {
+    if (!recorder.Open(options.record, &amx)) {
+      std::fprintf(stderr, "Error opening %s for writing\n",
+                   options.record.c_str());
+      return EXIT_FAILURE;
+    }
+    script_profiler.set_native_recorder(&recorder);
+  }
+
+  bool ok = true;
+  if (!options.replay.empty()) {
+    NativeReplayer replayer;
+    replayer.set_exec(ProfiledExec);
+    native_replayer = &replayer;
+    if (replayer.Open(options.replay, &amx)) {
+      ok = Replay(&amx);
+    } else {
+      std::fprintf(stderr, "Could not open %s: %s\n",
+                   options.replay.c_str(), replayer.error().c_str());
+      ok = false;
+    }
+    native_replayer = 0;
+  } else {
+    for (int i = 0; i < options.iterations && ok; i++) {
+      for (std::size_t j = 0; j < options.entries.size() && ok; j++) {
+        ok = Execute(&amx, options.entries[j]);
+      }
+    }
+  }
+  recorder.Close();
+
+  if (!WriteProfile(options, script_profiler)) {
+    ok = false;
+  }
+  if (!options.call_graph.empty()
+      && !WriteCallGraph(options, script_profiler)) {
+    ok = false;
+  }
+
+  profiler = 0;
+  aux_FreeProgram(&amx);
+  delete tsc_clock;
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
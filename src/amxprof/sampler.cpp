@@ -0,0 +1,98 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "sampler.h"
+
+namespace amxprof {
+
+namespace {
+
+// Length of the time window (in script time) over which the overhead
+// is measured before adjusting the rate.
+const Milliseconds kWindowLength = 100;
+
+} // anonymous namespace
+
+Sampler::Sampler()
+ : rate_(1),
+   max_overhead_(0),
+   overhead_(0),
+   random_state_(2463534242u),
+   num_events_(0)
+{
+}
+
+void Sampler::set_rate(int rate) {
+  if (rate < 1) {
+    rate = 1;
+  }
+  if (rate > kMaxRate) {
+    rate = kMaxRate;
+  }
+  rate_ = rate;
+}
+
+bool Sampler::SampleNextCall() {
+  if (rate_ <= 1) {
+    return true;
+  }
+  // Pick calls at random rather than every N-th call so that callbacks
+  // that are always called in the same order don't get skipped entirely.
+  random_state_ ^= random_state_ << 13;
+  random_state_ ^= random_state_ >> 17;
+  random_state_ ^= random_state_ << 5;
+  return random_state_ % static_cast<uint32_t>(rate_) == 0;
+}
+
+void Sampler::AddScriptTime(Nanoseconds time) {
+  if (!is_adaptive()) {
+    return;
+  }
+  script_time_ += time;
+  if (script_time_ > kWindowLength) {
+    AdjustRate();
+  }
+}
+
+void Sampler::AdjustRate() {
+  Nanoseconds overhead_time = event_cost_.count() * kEventMeasureInterval;
+  Nanoseconds run_time = script_time_ - overhead_time;
+
+  if (run_time.count() > 0) {
+    overhead_ = overhead_time.count() / run_time.count();
+  } else {
+    overhead_ = 1.0;
+  }
+
+  if (overhead_ > max_overhead_) {
+    set_rate(rate_ * 2);
+  } else if (overhead_ < max_overhead_ / 2) {
+    set_rate(rate_ / 2);
+  }
+
+  event_cost_ = 0;
+  script_time_ = 0;
+}
+
+} // namespace amxprof
@@ -0,0 +1,89 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_SAMPLER_H
+#define AMXPROF_SAMPLER_H
+
+#include "duration.h"
+#include "stdint.h"
+
+namespace amxprof {
+
+// Decides which top-level public function calls are fully timed. Only
+// one in rate() calls is timed, other calls are merely counted.
+//
+// If max_overhead() is set the sampler also keeps track of how much time
+// the profiler spends in its own code and adjusts the rate so that this
+// time stays below the specified fraction of the script's run time.
+class Sampler {
+ public:
+  Sampler();
+
+  int rate() const { return rate_; }
+  void set_rate(int rate);
+
+  // Maximum profiler overhead as a fraction of script run time, e.g. 0.02
+  // for 2%. Zero disables rate adjustment.
+  double max_overhead() const { return max_overhead_; }
+  void set_max_overhead(double max_overhead) { max_overhead_ = max_overhead; }
+
+  bool is_adaptive() const { return max_overhead_ > 0; }
+
+  // Estimated overhead over the last completed measurement window.
+  double overhead() const { return overhead_; }
+
+  // Returns true if the next top-level call should be timed.
+  bool SampleNextCall();
+
+  // Returns true if the cost of the current enter/leave event should be
+  // measured and reported through AddEventCost(). Only a fraction of
+  // events is measured and the results are extrapolated to the rest.
+  bool ShouldMeasureEvent() {
+    return is_adaptive() && (++num_events_ % kEventMeasureInterval) == 0;
+  }
+  void AddEventCost(Nanoseconds cost) { event_cost_ += cost; }
+
+  // Called after each top-level call with the time it took (including
+  // the profiler's overhead).
+  void AddScriptTime(Nanoseconds time);
+
+ private:
+  static const uint32_t kEventMeasureInterval = 16;
+  static const int kMaxRate = 1 << 16;
+
+  void AdjustRate();
+
+ private:
+  int rate_;
+  double max_overhead_;
+  double overhead_;
+  uint32_t random_state_;
+  uint32_t num_events_;
+  Nanoseconds event_cost_;
+  Nanoseconds script_time_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_SAMPLER_H
@@ -0,0 +1,61 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include "slow_call_log.h"
+
+namespace amxprof {
+
+namespace {
+
+bool CompareFramesByTime(const SlowCallFrame &lhs, const SlowCallFrame &rhs) {
+  return rhs.time() < lhs.time();
+}
+
+} // anonymous namespace
+
+SlowCall::SlowCall(const SlowCallFrame &call,
+                   const std::vector<SlowCallFrame> &frames)
+ : call_(call),
+   frames_(frames)
+{
+  std::stable_sort(frames_.begin(), frames_.end(), CompareFramesByTime);
+}
+
+void SlowCallLog::Add(const SlowCall &call) {
+  num_calls_++;
+  calls_.push_back(call);
+  while (calls_.size() > max_size_) {
+    calls_.pop_front();
+  }
+}
+
+void SlowCallLog::set_max_size(std::size_t max_size) {
+  max_size_ = max_size;
+  while (calls_.size() > max_size_) {
+    calls_.pop_front();
+  }
+}
+
+} // namespace amxprof
@@ -0,0 +1,119 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_SLOW_CALL_LOG_H
+#define AMXPROF_SLOW_CALL_LOG_H
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+#include "duration.h"
+#include "time_utils.h"
+
+namespace amxprof {
+
+// A function call made during a slow call, see SlowCall.
+class SlowCallFrame {
+ public:
+  SlowCallFrame(const std::string &stack, int depth, Nanoseconds time)
+   : stack_(stack),
+     depth_(depth),
+     time_(time)
+  {}
+
+  // Call stack of the frame, as in "OnPlayerCommandText > cmd_foo".
+  const std::string &stack() const { return stack_; }
+
+  // Number of calls below this one on the stack.
+  int depth() const { return depth_; }
+
+  // Total time of the call.
+  Nanoseconds time() const { return time_; }
+
+ private:
+  std::string stack_;
+  int depth_;
+  Nanoseconds time_;
+};
+
+// A call to a public function that took longer than the profiler's slow
+// call threshold, along with the slowest calls made from it.
+class SlowCall {
+ public:
+  SlowCall(const SlowCallFrame &call,
+           const std::vector<SlowCallFrame> &frames);
+
+  // When the call ended.
+  TimeStamp time_stamp() const { return time_stamp_; }
+
+  // Call stack of the public and its total time.
+  const std::string &stack() const { return call_.stack(); }
+  Nanoseconds time() const { return call_.time(); }
+
+  // Calls made from the public that took a significant part of its time,
+  // slowest first.
+  const std::vector<SlowCallFrame> &frames() const { return frames_; }
+
+ private:
+  TimeStamp time_stamp_;
+  SlowCallFrame call_;
+  std::vector<SlowCallFrame> frames_;
+};
+
+// Keeps the most recent slow calls. Older calls are dropped once there
+// are more than max_size of them.
+class SlowCallLog {
+ public:
+  typedef std::deque<SlowCall>::const_iterator const_iterator;
+
+  explicit SlowCallLog(std::size_t max_size = 100)
+   : max_size_(max_size),
+     num_calls_(0)
+  {}
+
+  void Add(const SlowCall &call);
+
+  std::size_t max_size() const { return max_size_; }
+  void set_max_size(std::size_t max_size);
+
+  // Total number of slow calls, including the dropped ones.
+  long num_calls() const { return num_calls_; }
+
+  bool is_empty() const { return calls_.empty(); }
+  const SlowCall &latest() const { return calls_.back(); }
+
+  // Iterate over the kept calls from oldest to newest.
+  const_iterator begin() const { return calls_.begin(); }
+  const_iterator end() const { return calls_.end(); }
+
+ private:
+  std::size_t max_size_;
+  long num_calls_;
+  std::deque<SlowCall> calls_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_SLOW_CALL_LOG_H
@@ -22,13 +22,116 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include "call_site_statistics.h"
+#include "counter_statistics.h"
+#include "cross_script_call_statistics.h"
+#include "file_statistics.h"
 #include "function.h"
 #include "function_statistics.h"
+#include "line_statistics.h"
+#include "public_caller_statistics.h"
+#include "redundant_call_statistics.h"
 #include "statistics.h"
+#include "timer_statistics.h"
 
 namespace amxprof {
 
-Statistics::Statistics() {
+namespace {
+
+bool CompareCallSites(const CallSiteStatistics *lhs,
+                      const CallSiteStatistics *rhs) {
+  if (lhs->function()->address() != rhs->function()->address()) {
+    return lhs->function()->address() < rhs->function()->address();
+  }
+  return lhs->address() < rhs->address();
+}
+
+bool CompareCrossScriptCallsByTime(const CrossScriptCallStatistics *lhs,
+                                   const CrossScriptCallStatistics *rhs) {
+  return rhs->time() < lhs->time();
+}
+
+bool ComparePublicCallersByTime(const PublicCallerStatistics *lhs,
+                                const PublicCallerStatistics *rhs) {
+  return rhs->time() < lhs->time();
+}
+
+bool CompareTimersByTime(const TimerStatistics *lhs,
+                         const TimerStatistics *rhs) {
+  return rhs->time() < lhs->time();
+}
+
+bool CompareRedundantCallsByTime(const RedundantCallStatistics *lhs,
+                                 const RedundantCallStatistics *rhs) {
+  if (lhs->time() != rhs->time()) {
+    return rhs->time() < lhs->time();
+  }
+  return rhs->num_calls() < lhs->num_calls();
+}
+
+bool ComparePlayersByTotalTime(const PlayerStatistics *lhs,
+                               const PlayerStatistics *rhs) {
+  return rhs->total_time() < lhs->total_time();
+}
+
+bool CompareFunctionsByStackUsage(const FunctionStatistics *lhs,
+                                  const FunctionStatistics *rhs) {
+  if (lhs->max_stack_usage() != rhs->max_stack_usage()) {
+    return rhs->max_stack_usage() < lhs->max_stack_usage();
+  }
+  return rhs->max_heap_usage() < lhs->max_heap_usage();
+}
+
+bool CompareFilesByTotalTime(const FileStatistics *lhs,
+                             const FileStatistics *rhs) {
+  return rhs->total_time() < lhs->total_time();
+}
+
+// Returns the directory part of a path, which may use either kind of
+// slashes depending on where the script was compiled.
+std::string GetDirectory(const std::string &path) {
+  std::string::size_type slash = path.find_last_of("/\\");
+  if (slash == std::string::npos) {
+    return ".";
+  }
+  return path.substr(0, slash);
+}
+
+FileStatistics *GetOrAddFile(Statistics::NameToFileStatsMap &files,
+                             const std::string &name) {
+  Statistics::NameToFileStatsMap::const_iterator iterator = files.find(name);
+  if (iterator != files.end()) {
+    return iterator->second;
+  }
+  FileStatistics *file_stats = new FileStatistics(name);
+  files.insert(std::make_pair(name, file_stats));
+  return file_stats;
+}
+
+void GetSortedFiles(const Statistics::NameToFileStatsMap &files,
+                    std::vector<FileStatistics*> &stats) {
+  std::vector<FileStatistics*>::size_type first = stats.size();
+  for (Statistics::NameToFileStatsMap::const_iterator iterator = files.begin();
+       iterator != files.end(); ++iterator) {
+    stats.push_back(iterator->second);
+  }
+  std::stable_sort(stats.begin() + first, stats.end(),
+                   CompareFilesByTotalTime);
+}
+
+} // anonymous namespace
+
+Statistics::Statistics(Clock *clock)
+ : cpu_time_measured_(false),
+   memory_measured_(false),
+   stack_heap_size_(0),
+   max_stack_usage_(0),
+   max_heap_usage_(0),
+   max_stack_heap_usage_(0),
+   perf_counters_(0)
+{
+  run_time_counter_.set_clock(clock);
   run_time_counter_.Start();
 }
 
@@ -38,6 +141,62 @@ Statistics::~Statistics() {
   {
     delete iterator->second;
   }
+  for (AddressToLineStatsMap::const_iterator iterator = address_to_line_stats_.begin();
+       iterator != address_to_line_stats_.end(); ++iterator)
+  {
+    delete iterator->second;
+  }
+  for (NameToFileStatsMap::const_iterator iterator = file_stats_.begin();
+       iterator != file_stats_.end(); ++iterator)
+  {
+    delete iterator->second;
+  }
+  for (NameToFileStatsMap::const_iterator iterator = directory_stats_.begin();
+       iterator != directory_stats_.end(); ++iterator)
+  {
+    delete iterator->second;
+  }
+  for (NameToFileStatsMap::const_iterator iterator = module_stats_.begin();
+       iterator != module_stats_.end(); ++iterator)
+  {
+    delete iterator->second;
+  }
+  for (KeyToCrossScriptCallStatsMap::const_iterator iterator =
+         cross_script_calls_.begin();
+       iterator != cross_script_calls_.end(); ++iterator)
+  {
+    delete iterator->second;
+  }
+  for (KeyToPublicCallerStatsMap::const_iterator iterator =
+         public_callers_.begin();
+       iterator != public_callers_.end(); ++iterator)
+  {
+    delete iterator->second;
+  }
+  for (KeyToTimerStatsMap::const_iterator iterator = timers_.begin();
+       iterator != timers_.end(); ++iterator)
+  {
+    delete iterator->second;
+  }
+  for (KeyToRedundantCallStatsMap::const_iterator iterator =
+         redundant_calls_.begin();
+       iterator != redundant_calls_.end(); ++iterator)
+  {
+    delete iterator->second;
+  }
+  for (std::vector<CounterStatistics*>::const_iterator iterator =
+         counters_.begin();
+       iterator != counters_.end(); ++iterator)
+  {
+    delete *iterator;
+  }
+  std::vector<CallSiteStatistics*> all_call_sites;
+  call_sites_.GetAll(all_call_sites);
+  for (std::vector<CallSiteStatistics*>::const_iterator iterator = all_call_sites.begin();
+       iterator != all_call_sites.end(); ++iterator)
+  {
+    delete *iterator;
+  }
 }
 
 Function *Statistics::GetFunction(Address address) {
@@ -51,6 +210,25 @@ Function *Statistics::GetFunction(Address address) {
 void Statistics::AddFunction(Function *fn) {
   FunctionStatistics *fn_stats = new FunctionStatistics(fn);
   address_to_fn_stats_.insert(std::make_pair(fn->address(), fn_stats));
+
+  std::string file = fn->file();
+  if (!file.empty()) {
+    FileStatistics *file_stats = GetOrAddFile(file_stats_, file);
+    file_stats->AdjustNumFunctions(1);
+    fn_stats->set_file_stats(file_stats);
+
+    FileStatistics *directory_stats =
+      GetOrAddFile(directory_stats_, GetDirectory(file));
+    directory_stats->AdjustNumFunctions(1);
+    fn_stats->set_directory_stats(directory_stats);
+  }
+
+  std::string module = fn->module();
+  if (!module.empty()) {
+    FileStatistics *module_stats = GetOrAddFile(module_stats_, module);
+    module_stats->AdjustNumFunctions(1);
+    fn_stats->set_module_stats(module_stats);
+  }
 }
 
 FunctionStatistics *Statistics::GetFunctionStatistics(Address address) const {
@@ -68,4 +246,248 @@ void Statistics::GetStatistics(std::vector<FunctionStatistics*> &stats) const {
   }
 }
 
+void Statistics::GetMemoryStatistics(
+    std::vector<FunctionStatistics*> &stats) const {
+  for (AddressToFuncStatsMap::const_iterator iterator = address_to_fn_stats_.begin();
+       iterator != address_to_fn_stats_.end(); ++iterator) {
+    FunctionStatistics *fn_stats = iterator->second;
+    if (fn_stats->max_stack_usage() > 0
+        || fn_stats->max_heap_usage() > 0
+        || fn_stats->heap_growth() != 0
+        || fn_stats->max_recursion_depth() > 0) {
+      stats.push_back(fn_stats);
+    }
+  }
+  std::sort(stats.begin(), stats.end(), CompareFunctionsByStackUsage);
+}
+
+LineStatistics *Statistics::AddLine(Address address,
+                                    const std::string &file,
+                                    long line) {
+  LineStatistics *line_stats = new LineStatistics(address, file, line);
+  address_to_line_stats_.insert(std::make_pair(address, line_stats));
+  return line_stats;
+}
+
+LineStatistics *Statistics::GetLineStatistics(Address address) const {
+  AddressToLineStatsMap::const_iterator iterator = address_to_line_stats_.find(address);
+  if (iterator != address_to_line_stats_.end()) {
+    return iterator->second;
+  }
+  return 0;
+}
+
+void Statistics::GetLineStatistics(std::vector<LineStatistics*> &stats) const {
+  for (AddressToLineStatsMap::const_iterator iterator = address_to_line_stats_.begin();
+       iterator != address_to_line_stats_.end(); ++iterator) {
+    stats.push_back(iterator->second);
+  }
+}
+
+CallSiteStatistics *Statistics::AddCallSite(Function *fn,
+                                            Address address,
+                                            const std::string &file,
+                                            long line) {
+  CallSiteStatistics *site_stats =
+    new CallSiteStatistics(fn, address, file, line);
+  call_sites_.Insert(site_stats);
+  return site_stats;
+}
+
+void Statistics::GetCallSiteStatistics(
+    std::vector<CallSiteStatistics*> &stats) const {
+  std::vector<CallSiteStatistics*>::size_type first = stats.size();
+  call_sites_.GetAll(stats);
+  std::sort(stats.begin() + first, stats.end(), CompareCallSites);
+}
+
+CrossScriptCallStatistics *Statistics::GetOrAddCrossScriptCall(
+    const std::string &caller_script,
+    const std::string &caller,
+    const std::string &callee_script,
+    const std::string &callee) {
+  std::string key;
+  key.append(caller_script).append(1, '\0')
+     .append(caller).append(1, '\0')
+     .append(callee_script).append(1, '\0')
+     .append(callee);
+
+  KeyToCrossScriptCallStatsMap::const_iterator iterator =
+    cross_script_calls_.find(key);
+  if (iterator != cross_script_calls_.end()) {
+    return iterator->second;
+  }
+
+  CrossScriptCallStatistics *call_stats =
+    new CrossScriptCallStatistics(caller_script, caller, callee_script, callee);
+  cross_script_calls_.insert(std::make_pair(key, call_stats));
+  return call_stats;
+}
+
+void Statistics::GetCrossScriptCallStatistics(
+    std::vector<CrossScriptCallStatistics*> &stats) const {
+  std::vector<CrossScriptCallStatistics*>::size_type first = stats.size();
+  for (KeyToCrossScriptCallStatsMap::const_iterator iterator =
+         cross_script_calls_.begin();
+       iterator != cross_script_calls_.end(); ++iterator) {
+    stats.push_back(iterator->second);
+  }
+  std::stable_sort(stats.begin() + first, stats.end(),
+                   CompareCrossScriptCallsByTime);
+}
+
+PublicCallerStatistics *Statistics::GetOrAddPublicCaller(
+    const std::string &module,
+    Function *fn) {
+  std::pair<std::string, Address> key(module, fn->address());
+
+  KeyToPublicCallerStatsMap::const_iterator iterator =
+    public_callers_.find(key);
+  if (iterator != public_callers_.end()) {
+    return iterator->second;
+  }
+
+  PublicCallerStatistics *caller_stats = new PublicCallerStatistics(module, fn);
+  public_callers_.insert(std::make_pair(key, caller_stats));
+  return caller_stats;
+}
+
+void Statistics::GetPublicCallerStatistics(
+    std::vector<PublicCallerStatistics*> &stats) const {
+  std::vector<PublicCallerStatistics*>::size_type first = stats.size();
+  for (KeyToPublicCallerStatsMap::const_iterator iterator =
+         public_callers_.begin();
+       iterator != public_callers_.end(); ++iterator) {
+    stats.push_back(iterator->second);
+  }
+  std::stable_sort(stats.begin() + first, stats.end(),
+                   ComparePublicCallersByTime);
+}
+
+void Statistics::GetFileStatistics(std::vector<FileStatistics*> &stats) const {
+  GetSortedFiles(file_stats_, stats);
+}
+
+void Statistics::GetDirectoryStatistics(
+    std::vector<FileStatistics*> &stats) const {
+  GetSortedFiles(directory_stats_, stats);
+}
+
+void Statistics::GetModuleStatistics(
+    std::vector<FileStatistics*> &stats) const {
+  GetSortedFiles(module_stats_, stats);
+}
+
+TimerStatistics *Statistics::AddTimer(Function *fn,
+                                      Address call_site,
+                                      const std::string &file,
+                                      long line) {
+  TimerStatistics *timer_stats =
+    new TimerStatistics(fn, call_site, file, line);
+  timers_.insert(std::make_pair(std::make_pair(fn->address(), call_site),
+                                timer_stats));
+  return timer_stats;
+}
+
+TimerStatistics *Statistics::GetTimerStatistics(Address fn_address,
+                                                Address call_site) const {
+  KeyToTimerStatsMap::const_iterator iterator =
+    timers_.find(std::make_pair(fn_address, call_site));
+  if (iterator != timers_.end()) {
+    return iterator->second;
+  }
+  return 0;
+}
+
+void Statistics::GetTimerStatistics(
+    std::vector<TimerStatistics*> &stats) const {
+  std::vector<TimerStatistics*>::size_type first = stats.size();
+  for (KeyToTimerStatsMap::const_iterator iterator = timers_.begin();
+       iterator != timers_.end(); ++iterator) {
+    stats.push_back(iterator->second);
+  }
+  std::stable_sort(stats.begin() + first, stats.end(), CompareTimersByTime);
+}
+
+RedundantCallStatistics *Statistics::AddRedundantCall(Function *native,
+                                                      Address call_site,
+                                                      const std::string &file,
+                                                      long line) {
+  RedundantCallStatistics *call_stats =
+    new RedundantCallStatistics(native, call_site, file, line);
+  redundant_calls_.insert(
+    std::make_pair(std::make_pair(native->address(), call_site), call_stats));
+  return call_stats;
+}
+
+RedundantCallStatistics *Statistics::GetRedundantCallStatistics(
+    Address native_address,
+    Address call_site) const {
+  KeyToRedundantCallStatsMap::const_iterator iterator =
+    redundant_calls_.find(std::make_pair(native_address, call_site));
+  if (iterator != redundant_calls_.end()) {
+    return iterator->second;
+  }
+  return 0;
+}
+
+void Statistics::GetRedundantCallStatistics(
+    std::vector<RedundantCallStatistics*> &stats) const {
+  std::vector<RedundantCallStatistics*>::size_type first = stats.size();
+  for (KeyToRedundantCallStatsMap::const_iterator iterator =
+         redundant_calls_.begin();
+       iterator != redundant_calls_.end(); ++iterator) {
+    stats.push_back(iterator->second);
+  }
+  std::stable_sort(stats.begin() + first, stats.end(),
+                   CompareRedundantCallsByTime);
+}
+
+CounterStatistics *Statistics::AddCounter(const std::string &name) {
+  CounterStatistics *counter_stats =
+    new CounterStatistics(static_cast<int>(counters_.size()), name);
+  counters_.push_back(counter_stats);
+  return counter_stats;
+}
+
+CounterStatistics *Statistics::GetCounterStatistics(int id) const {
+  if (id < 0 || id >= static_cast<int>(counters_.size())) {
+    return 0;
+  }
+  return counters_[id];
+}
+
+void Statistics::GetCounterStatistics(
+    std::vector<CounterStatistics*> &stats) const {
+  stats.insert(stats.end(), counters_.begin(), counters_.end());
+}
+
+PlayerStatistics *Statistics::GetPlayerStatistics(cell playerid) {
+  if (playerid < 0 || playerid >= PlayerStatistics::kMaxPlayers) {
+    return 0;
+  }
+  // The table is only allocated if player callbacks are used.
+  if (players_.empty()) {
+    players_.reserve(PlayerStatistics::kMaxPlayers);
+    for (cell i = 0; i < PlayerStatistics::kMaxPlayers; i++) {
+      players_.push_back(PlayerStatistics(i));
+    }
+  }
+  return &players_[playerid];
+}
+
+void Statistics::GetPlayerStatistics(
+    std::vector<const PlayerStatistics*> &stats) const {
+  std::vector<const PlayerStatistics*>::size_type first = stats.size();
+  for (std::vector<PlayerStatistics>::const_iterator iterator =
+         players_.begin();
+       iterator != players_.end(); ++iterator) {
+    if (iterator->num_calls() > 0) {
+      stats.push_back(&*iterator);
+    }
+  }
+  std::stable_sort(stats.begin() + first, stats.end(),
+                   ComparePlayersByTotalTime);
+}
+
 } // namespace amxprof
@@ -26,29 +26,192 @@
 #define AMXPROF_STATISTICS_H
 
 #include <map>
+#include <string>
+#include <utility>
 #include <vector>
 #include "amx_types.h"
+#include "call_site_table.h"
+#include "clock.h"
 #include "duration.h"
 #include "performance_counter.h"
+#include "player_statistics.h"
+#include "slow_call_log.h"
+#include "tick_statistics.h"
 
 namespace amxprof {
 
+class CallSiteStatistics;
+class CounterStatistics;
+class CrossScriptCallStatistics;
+class FileStatistics;
 class Function;
 class FunctionStatistics;
+class LineStatistics;
+class PublicCallerStatistics;
+class RedundantCallStatistics;
+class TimerStatistics;
 
 class Statistics {
  public:
   typedef std::map<Address, FunctionStatistics*> AddressToFuncStatsMap;
+  typedef std::map<Address, LineStatistics*> AddressToLineStatsMap;
+  typedef std::map<std::string, FileStatistics*> NameToFileStatsMap;
+  typedef std::map<std::string, CrossScriptCallStatistics*>
+    KeyToCrossScriptCallStatsMap;
+  typedef std::map<std::pair<std::string, Address>, PublicCallerStatistics*>
+    KeyToPublicCallerStatsMap;
+  typedef std::map<std::pair<Address, Address>, TimerStatistics*>
+    KeyToTimerStatsMap;
+  typedef std::map<std::pair<Address, Address>, RedundantCallStatistics*>
+    KeyToRedundantCallStatsMap;
 
-  Statistics();
+  // The clock is used to measure the total run time.
+  explicit Statistics(Clock *clock = SystemClock::GetInstance());
   ~Statistics();
 
+  // Also adds the function to the statistics of its file and directory,
+  // if it has one, or of its module if it's a native.
   void AddFunction(Function *fn);
   Function *GetFunction(Address address);
 
   FunctionStatistics *GetFunctionStatistics(Address address) const;
   void GetStatistics(std::vector<FunctionStatistics*> &stats) const;
 
+  // Functions that used any stack or heap space or were called
+  // recursively, sorted by stack usage from highest to lowest. Only
+  // filled if memory_measured() is set.
+  void GetMemoryStatistics(std::vector<FunctionStatistics*> &stats) const;
+
+  LineStatistics *AddLine(Address address, const std::string &file, long line);
+  LineStatistics *GetLineStatistics(Address address) const;
+  void GetLineStatistics(std::vector<LineStatistics*> &stats) const;
+
+  // Call sites are identified by the called function and the return
+  // address. GetCallSiteStatistics() sorts them by function and address.
+  CallSiteStatistics *AddCallSite(Function *fn,
+                                  Address address,
+                                  const std::string &file,
+                                  long line);
+  CallSiteStatistics *GetCallSiteStatistics(Address fn_address,
+                                            Address address) const {
+    return call_sites_.Find(fn_address, address);
+  }
+  void GetCallSiteStatistics(std::vector<CallSiteStatistics*> &stats) const;
+
+  // Per-file and per-directory statistics, sorted by total time from
+  // highest to lowest.
+  void GetFileStatistics(std::vector<FileStatistics*> &stats) const;
+  void GetDirectoryStatistics(std::vector<FileStatistics*> &stats) const;
+
+  // Native functions grouped by the module implementing them, see
+  // Function::module(). Sorted like files.
+  void GetModuleStatistics(std::vector<FileStatistics*> &stats) const;
+
+  // Calls between this and other scripts in either direction, identified
+  // by the caller's script and stack and the callee's script and public.
+  // GetCrossScriptCallStatistics() sorts them by time from highest to
+  // lowest.
+  CrossScriptCallStatistics *GetOrAddCrossScriptCall(
+    const std::string &caller_script,
+    const std::string &caller,
+    const std::string &callee_script,
+    const std::string &callee);
+  void GetCrossScriptCallStatistics(
+    std::vector<CrossScriptCallStatistics*> &stats) const;
+
+  // Calls to public functions grouped by the module that called
+  // amx_Exec(). GetPublicCallerStatistics() sorts them by time from
+  // highest to lowest.
+  PublicCallerStatistics *GetOrAddPublicCaller(const std::string &module,
+                                               Function *fn);
+  void GetPublicCallerStatistics(
+    std::vector<PublicCallerStatistics*> &stats) const;
+
+  // Timers grouped by the public function they call and the return
+  // address of the SetTimer() or SetTimerEx() call that started them.
+  // GetTimerStatistics() sorts them by time from highest to lowest.
+  TimerStatistics *AddTimer(Function *fn,
+                            Address call_site,
+                            const std::string &file,
+                            long line);
+  TimerStatistics *GetTimerStatistics(Address fn_address,
+                                      Address call_site) const;
+  void GetTimerStatistics(std::vector<TimerStatistics*> &stats) const;
+
+  // Native calls that repeated an earlier call with the same arguments
+  // within the same public call, grouped by the native and the return
+  // address of the repeated call. GetRedundantCallStatistics() sorts them
+  // by time and then by number of calls from highest to lowest.
+  RedundantCallStatistics *AddRedundantCall(Function *native,
+                                            Address call_site,
+                                            const std::string &file,
+                                            long line);
+  RedundantCallStatistics *GetRedundantCallStatistics(
+    Address native_address,
+    Address call_site) const;
+  void GetRedundantCallStatistics(
+    std::vector<RedundantCallStatistics*> &stats) const;
+
+  // Counters set by the script, see Profiler::GetCounterId(). The ID of
+  // a counter is the number of counters added before it.
+  CounterStatistics *AddCounter(const std::string &name);
+  CounterStatistics *GetCounterStatistics(int id) const;
+  void GetCounterStatistics(std::vector<CounterStatistics*> &stats) const;
+
+  // Calls to player callbacks grouped by player, see
+  // Profiler::SetPlayerCallbacks(). Returns null if the ID is out of
+  // range. GetPlayerStatistics() returns the players with at least one
+  // call, sorted by total time from highest to lowest.
+  PlayerStatistics *GetPlayerStatistics(cell playerid);
+  void GetPlayerStatistics(
+    std::vector<const PlayerStatistics*> &stats) const;
+
+  // Public function calls that took longer than the profiler's slow call
+  // threshold.
+  SlowCallLog *slow_calls() { return &slow_calls_; }
+  const SlowCallLog *slow_calls() const { return &slow_calls_; }
+
+  // Timed calls split into server ticks, see Profiler::EndTick().
+  TickStatistics *ticks() { return &ticks_; }
+  const TickStatistics *ticks() const { return &ticks_; }
+
+  // Whether FunctionStatistics::cpu_time() was measured.
+  bool cpu_time_measured() const { return cpu_time_measured_; }
+  void set_cpu_time_measured(bool measured) { cpu_time_measured_ = measured; }
+
+  // Whether stack and heap usage was tracked, see
+  // Profiler::set_memory_stats_enabled().
+  bool memory_measured() const { return memory_measured_; }
+  void set_memory_measured(bool measured) { memory_measured_ = measured; }
+
+  // Size of the space shared by the stack and the heap (#pragma dynamic)
+  // and the most of it used by each and by both at once, in bytes.
+  cell stack_heap_size() const { return stack_heap_size_; }
+  void set_stack_heap_size(cell size) { stack_heap_size_ = size; }
+
+  cell max_stack_usage() const { return max_stack_usage_; }
+  cell max_heap_usage() const { return max_heap_usage_; }
+  cell max_stack_heap_usage() const { return max_stack_heap_usage_; }
+
+  void UpdateMemoryUsage(cell stack_usage, cell heap_usage) {
+    if (stack_usage > max_stack_usage_) {
+      max_stack_usage_ = stack_usage;
+    }
+    if (heap_usage > max_heap_usage_) {
+      max_heap_usage_ = heap_usage;
+    }
+    if (stack_usage + heap_usage > max_stack_heap_usage_) {
+      max_stack_heap_usage_ = stack_usage + heap_usage;
+    }
+  }
+
+  // The perf counters that FunctionStatistics::self_counts() come from,
+  // or null if none were used.
+  const PerfCounters *perf_counters() const { return perf_counters_; }
+  void set_perf_counters(const PerfCounters *counters) {
+    perf_counters_ = counters;
+  }
+
   Nanoseconds GetTotalRunTime() const {
     return run_time_counter_.QueryTotalTime();
   }
@@ -56,6 +219,26 @@ class Statistics {
  private:
   PerformanceCounter run_time_counter_;
   AddressToFuncStatsMap address_to_fn_stats_;
+  AddressToLineStatsMap address_to_line_stats_;
+  CallSiteTable call_sites_;
+  NameToFileStatsMap file_stats_;
+  NameToFileStatsMap directory_stats_;
+  NameToFileStatsMap module_stats_;
+  KeyToCrossScriptCallStatsMap cross_script_calls_;
+  KeyToPublicCallerStatsMap public_callers_;
+  KeyToTimerStatsMap timers_;
+  KeyToRedundantCallStatsMap redundant_calls_;
+  std::vector<CounterStatistics*> counters_;
+  std::vector<PlayerStatistics> players_;
+  SlowCallLog slow_calls_;
+  TickStatistics ticks_;
+  bool cpu_time_measured_;
+  bool memory_measured_;
+  cell stack_heap_size_;
+  cell max_stack_usage_;
+  cell max_heap_usage_;
+  cell max_stack_heap_usage_;
+  const PerfCounters *perf_counters_;
 };
 
 } // namespace amxprof
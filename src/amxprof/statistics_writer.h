@@ -27,6 +27,8 @@
 
 #include <iosfwd>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace amxprof {
 
@@ -34,6 +36,8 @@ class Statistics;
 
 class StatisticsWriter {
  public:
+  typedef std::vector<std::pair<std::string, std::string> > Metadata;
+
   StatisticsWriter();
   virtual ~StatisticsWriter();
 
@@ -51,11 +55,20 @@ class StatisticsWriter {
   bool print_run_time() const { return print_run_time_; }
   void set_print_run_time(bool print_run_time) { print_run_time_ = print_run_time; }
 
+  // Additional name/value pairs that describe how the profile was taken,
+  // such as the instrumentation level. They are written along with the
+  // date and the duration.
+  const Metadata &metadata() const { return metadata_; }
+  void AddMetadata(const std::string &name, const std::string &value) {
+    metadata_.push_back(std::make_pair(name, value));
+  }
+
  private:
   std::ostream *stream_;
   std::string script_name_;
   bool print_date_;
   bool print_run_time_;
+  Metadata metadata_;
 };
 
 } // namespace amxprof
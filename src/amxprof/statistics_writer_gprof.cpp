@@ -0,0 +1,275 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+#include "call_graph.h"
+#include "duration.h"
+#include "function.h"
+#include "function_statistics.h"
+#include "statistics_writer_gprof.h"
+#include "statistics.h"
+#include "time_utils.h"
+
+namespace amxprof {
+
+namespace {
+
+typedef std::vector<const CallGraphEdge*> Edges;
+
+// Everything known about one function: its node in the call graph and
+// the edges leading to and from it.
+struct Entry {
+  const CallGraphNode *node;
+  Edges callers;
+  Edges callees;
+  long num_calls;   // sum of the callers' calls
+  Nanoseconds time; // sum of the callers' time
+  int index;
+};
+
+typedef std::map<const CallGraphNode*, Entry> Entries;
+
+class CollectEntries : public CallGraph::Visitor {
+ public:
+  CollectEntries(Entries *entries) : entries_(entries) {}
+
+  virtual void Visit(const CallGraphNode *node) {
+    for (CallGraphNode::Callees::const_iterator iterator =
+           node->callees().begin();
+         iterator != node->callees().end(); ++iterator) {
+      const CallGraphEdge *edge = iterator->second;
+      if (node != node->graph()->sentinel()) {
+        GetEntry(node).callees.push_back(edge);
+      }
+      Entry &callee = GetEntry(iterator->first);
+      callee.callers.push_back(edge);
+      callee.num_calls += edge->num_calls();
+      callee.time += edge->time();
+    }
+  }
+
+ private:
+  Entry &GetEntry(const CallGraphNode *node) {
+    Entries::iterator iterator = entries_->find(node);
+    if (iterator == entries_->end()) {
+      Entry entry;
+      entry.node = node;
+      entry.num_calls = 0;
+      entry.index = 0;
+      iterator = entries_->insert(std::make_pair(node, entry)).first;
+    }
+    return iterator->second;
+  }
+
+  Entries *entries_;
+};
+
+// Orders functions by name and then by address so that the output doesn't
+// depend on where the nodes happen to be allocated.
+bool CompareFunctions(const Function *lhs, const Function *rhs) {
+  int result = lhs->name().compare(rhs->name());
+  if (result != 0) {
+    return result < 0;
+  }
+  return lhs->address() < rhs->address();
+}
+
+bool CompareEntriesByTime(const Entry *lhs, const Entry *rhs) {
+  Nanoseconds lhs_time = lhs->node->stats()->total_time();
+  Nanoseconds rhs_time = rhs->node->stats()->total_time();
+  if (lhs_time != rhs_time) {
+    return rhs_time < lhs_time;
+  }
+  return CompareFunctions(lhs->node->stats()->function(),
+                          rhs->node->stats()->function());
+}
+
+bool CompareCallersByTime(const CallGraphEdge *lhs, const CallGraphEdge *rhs) {
+  return lhs->time() < rhs->time();
+}
+
+bool CompareCalleesByTime(const CallGraphEdge *lhs, const CallGraphEdge *rhs) {
+  return rhs->time() < lhs->time();
+}
+
+double Percent(Nanoseconds part, Nanoseconds whole) {
+  if (whole.count() <= 0) {
+    return 0;
+  }
+  return part.count() * 100 / whole.count();
+}
+
+} // anonymous namespace
+
+StatisticsWriterGprof::StatisticsWriterGprof()
+ : call_graph_(0)
+{
+}
+
+void StatisticsWriterGprof::Write(const Statistics *stats) {
+  *stream() << "Call graph of '" << script_name() << "'";
+
+  if (print_date()) {
+    *stream() << " generated on " << CTime();
+  }
+
+  if (print_run_time()) {
+    *stream() << " (duration: " << TimeSpan(stats->GetTotalRunTime()) << ")";
+  }
+
+  *stream() << "\n";
+
+  for (Metadata::const_iterator it = metadata().begin();
+       it != metadata().end(); ++it) {
+    *stream() << it->first << ": " << it->second << "\n";
+  }
+
+  if (call_graph_ == 0) {
+    *stream() << "\nNo call graph was collected.\n";
+    return;
+  }
+
+  Entries entries;
+  CollectEntries collect_entries(&entries);
+  call_graph_->Traverse(&collect_entries);
+
+  // Number the functions from the most expensive one, which is how they
+  // are listed and referred to.
+  std::vector<Entry*> sorted_entries;
+  for (Entries::iterator it = entries.begin(); it != entries.end(); ++it) {
+    if (it->first != call_graph_->sentinel()) {
+      sorted_entries.push_back(&it->second);
+    }
+  }
+  std::stable_sort(sorted_entries.begin(), sorted_entries.end(),
+                   CompareEntriesByTime);
+  for (std::size_t i = 0; i < sorted_entries.size(); i++) {
+    sorted_entries[i]->index = static_cast<int>(i + 1);
+  }
+
+  // Everything starts at the root, so the time of its edges adds up to
+  // the total.
+  Nanoseconds total_time_all;
+  const CallGraphNode::Callees &roots = call_graph_->sentinel()->callees();
+  for (CallGraphNode::Callees::const_iterator it = roots.begin();
+       it != roots.end(); ++it) {
+    total_time_all += it->second->time();
+  }
+
+  *stream()
+    << "\n"
+    << "Each entry lists the callers of a function above it and its callees\n"
+    << "below. For callers, \"% time\" is the share of the function's time\n"
+    << "spent in calls from that caller; for callees, the share of the\n"
+    << "function's time spent in that callee. Times are in milliseconds and\n"
+    << "include everything called.\n"
+    << "\n"
+    << std::left
+    << std::setw(8) << "index"
+    << std::setw(9) << "% time"
+    << std::setw(14) << "self"
+    << std::setw(14) << "total"
+    << std::setw(20) << "called"
+    << "name\n";
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (std::vector<Entry*>::const_iterator it = sorted_entries.begin();
+       it != sorted_entries.end(); ++it) {
+    Entry *entry = *it;
+    const FunctionStatistics *fn_stats = entry->node->stats();
+
+    Edges callers = entry->callers;
+    std::sort(callers.begin(), callers.end(), CompareCallersByTime);
+
+    for (Edges::const_iterator edge = callers.begin();
+         edge != callers.end(); ++edge) {
+      const CallGraphNode *caller = (*edge)->caller();
+      std::ostringstream called;
+      called << (*edge)->num_calls() << "/" << entry->num_calls;
+
+      *stream()
+        << std::setw(8) << ""
+        << std::setw(9) << std::setprecision(1)
+          << Percent((*edge)->time(), entry->time)
+        << std::setw(14) << ""
+        << std::setw(14) << std::setprecision(3)
+          << Milliseconds((*edge)->time()).count()
+        << std::setw(20) << called.str();
+      if (caller == call_graph_->sentinel()) {
+        *stream() << "    <spontaneous>\n";
+      } else {
+        *stream() << "    " << caller->stats()->function()->name()
+                  << " [" << entries[caller].index << "]\n";
+      }
+    }
+
+    std::ostringstream index;
+    index << "[" << entry->index << "]";
+
+    *stream()
+      << std::setw(8) << index.str()
+      << std::setw(9) << std::setprecision(1)
+        << Percent(fn_stats->total_time(), total_time_all)
+      << std::setw(14) << std::setprecision(3)
+        << Milliseconds(fn_stats->self_time()).count()
+      << std::setw(14) << std::setprecision(3)
+        << Milliseconds(fn_stats->total_time()).count()
+      << std::setw(20) << fn_stats->num_calls()
+      << fn_stats->function()->name() << " " << index.str() << "\n";
+
+    Edges callees = entry->callees;
+    std::sort(callees.begin(), callees.end(), CompareCalleesByTime);
+
+    for (Edges::const_iterator edge = callees.begin();
+         edge != callees.end(); ++edge) {
+      const CallGraphNode *callee = (*edge)->callee();
+      std::ostringstream called;
+      called << (*edge)->num_calls() << "/" << entries[callee].num_calls;
+
+      *stream()
+        << std::setw(8) << ""
+        << std::setw(9) << std::setprecision(1)
+          << Percent((*edge)->time(), entry->time)
+        << std::setw(14) << ""
+        << std::setw(14) << std::setprecision(3)
+          << Milliseconds((*edge)->time()).count()
+        << std::setw(20) << called.str()
+        << "    " << callee->stats()->function()->name()
+        << " [" << entries[callee].index << "]\n";
+    }
+
+    *stream() << std::string(64, '-') << "\n";
+  }
+
+  stream()->flags(flags);
+}
+
+} // namespace amxprof
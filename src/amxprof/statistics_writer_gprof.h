@@ -0,0 +1,55 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_STATISTICS_WRITER_GPROF_H
+#define AMXPROF_STATISTICS_WRITER_GPROF_H
+
+#include "statistics_writer.h"
+
+namespace amxprof {
+
+class CallGraph;
+
+// Writes a gprof-style call graph: for each function, the functions that
+// called it and the functions it called, with the number of calls and time
+// that went through each of them. The profile must have been taken with
+// the call graph enabled.
+class StatisticsWriterGprof : public StatisticsWriter {
+ public:
+  StatisticsWriterGprof();
+
+  virtual void Write(const Statistics *stats);
+
+  const CallGraph *call_graph() const { return call_graph_; }
+  void set_call_graph(const CallGraph *call_graph) {
+    call_graph_ = call_graph;
+  }
+
+ private:
+  const CallGraph *call_graph_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_STATISTICS_WRITER_GPROF_H
@@ -24,16 +24,53 @@
 
 #include <iomanip>
 #include <iostream>
+#include <string>
+#include "call_site_statistics.h"
+#include "counter_statistics.h"
+#include "cross_script_call_statistics.h"
 #include "duration.h"
+#include "file_statistics.h"
 #include "function.h"
 #include "function_statistics.h"
+#include "line_statistics.h"
 #include "statistics_writer_html.h"
+#include "perf_counters.h"
 #include "performance_counter.h"
+#include "player_statistics.h"
+#include "redundant_call_statistics.h"
+#include "public_caller_statistics.h"
+#include "slow_call_log.h"
 #include "statistics.h"
+#include "tick_statistics.h"
+#include "timer_statistics.h"
 #include "time_utils.h"
 
 namespace amxprof {
 
+namespace {
+
+std::string EscapeHtml(const std::string &s) {
+  std::string result;
+  for (std::string::size_type i = 0; i < s.length(); i++) {
+    switch (s[i]) {
+      case '<':
+        result.append("&lt;");
+        break;
+      case '>':
+        result.append("&gt;");
+        break;
+      case '&':
+        result.append("&amp;");
+        break;
+      default:
+        result.push_back(s[i]);
+    }
+  }
+  return result;
+}
+
+} // anonymous namespace
+
 void StatisticsWriterHtml::Write(const Statistics *stats)
 {
   *stream() <<
@@ -49,8 +86,8 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
   "  </script>\n"
   "  <script type=\"text/javascript\">\n"
   "    $(document).ready(function() {\n"
-  "      $('#data').tablesorter();\n"
-  "      $('#data th').hover(function () {\n"
+  "      $('.tablesorter').tablesorter();\n"
+  "      $('.tablesorter th').hover(function () {\n"
   "        $(this).css({ cursor: 'pointer' });\n"
   "      });\n"
   "    });\n"
@@ -117,6 +154,16 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
     ;
   }
 
+  for (Metadata::const_iterator it = metadata().begin();
+       it != metadata().end(); ++it) {
+    *stream() <<
+    "      <tr>\n"
+    "        <td>" << it->first << "</td>\n"
+    "        <td>" << it->second << "</td>\n"
+    "      </tr>\n"
+    ;
+  }
+
   *stream() <<
   "    </tbody>\n"
   "  </table>\n"
@@ -129,6 +176,14 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
   "        <th rowspan=\"2\">Calls</th>\n"
   "        <th colspan=\"4\" class=\"group\">Self Time</th>\n"
   "        <th colspan=\"4\" class=\"group\">Total Time</th>\n"
+  ;
+  bool cpu_time_measured = stats->cpu_time_measured();
+  if (cpu_time_measured) {
+    *stream() <<
+    "        <th colspan=\"2\" class=\"group\">Off-CPU Time</th>\n"
+    ;
+  }
+  *stream() <<
   "      </tr>\n"
   "      <tr>\n"
   "        <th>%</th>\n"
@@ -139,6 +194,14 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
   "        <th>Overall</th>\n"
   "        <th>Average</th>\n"
   "        <th>Worst</th>\n"
+  ;
+  if (cpu_time_measured) {
+    *stream() <<
+    "        <th>%</th>\n"
+    "        <th>Overall</th>\n"
+    ;
+  }
+  *stream() <<
   "      </tr>\n"
   "    </thead>\n"
   "    <tbody>\n"
@@ -188,7 +251,8 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
     *stream()
     << "    <tr>\n"
     << "      <td>" << fn_stats->function()->GetTypeString() << "</td>\n"
-    << "      <td>" << fn_stats->function()->name() << "</td>\n"
+    << "      <td>" << EscapeHtml(fn_stats->function()->name())
+                    << "</td>\n"
     << "      <td class=\"numeric\">" << fn_stats->num_calls() << "</td>\n"
     << "      <td class=\"numeric\">" << std::setprecision(2)
                                       << self_time_percent << "%</td>\n"
@@ -205,7 +269,21 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
     << "      <td class=\"numeric\">" << std::setprecision(1)
                                       << avg_total_time << "</td>\n"
     << "      <td class=\"numeric\">" << std::setprecision(1)
-                                      << worst_total_time << "</td>\n"
+                                      << worst_total_time << "</td>\n";
+    if (cpu_time_measured) {
+      double off_cpu_time_percent = 0;
+      if (fn_stats->total_time() > Nanoseconds(0)) {
+        off_cpu_time_percent = fn_stats->off_cpu_time().count() * 100
+                             / fn_stats->total_time().count();
+      }
+      double off_cpu_time = Seconds(fn_stats->off_cpu_time()).count();
+      *stream()
+      << "      <td class=\"numeric\">" << std::setprecision(2)
+                                        << off_cpu_time_percent << "%</td>\n"
+      << "      <td class=\"numeric\">" << std::setprecision(1)
+                                        << off_cpu_time << "</td>\n";
+    }
+    *stream()
     << "    </tr>\n";
   };
 
@@ -214,9 +292,985 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
   *stream() <<
   "    </tbody>\n"
   "  </table>\n"
+  ;
+
+  WriteCounters(stats);
+
+  std::vector<FileStatistics*> all_file_stats;
+  stats->GetFileStatistics(all_file_stats);
+  WriteFiles("files", "File", all_file_stats, self_time_all);
+
+  std::vector<FileStatistics*> all_directory_stats;
+  stats->GetDirectoryStatistics(all_directory_stats);
+  WriteFiles("directories", "Directory", all_directory_stats, self_time_all);
+
+  std::vector<FileStatistics*> all_module_stats;
+  stats->GetModuleStatistics(all_module_stats);
+  WriteFiles("modules", "Module", all_module_stats, self_time_all);
+
+  WriteLines(stats);
+  WriteCallSites(stats);
+  WriteCrossScriptCalls(stats);
+  WritePublicCallers(stats);
+  WriteSlowCalls(stats);
+  WriteTicks(stats);
+  WriteTimers(stats);
+  WritePlayers(stats);
+  WriteMemory(stats);
+  WriteRedundantCalls(stats);
+  WriteScriptCounters(stats);
+
+  *stream() <<
   "</body>\n"
   "</html>\n"
   ;
 }
 
+void StatisticsWriterHtml::WriteCounters(const Statistics *stats) {
+  const PerfCounters *counters = stats->perf_counters();
+  if (counters == 0 || !counters->is_open()) {
+    return;
+  }
+
+  // Instructions per cycle only make sense for hardware events.
+  bool show_ipc = counters->is_hardware();
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"counters\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Type</th>\n"
+  "        <th>Name</th>\n"
+  "        <th>Calls</th>\n"
+  ;
+  for (int i = 0; i < counters->num_events(); i++) {
+    *stream() << "        <th>" << counters->event_name(i) << "</th>\n";
+  }
+  if (show_ipc) {
+    *stream() << "        <th>IPC</th>\n";
+  }
+  *stream() <<
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::vector<FunctionStatistics*> all_fn_stats;
+  stats->GetStatistics(all_fn_stats);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<FunctionStatistics*>::const_iterator FuncIterator;
+
+  for (FuncIterator it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+    const FunctionStatistics *fn_stats = *it;
+    EventCounts counts = fn_stats->self_counts();
+
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << fn_stats->function()->GetTypeString() << "</td>\n"
+    << "      <td>" << EscapeHtml(fn_stats->function()->name())
+                    << "</td>\n"
+    << "      <td class=\"numeric\">" << fn_stats->num_calls() << "</td>\n";
+    for (int i = 0; i < counters->num_events(); i++) {
+      *stream()
+      << "      <td class=\"numeric\">" << counts[i] << "</td>\n";
+    }
+    if (show_ipc) {
+      double ipc = 0;
+      if (counts[PerfCounters::CYCLES] != 0) {
+        ipc = static_cast<double>(counts[PerfCounters::INSTRUCTIONS])
+            / counts[PerfCounters::CYCLES];
+      }
+      *stream()
+      << "      <td class=\"numeric\">" << std::setprecision(2)
+                                        << ipc << "</td>\n";
+    }
+    *stream()
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WriteFiles(
+    const char *id,
+    const char *title,
+    const std::vector<FileStatistics*> &all_file_stats,
+    Nanoseconds time_all) {
+  if (all_file_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"" << id << "\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th rowspan=\"2\">" << title << "</th>\n"
+  "        <th rowspan=\"2\">Functions</th>\n"
+  "        <th rowspan=\"2\">Calls</th>\n"
+  "        <th colspan=\"2\" class=\"group\">Self Time</th>\n"
+  "        <th colspan=\"2\" class=\"group\">Total Time</th>\n"
+  "      </tr>\n"
+  "      <tr>\n"
+  "        <th>%</th>\n"
+  "        <th>Overall</th>\n"
+  "        <th>%</th>\n"
+  "        <th>Overall</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<FileStatistics*>::const_iterator FileIterator;
+
+  for (FileIterator it = all_file_stats.begin();
+       it != all_file_stats.end(); ++it) {
+    const FileStatistics *file_stats = *it;
+
+    double self_time_percent =
+      file_stats->self_time().count() * 100 / time_all.count();
+    double total_time_percent =
+      file_stats->total_time().count() * 100 / time_all.count();
+
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << file_stats->name() << "</td>\n"
+    << "      <td class=\"numeric\">" << file_stats->num_functions()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << file_stats->num_calls() << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(2)
+                                      << self_time_percent << "%</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(1)
+                                      << Seconds(file_stats->self_time()).count()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(2)
+                                      << total_time_percent << "%</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(1)
+                                      << Seconds(file_stats->total_time()).count()
+                                      << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WriteLines(const Statistics *stats) {
+  std::vector<LineStatistics*> all_line_stats;
+  stats->GetLineStatistics(all_line_stats);
+
+  if (all_line_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"lines\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>File</th>\n"
+  "        <th>Line</th>\n"
+  "        <th>Hits</th>\n"
+  "        <th>Time %</th>\n"
+  "        <th>Time</th>\n"
+  "        <th>Average</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  typedef std::vector<LineStatistics*>::const_iterator LineIterator;
+
+  Nanoseconds time_all;
+  for (LineIterator it = all_line_stats.begin();
+       it != all_line_stats.end(); ++it) {
+    time_all += (*it)->time();
+  }
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (LineIterator it = all_line_stats.begin();
+       it != all_line_stats.end(); ++it) {
+    const LineStatistics *line_stats = *it;
+
+    double time_percent =
+      line_stats->time().count() * 100 / time_all.count();
+    double time = Seconds(line_stats->time()).count();
+    double avg_time =
+      Milliseconds(line_stats->time()).count() / line_stats->num_hits();
+
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << line_stats->file() << "</td>\n"
+    << "      <td class=\"numeric\">" << line_stats->line() << "</td>\n"
+    << "      <td class=\"numeric\">" << line_stats->num_hits() << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(2)
+                                      << time_percent << "%</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(1)
+                                      << time << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(3)
+                                      << avg_time << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WriteCallSites(const Statistics *stats) {
+  std::vector<CallSiteStatistics*> all_site_stats;
+  stats->GetCallSiteStatistics(all_site_stats);
+
+  if (all_site_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"call-sites\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Function</th>\n"
+  "        <th>Called From</th>\n"
+  "        <th>Calls</th>\n"
+  "        <th>Time %</th>\n"
+  "        <th>Time</th>\n"
+  "        <th>Average</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<CallSiteStatistics*>::const_iterator SiteIterator;
+
+  for (SiteIterator it = all_site_stats.begin();
+       it != all_site_stats.end(); ++it) {
+    const CallSiteStatistics *site_stats = *it;
+    const FunctionStatistics *fn_stats =
+      stats->GetFunctionStatistics(site_stats->function()->address());
+
+    // Percentage of the function's total time spent in calls from here.
+    double time_percent = 0;
+    if (fn_stats->total_time().count() > 0) {
+      time_percent =
+        site_stats->time().count() * 100 / fn_stats->total_time().count();
+    }
+    double time = Seconds(site_stats->time()).count();
+    double avg_time =
+      Milliseconds(site_stats->time()).count() / site_stats->num_calls();
+
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << site_stats->function()->name() << "</td>\n"
+    << "      <td>" << site_stats->GetLocationString() << "</td>\n"
+    << "      <td class=\"numeric\">" << site_stats->num_calls() << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(2)
+                                      << time_percent << "%</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(1)
+                                      << time << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(3)
+                                      << avg_time << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WriteCrossScriptCalls(const Statistics *stats) {
+  std::vector<CrossScriptCallStatistics*> all_call_stats;
+  stats->GetCrossScriptCallStatistics(all_call_stats);
+
+  if (all_call_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"cross-script-calls\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Caller Script</th>\n"
+  "        <th>Caller</th>\n"
+  "        <th>Callee Script</th>\n"
+  "        <th>Callee</th>\n"
+  "        <th>Calls</th>\n"
+  "        <th>Time</th>\n"
+  "        <th>Average</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<CrossScriptCallStatistics*>::const_iterator CallIterator;
+
+  for (CallIterator it = all_call_stats.begin();
+       it != all_call_stats.end(); ++it) {
+    const CrossScriptCallStatistics *call_stats = *it;
+
+    double time = Seconds(call_stats->time()).count();
+    double avg_time =
+      Milliseconds(call_stats->time()).count() / call_stats->num_calls();
+
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << call_stats->caller_script() << "</td>\n"
+    << "      <td>" << EscapeHtml(call_stats->caller()) << "</td>\n"
+    << "      <td>" << call_stats->callee_script() << "</td>\n"
+    << "      <td>" << call_stats->callee() << "</td>\n"
+    << "      <td class=\"numeric\">" << call_stats->num_calls() << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(1)
+                                      << time << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(3)
+                                      << avg_time << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WritePublicCallers(const Statistics *stats) {
+  std::vector<PublicCallerStatistics*> all_caller_stats;
+  stats->GetPublicCallerStatistics(all_caller_stats);
+
+  if (all_caller_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"public-callers\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Called By</th>\n"
+  "        <th>Public</th>\n"
+  "        <th>Calls</th>\n"
+  "        <th>Time</th>\n"
+  "        <th>Average</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<PublicCallerStatistics*>::const_iterator CallerIterator;
+
+  for (CallerIterator it = all_caller_stats.begin();
+       it != all_caller_stats.end(); ++it) {
+    const PublicCallerStatistics *caller_stats = *it;
+
+    double time = Seconds(caller_stats->time()).count();
+    double avg_time =
+      Milliseconds(caller_stats->time()).count() / caller_stats->num_calls();
+
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << caller_stats->module() << "</td>\n"
+    << "      <td>" << caller_stats->function()->name() << "</td>\n"
+    << "      <td class=\"numeric\">" << caller_stats->num_calls()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(1)
+                                      << time << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(3)
+                                      << avg_time << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WriteSlowCalls(const Statistics *stats) {
+  const SlowCallLog *slow_calls = stats->slow_calls();
+  if (slow_calls->is_empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"slow-calls\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Date</th>\n"
+  "        <th>Call</th>\n"
+  "        <th>Time</th>\n"
+  "        <th>Slowest Calls Made</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (SlowCallLog::const_iterator it = slow_calls->begin();
+       it != slow_calls->end(); ++it) {
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << CTime(it->time_stamp()) << "</td>\n"
+    << "      <td>" << EscapeHtml(it->stack()) << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(3)
+                                      << Milliseconds(it->time()).count()
+                                      << "</td>\n"
+    << "      <td>";
+
+    const std::vector<SlowCallFrame> &frames = it->frames();
+    for (std::vector<SlowCallFrame>::const_iterator frame_it = frames.begin();
+         frame_it != frames.end(); ++frame_it) {
+      *stream() << std::setprecision(3)
+                << Milliseconds(frame_it->time()).count() << " ms: "
+                << EscapeHtml(frame_it->stack()) << "<br/>";
+    }
+
+    *stream() << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WriteTicks(const Statistics *stats) {
+  const TickStatistics *ticks = stats->ticks();
+  if (ticks->num_ticks() == 0) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"tick-histogram\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Script Time / Tick</th>\n"
+  "        <th>Ticks</th>\n"
+  "        <th>Ticks (%)</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (int i = 0; i < TickStatistics::kNumHistogramBuckets; i++) {
+    long count = ticks->histogram_count(i);
+    double percent =
+      static_cast<double>(count) * 100 / ticks->num_ticks();
+
+    *stream() << "    <tr>\n" << "      <td>" << std::setprecision(2);
+    if (i < TickStatistics::kNumHistogramBuckets - 1) {
+      *stream() << "&lt; " << TickStatistics::GetHistogramBound(i).count();
+    } else {
+      *stream() << "&gt;= "
+                << TickStatistics::GetHistogramBound(i - 1).count();
+    }
+    *stream() << " ms</td>\n"
+    << "      <td class=\"numeric\">" << count << "</td>\n"
+    << "      <td class=\"numeric\">" << percent << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  *stream() <<
+  "    </tbody>\n"
+  "    <tfoot>\n"
+  "      <tr>\n"
+  ;
+  *stream()
+  << "        <td>Total: " << ticks->num_ticks() << " ticks</td>\n"
+  << "        <td class=\"numeric\" colspan=\"2\">" << std::setprecision(3)
+      << Milliseconds(ticks->total_script_time()).count()
+         / ticks->num_ticks() << " ms avg, "
+      << Milliseconds(ticks->max_script_time()).count() << " ms max</td>\n";
+  *stream() <<
+  "      </tr>\n"
+  "    </tfoot>\n"
+  "  </table>\n"
+  ;
+
+  std::vector<FunctionTickStatistics*> all_fn_stats;
+  ticks->GetFunctionStatistics(all_fn_stats);
+
+  if (!all_fn_stats.empty()) {
+    *stream() <<
+    "  <br/>\n"
+    "  <table id=\"tick-functions\" class=\"tablesorter\">\n"
+    "    <thead>\n"
+    "      <tr>\n"
+    "        <th>Function</th>\n"
+    "        <th>Ticks</th>\n"
+    "        <th>Avg. Time / Tick (ms)</th>\n"
+    "        <th>Max Time / Tick (ms)</th>\n"
+    "        <th>Avg. Share of Tick (%)</th>\n"
+    "      </tr>\n"
+    "    </thead>\n"
+    "    <tbody>\n"
+    ;
+
+    for (std::vector<FunctionTickStatistics*>::const_iterator
+         it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+      const FunctionTickStatistics *fn_stats = *it;
+      *stream()
+      << "    <tr>\n"
+      << "      <td>" << EscapeHtml(fn_stats->function()->name())
+                      << "</td>\n"
+      << "      <td class=\"numeric\">" << fn_stats->num_ticks()
+                                        << "</td>\n"
+      << "      <td class=\"numeric\">" << std::setprecision(3)
+          << Milliseconds(fn_stats->total_time()).count()
+             / fn_stats->num_ticks() << "</td>\n"
+      << "      <td class=\"numeric\">"
+          << Milliseconds(fn_stats->max_time()).count() << "</td>\n"
+      << "      <td class=\"numeric\">" << std::setprecision(2)
+          << fn_stats->average_share() * 100 << "</td>\n"
+      << "    </tr>\n";
+    }
+
+    *stream() <<
+    "    </tbody>\n"
+    "  </table>\n"
+    ;
+  }
+
+  const std::vector<Tick> &worst_ticks = ticks->worst_ticks();
+  if (!worst_ticks.empty()) {
+    *stream() <<
+    "  <br/>\n"
+    "  <table id=\"worst-ticks\" class=\"tablesorter\">\n"
+    "    <thead>\n"
+    "      <tr>\n"
+    "        <th>Date</th>\n"
+    "        <th>Tick</th>\n"
+    "        <th>Script Time (ms)</th>\n"
+    "        <th>Interval (ms)</th>\n"
+    "        <th>Top Functions</th>\n"
+    "      </tr>\n"
+    "    </thead>\n"
+    "    <tbody>\n"
+    ;
+
+    for (std::vector<Tick>::const_iterator it = worst_ticks.begin();
+         it != worst_ticks.end(); ++it) {
+      *stream()
+      << "    <tr>\n"
+      << "      <td>" << CTime(it->time_stamp()) << "</td>\n"
+      << "      <td class=\"numeric\">" << it->number() << "</td>\n"
+      << "      <td class=\"numeric\">" << std::setprecision(3)
+          << Milliseconds(it->script_time()).count() << "</td>\n"
+      << "      <td class=\"numeric\">"
+          << Milliseconds(it->interval()).count() << "</td>\n"
+      << "      <td>";
+
+      const std::vector<TickFunction> &functions = it->top_functions();
+      for (std::vector<TickFunction>::const_iterator fn_it =
+           functions.begin(); fn_it != functions.end(); ++fn_it) {
+        *stream() << std::setprecision(3)
+                  << Milliseconds(fn_it->time()).count() << " ms ("
+                  << std::setprecision(1)
+                  << fn_it->time().count() * 100
+                     / it->script_time().count()
+                  << "%): " << EscapeHtml(fn_it->function()->name())
+                  << "<br/>";
+      }
+
+      *stream() << "</td>\n"
+      << "    </tr>\n";
+    }
+
+    *stream() <<
+    "    </tbody>\n"
+    "  </table>\n"
+    ;
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterHtml::WriteTimers(const Statistics *stats) {
+  std::vector<TimerStatistics*> all_timer_stats;
+  stats->GetTimerStatistics(all_timer_stats);
+
+  if (all_timer_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"timers\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Timer</th>\n"
+  "        <th>Started From</th>\n"
+  "        <th>Interval (ms)</th>\n"
+  "        <th>Repeat</th>\n"
+  "        <th>Timers</th>\n"
+  "        <th>Fires</th>\n"
+  "        <th>Kills</th>\n"
+  "        <th>Cadence (ms)</th>\n"
+  "        <th>Late (ms)</th>\n"
+  "        <th>Max Late (ms)</th>\n"
+  "        <th>Jitter (ms)</th>\n"
+  "        <th>Time / Fire (ms)</th>\n"
+  "        <th>Same-Tick Fires</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (std::vector<TimerStatistics*>::const_iterator
+       it = all_timer_stats.begin(); it != all_timer_stats.end(); ++it) {
+    const TimerStatistics *timer_stats = *it;
+
+    double fire_time = 0;
+    if (timer_stats->num_fires() > 0) {
+      fire_time = Milliseconds(timer_stats->time()).count()
+                  / timer_stats->num_fires();
+    }
+
+    *stream() << std::setprecision(3)
+    << "    <tr>\n"
+    << "      <td>" << EscapeHtml(timer_stats->function()->name())
+                    << "</td>\n"
+    << "      <td>" << EscapeHtml(timer_stats->GetLocationString())
+                    << "</td>\n"
+    << "      <td class=\"numeric\">" << timer_stats->GetIntervalString()
+                                      << "</td>\n"
+    << "      <td>" << (timer_stats->repeating() ? "yes" : "no")
+                    << "</td>\n"
+    << "      <td class=\"numeric\">" << timer_stats->num_timers()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << timer_stats->num_fires()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << timer_stats->num_kills()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">"
+        << Milliseconds(timer_stats->average_cadence()).count()
+        << "</td>\n"
+    << "      <td class=\"numeric\">"
+        << Milliseconds(timer_stats->average_lateness()).count()
+        << "</td>\n"
+    << "      <td class=\"numeric\">"
+        << Milliseconds(timer_stats->max_lateness()).count()
+        << "</td>\n"
+    << "      <td class=\"numeric\">"
+        << Milliseconds(timer_stats->jitter()).count()
+        << "</td>\n"
+    << "      <td class=\"numeric\">" << fire_time << "</td>\n"
+    << "      <td class=\"numeric\">"
+        << timer_stats->num_overlapping_fires() << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WritePlayers(const Statistics *stats) {
+  std::vector<const PlayerStatistics*> all_player_stats;
+  stats->GetPlayerStatistics(all_player_stats);
+
+  if (all_player_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"players\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Player</th>\n"
+  "        <th>Calls</th>\n"
+  "        <th>Self Time (s)</th>\n"
+  "        <th>Total Time (s)</th>\n"
+  "        <th>Avg. Time (ms)</th>\n"
+  "        <th>Worst Time (ms)</th>\n"
+  "        <th>Worst Callback</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (std::vector<const PlayerStatistics*>::const_iterator
+       it = all_player_stats.begin(); it != all_player_stats.end(); ++it) {
+    const PlayerStatistics *player_stats = *it;
+
+    double avg_time = Milliseconds(player_stats->total_time()).count()
+                      / player_stats->num_calls();
+
+    *stream() << std::setprecision(3)
+    << "    <tr>\n"
+    << "      <td class=\"numeric\">" << player_stats->playerid()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << player_stats->num_calls()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">"
+        << Seconds(player_stats->self_time()).count() << "</td>\n"
+    << "      <td class=\"numeric\">"
+        << Seconds(player_stats->total_time()).count() << "</td>\n"
+    << "      <td class=\"numeric\">" << avg_time << "</td>\n"
+    << "      <td class=\"numeric\">"
+        << Milliseconds(player_stats->worst_time()).count() << "</td>\n"
+    << "      <td>";
+    if (player_stats->worst_function() != 0) {
+      *stream() << EscapeHtml(player_stats->worst_function()->name());
+    }
+    *stream() << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WriteMemory(const Statistics *stats) {
+  if (!stats->memory_measured()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"stack-heap\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Stack/Heap Size (bytes)</th>\n"
+  "        <th>Max Stack (bytes)</th>\n"
+  "        <th>Max Heap (bytes)</th>\n"
+  "        <th>Max Both (bytes)</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  "      <tr>\n"
+  "        <td class=\"numeric\">" << stats->stack_heap_size() << "</td>\n"
+  "        <td class=\"numeric\">" << stats->max_stack_usage() << "</td>\n"
+  "        <td class=\"numeric\">" << stats->max_heap_usage() << "</td>\n"
+  "        <td class=\"numeric\">" << stats->max_stack_heap_usage()
+                                   << "</td>\n"
+  "      </tr>\n"
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+
+  std::vector<FunctionStatistics*> all_fn_stats;
+  stats->GetMemoryStatistics(all_fn_stats);
+
+  if (all_fn_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"memory\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Type</th>\n"
+  "        <th>Name</th>\n"
+  "        <th>Calls</th>\n"
+  "        <th>Max Stack (bytes)</th>\n"
+  "        <th>Max Heap (bytes)</th>\n"
+  "        <th>Heap Growth (bytes)</th>\n"
+  "        <th>Max Recursion</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  for (std::vector<FunctionStatistics*>::const_iterator
+       it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+    const FunctionStatistics *fn_stats = *it;
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << fn_stats->function()->GetTypeString() << "</td>\n"
+    << "      <td>" << EscapeHtml(fn_stats->function()->name())
+                    << "</td>\n"
+    << "      <td class=\"numeric\">" << fn_stats->num_calls() << "</td>\n"
+    << "      <td class=\"numeric\">" << fn_stats->max_stack_usage()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << fn_stats->max_heap_usage()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << fn_stats->heap_growth()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << fn_stats->max_recursion_depth()
+                                      << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WriteRedundantCalls(const Statistics *stats) {
+  std::vector<RedundantCallStatistics*> all_call_stats;
+  stats->GetRedundantCallStatistics(all_call_stats);
+
+  if (all_call_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"redundant-calls\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Repeated Native</th>\n"
+  "        <th>Called From</th>\n"
+  "        <th>Repeats</th>\n"
+  "        <th>Of All Calls (%)</th>\n"
+  "        <th>Wasted Time (s)</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (std::vector<RedundantCallStatistics*>::const_iterator
+       it = all_call_stats.begin(); it != all_call_stats.end(); ++it) {
+    const RedundantCallStatistics *call_stats = *it;
+
+    const FunctionStatistics *fn_stats =
+      stats->GetFunctionStatistics(call_stats->native()->address());
+    double percent = 0;
+    if (fn_stats != 0 && fn_stats->num_calls() > 0) {
+      percent = 100.0 * call_stats->num_calls() / fn_stats->num_calls();
+    }
+
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << EscapeHtml(call_stats->native()->name())
+                    << "</td>\n"
+    << "      <td>" << EscapeHtml(call_stats->GetLocationString())
+                    << "</td>\n"
+    << "      <td class=\"numeric\">" << call_stats->num_calls()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(2) << percent
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(3)
+        << Seconds(call_stats->time()).count() << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
+void StatisticsWriterHtml::WriteScriptCounters(const Statistics *stats) {
+  std::vector<CounterStatistics*> all_counter_stats;
+  stats->GetCounterStatistics(all_counter_stats);
+
+  if (all_counter_stats.empty()) {
+    return;
+  }
+
+  *stream() <<
+  "  <br/>\n"
+  "  <table id=\"script-counters\" class=\"tablesorter\">\n"
+  "    <thead>\n"
+  "      <tr>\n"
+  "        <th>Counter</th>\n"
+  "        <th>Samples</th>\n"
+  "        <th>Last</th>\n"
+  "        <th>Min</th>\n"
+  "        <th>Max</th>\n"
+  "        <th>Average</th>\n"
+  "      </tr>\n"
+  "    </thead>\n"
+  "    <tbody>\n"
+  ;
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (std::vector<CounterStatistics*>::const_iterator
+       it = all_counter_stats.begin(); it != all_counter_stats.end(); ++it) {
+    const CounterStatistics *counter_stats = *it;
+    *stream()
+    << "    <tr>\n"
+    << "      <td>" << EscapeHtml(counter_stats->name()) << "</td>\n"
+    << "      <td class=\"numeric\">" << counter_stats->num_samples()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << counter_stats->last_value()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << counter_stats->min_value()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << counter_stats->max_value()
+                                      << "</td>\n"
+    << "      <td class=\"numeric\">" << std::setprecision(2)
+        << counter_stats->average_value() << "</td>\n"
+    << "    </tr>\n";
+  }
+
+  stream()->flags(flags);
+
+  *stream() <<
+  "    </tbody>\n"
+  "  </table>\n"
+  ;
+}
+
 } // namespace amxprof
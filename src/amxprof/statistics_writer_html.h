@@ -25,13 +25,34 @@
 #ifndef AMXPROF_STATISTICS_WRITER_HTML_H
 #define AMXPROF_STATISTICS_WRITER_HTML_H
 
+#include <vector>
+#include "duration.h"
 #include "statistics_writer.h"
 
 namespace amxprof {
 
+class FileStatistics;
+
 class StatisticsWriterHtml : public StatisticsWriter {
  public:
   virtual void Write(const Statistics *stats);
+ private:
+  void WriteCounters(const Statistics *stats);
+  void WriteFiles(const char *id,
+                  const char *title,
+                  const std::vector<FileStatistics*> &all_file_stats,
+                  Nanoseconds time_all);
+  void WriteLines(const Statistics *stats);
+  void WriteCallSites(const Statistics *stats);
+  void WriteCrossScriptCalls(const Statistics *stats);
+  void WritePublicCallers(const Statistics *stats);
+  void WriteSlowCalls(const Statistics *stats);
+  void WriteTicks(const Statistics *stats);
+  void WriteTimers(const Statistics *stats);
+  void WritePlayers(const Statistics *stats);
+  void WriteMemory(const Statistics *stats);
+  void WriteRedundantCalls(const Statistics *stats);
+  void WriteScriptCounters(const Statistics *stats);
 };
 
 } // namespace amxprof
@@ -23,12 +23,25 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
+#include "benchmark.h"
+#include "call_site_statistics.h"
+#include "counter_statistics.h"
+#include "cross_script_call_statistics.h"
+#include "file_statistics.h"
 #include "duration.h"
 #include "function.h"
 #include "function_statistics.h"
+#include "line_statistics.h"
+#include "perf_counters.h"
 #include "performance_counter.h"
+#include "player_statistics.h"
+#include "redundant_call_statistics.h"
+#include "public_caller_statistics.h"
+#include "slow_call_log.h"
 #include "statistics_writer_json.h"
 #include "statistics.h"
+#include "tick_statistics.h"
+#include "timer_statistics.h"
 #include "time_utils.h"
 
 namespace amxprof {
@@ -55,6 +68,38 @@ static std::string EscapString(const std::string &s) {
   return t;
 }
 
+static void WriteFiles(std::ostream *stream,
+                       const char *key,
+                       const std::vector<FileStatistics*> &all_file_stats) {
+  if (all_file_stats.empty()) {
+    return;
+  }
+
+  *stream << ",\n  \"" << key << "\": [\n";
+
+  typedef std::vector<FileStatistics*>::const_iterator FileIterator;
+
+  for (FileIterator it = all_file_stats.begin();
+       it != all_file_stats.end(); ++it) {
+    const FileStatistics *file_stats = *it;
+
+    *stream << "    {\n"
+      << "      \"name\": \""
+        << EscapString(file_stats->name()) << "\",\n"
+      << "      \"functions\": "
+        << file_stats->num_functions() << ",\n"
+      << "      \"calls\": "
+        << file_stats->num_calls() << ",\n"
+      << "      \"selfTime\": "
+        << file_stats->self_time().count() << ",\n"
+      << "      \"totalTime\": "
+        << file_stats->total_time().count() << "\n"
+    << "    },\n";
+  }
+
+  *stream << "    {}\n  ]";
+}
+
 void StatisticsWriterJson::Write(const Statistics *stats)
 {
   *stream() << "{\n"
@@ -69,6 +114,20 @@ void StatisticsWriterJson::Write(const Statistics *stats)
               << Seconds(stats->GetTotalRunTime()).count() << ",\n";
   }
 
+  if (!metadata().empty()) {
+    *stream() << "  \"meta\": {\n";
+    for (Metadata::const_iterator it = metadata().begin();
+         it != metadata().end(); ++it) {
+      *stream() << "    \"" << EscapString(it->first) << "\": \""
+                << EscapString(it->second) << "\"";
+      if (it + 1 != metadata().end()) {
+        *stream() << ",";
+      }
+      *stream() << "\n";
+    }
+    *stream() << "  },\n";
+  }
+
   *stream() << "  \"functions\": [\n";
 
   std::vector<FunctionStatistics*> all_fn_stats;
@@ -83,7 +142,7 @@ void StatisticsWriterJson::Write(const Statistics *stats)
       << "      \"type\": \""
         << fn_stats->function()->GetTypeString() << "\",\n"
       << "      \"name\": \""
-        << fn_stats->function()->name() << "\",\n"
+        << EscapString(fn_stats->function()->name()) << "\",\n"
       << "      \"calls\": "
        << fn_stats->num_calls() << ",\n"
       << "      \"selfTime\": "
@@ -93,11 +152,462 @@ void StatisticsWriterJson::Write(const Statistics *stats)
       << "      \"totalTime\": "
         << fn_stats->total_time().count() << ",\n"
       << "      \"worstTotalTime\": "
-        << fn_stats->worst_total_time().count() << "\n"
+        << fn_stats->worst_total_time().count();
+    if (stats->cpu_time_measured()) {
+      *stream() << ",\n"
+        << "      \"cpuTime\": "
+          << fn_stats->cpu_time().count() << ",\n"
+        << "      \"offCpuTime\": "
+          << fn_stats->off_cpu_time().count();
+    }
+    const PerfCounters *counters = stats->perf_counters();
+    if (counters != 0 && counters->is_open()) {
+      EventCounts counts = fn_stats->self_counts();
+      *stream() << ",\n"
+        << "      \"counters\": {";
+      for (int i = 0; i < counters->num_events(); i++) {
+        *stream() << (i > 0 ? ", " : "")
+          << "\"" << counters->event_name(i) << "\": " << counts[i];
+      }
+      *stream() << "}";
+    }
+    *stream() << "\n"
     << "    },\n";
   }
 
-  *stream() << "    {}\n  ]\n}\n";
+  *stream() << "    {}\n  ]";
+
+  std::vector<FileStatistics*> all_file_stats;
+  stats->GetFileStatistics(all_file_stats);
+  WriteFiles(stream(), "files", all_file_stats);
+
+  std::vector<FileStatistics*> all_directory_stats;
+  stats->GetDirectoryStatistics(all_directory_stats);
+  WriteFiles(stream(), "directories", all_directory_stats);
+
+  std::vector<FileStatistics*> all_module_stats;
+  stats->GetModuleStatistics(all_module_stats);
+  WriteFiles(stream(), "modules", all_module_stats);
+
+  std::vector<LineStatistics*> all_line_stats;
+  stats->GetLineStatistics(all_line_stats);
+
+  if (!all_line_stats.empty()) {
+    *stream() << ",\n  \"lines\": [\n";
+
+    typedef std::vector<LineStatistics*>::const_iterator LineIterator;
+
+    for (LineIterator it = all_line_stats.begin();
+         it != all_line_stats.end(); ++it) {
+      const LineStatistics *line_stats = *it;
+
+      *stream() << "    {\n"
+        << "      \"file\": \""
+          << EscapString(line_stats->file()) << "\",\n"
+        << "      \"line\": "
+          << line_stats->line() << ",\n"
+        << "      \"hits\": "
+          << line_stats->num_hits() << ",\n"
+        << "      \"time\": "
+          << line_stats->time().count() << "\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  std::vector<CallSiteStatistics*> all_site_stats;
+  stats->GetCallSiteStatistics(all_site_stats);
+
+  if (!all_site_stats.empty()) {
+    *stream() << ",\n  \"callSites\": [\n";
+
+    typedef std::vector<CallSiteStatistics*>::const_iterator SiteIterator;
+
+    for (SiteIterator it = all_site_stats.begin();
+         it != all_site_stats.end(); ++it) {
+      const CallSiteStatistics *site_stats = *it;
+
+      *stream() << "    {\n"
+        << "      \"function\": \""
+          << EscapString(site_stats->function()->name()) << "\",\n"
+        << "      \"address\": "
+          << site_stats->address() << ",\n"
+        << "      \"file\": \""
+          << EscapString(site_stats->file()) << "\",\n"
+        << "      \"line\": "
+          << site_stats->line() << ",\n"
+        << "      \"calls\": "
+          << site_stats->num_calls() << ",\n"
+        << "      \"time\": "
+          << site_stats->time().count() << "\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  std::vector<CrossScriptCallStatistics*> all_call_stats;
+  stats->GetCrossScriptCallStatistics(all_call_stats);
+
+  if (!all_call_stats.empty()) {
+    *stream() << ",\n  \"crossScriptCalls\": [\n";
+
+    typedef std::vector<CrossScriptCallStatistics*>::const_iterator
+      CallIterator;
+
+    for (CallIterator it = all_call_stats.begin();
+         it != all_call_stats.end(); ++it) {
+      const CrossScriptCallStatistics *call_stats = *it;
+
+      *stream() << "    {\n"
+        << "      \"callerScript\": \""
+          << EscapString(call_stats->caller_script()) << "\",\n"
+        << "      \"caller\": \""
+          << EscapString(call_stats->caller()) << "\",\n"
+        << "      \"calleeScript\": \""
+          << EscapString(call_stats->callee_script()) << "\",\n"
+        << "      \"callee\": \""
+          << EscapString(call_stats->callee()) << "\",\n"
+        << "      \"calls\": "
+          << call_stats->num_calls() << ",\n"
+        << "      \"time\": "
+          << call_stats->time().count() << "\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  std::vector<PublicCallerStatistics*> all_caller_stats;
+  stats->GetPublicCallerStatistics(all_caller_stats);
+
+  if (!all_caller_stats.empty()) {
+    *stream() << ",\n  \"publicCallers\": [\n";
+
+    typedef std::vector<PublicCallerStatistics*>::const_iterator
+      CallerIterator;
+
+    for (CallerIterator it = all_caller_stats.begin();
+         it != all_caller_stats.end(); ++it) {
+      const PublicCallerStatistics *caller_stats = *it;
+
+      *stream() << "    {\n"
+        << "      \"module\": \""
+          << EscapString(caller_stats->module()) << "\",\n"
+        << "      \"function\": \""
+          << EscapString(caller_stats->function()->name()) << "\",\n"
+        << "      \"calls\": "
+          << caller_stats->num_calls() << ",\n"
+        << "      \"time\": "
+          << caller_stats->time().count() << "\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  const SlowCallLog *slow_calls = stats->slow_calls();
+
+  if (!slow_calls->is_empty()) {
+    *stream() << ",\n  \"slowCalls\": [\n";
+
+    for (SlowCallLog::const_iterator it = slow_calls->begin();
+         it != slow_calls->end(); ++it) {
+      *stream() << "    {\n"
+        << "      \"date\": "
+          << it->time_stamp().value() << ",\n"
+        << "      \"stack\": \""
+          << EscapString(it->stack()) << "\",\n"
+        << "      \"time\": "
+          << it->time().count() << ",\n"
+        << "      \"frames\": [\n";
+
+      const std::vector<SlowCallFrame> &frames = it->frames();
+      for (std::vector<SlowCallFrame>::const_iterator frame_it =
+             frames.begin();
+           frame_it != frames.end(); ++frame_it) {
+        *stream() << "        {\"stack\": \""
+          << EscapString(frame_it->stack()) << "\", \"time\": "
+          << frame_it->time().count() << "},\n";
+      }
+
+      *stream() << "        {}\n      ]\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  const TickStatistics *ticks = stats->ticks();
+
+  if (ticks->num_ticks() > 0) {
+    *stream() << ",\n  \"ticks\": {\n"
+      << "    \"count\": " << ticks->num_ticks() << ",\n"
+      << "    \"totalScriptTime\": "
+        << ticks->total_script_time().count() << ",\n"
+      << "    \"maxScriptTime\": "
+        << ticks->max_script_time().count() << ",\n"
+      << "    \"histogram\": [\n";
+
+    // The bounds are script times in nanoseconds, the last bucket has
+    // none.
+    for (int i = 0; i < TickStatistics::kNumHistogramBuckets; i++) {
+      *stream() << "      {";
+      if (i < TickStatistics::kNumHistogramBuckets - 1) {
+        *stream() << "\"bound\": "
+          << Nanoseconds(TickStatistics::GetHistogramBound(i)).count()
+          << ", ";
+      }
+      *stream() << "\"ticks\": " << ticks->histogram_count(i) << "},\n";
+    }
+
+    *stream() << "      {}\n    ],\n"
+      << "    \"functions\": [\n";
+
+    std::vector<FunctionTickStatistics*> all_fn_stats;
+    ticks->GetFunctionStatistics(all_fn_stats);
+
+    for (std::vector<FunctionTickStatistics*>::const_iterator
+         it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+      const FunctionTickStatistics *fn_stats = *it;
+      *stream() << "      {\n"
+        << "        \"function\": \""
+          << EscapString(fn_stats->function()->name()) << "\",\n"
+        << "        \"ticks\": " << fn_stats->num_ticks() << ",\n"
+        << "        \"totalTime\": "
+          << fn_stats->total_time().count() << ",\n"
+        << "        \"maxTime\": "
+          << fn_stats->max_time().count() << ",\n"
+        << "        \"averageShare\": "
+          << fn_stats->average_share() << "\n"
+      << "      },\n";
+    }
+
+    *stream() << "      {}\n    ],\n"
+      << "    \"worstTicks\": [\n";
+
+    const std::vector<Tick> &worst_ticks = ticks->worst_ticks();
+    for (std::vector<Tick>::const_iterator it = worst_ticks.begin();
+         it != worst_ticks.end(); ++it) {
+      *stream() << "      {\n"
+        << "        \"date\": " << it->time_stamp().value() << ",\n"
+        << "        \"tick\": " << it->number() << ",\n"
+        << "        \"scriptTime\": " << it->script_time().count() << ",\n"
+        << "        \"interval\": " << it->interval().count() << ",\n"
+        << "        \"topFunctions\": [\n";
+
+      const std::vector<TickFunction> &functions = it->top_functions();
+      for (std::vector<TickFunction>::const_iterator fn_it =
+             functions.begin();
+           fn_it != functions.end(); ++fn_it) {
+        *stream() << "          {\"function\": \""
+          << EscapString(fn_it->function()->name()) << "\", \"time\": "
+          << fn_it->time().count() << "},\n";
+      }
+
+      *stream() << "          {}\n        ]\n"
+      << "      },\n";
+    }
+
+    *stream() << "      {}\n    ]\n  }";
+  }
+
+  std::vector<TimerStatistics*> all_timer_stats;
+  stats->GetTimerStatistics(all_timer_stats);
+
+  if (!all_timer_stats.empty()) {
+    *stream() << ",\n  \"timers\": [\n";
+
+    for (std::vector<TimerStatistics*>::const_iterator
+         it = all_timer_stats.begin(); it != all_timer_stats.end(); ++it) {
+      const TimerStatistics *timer_stats = *it;
+
+      *stream() << "    {\n"
+        << "      \"function\": \""
+          << EscapString(timer_stats->function()->name()) << "\",\n"
+        << "      \"file\": \""
+          << EscapString(timer_stats->file()) << "\",\n"
+        << "      \"line\": " << timer_stats->line() << ",\n"
+        << "      \"minInterval\": "
+          << timer_stats->min_interval().count() << ",\n"
+        << "      \"maxInterval\": "
+          << timer_stats->max_interval().count() << ",\n"
+        << "      \"repeating\": "
+          << (timer_stats->repeating() ? "true" : "false") << ",\n"
+        << "      \"timers\": " << timer_stats->num_timers() << ",\n"
+        << "      \"fires\": " << timer_stats->num_fires() << ",\n"
+        << "      \"kills\": " << timer_stats->num_kills() << ",\n"
+        << "      \"cadence\": "
+          << timer_stats->average_cadence().count() << ",\n"
+        << "      \"lateness\": "
+          << timer_stats->average_lateness().count() << ",\n"
+        << "      \"maxLateness\": "
+          << timer_stats->max_lateness().count() << ",\n"
+        << "      \"jitter\": "
+          << timer_stats->jitter().count() << ",\n"
+        << "      \"overlappingFires\": "
+          << timer_stats->num_overlapping_fires() << ",\n"
+        << "      \"time\": "
+          << timer_stats->time().count() << "\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  std::vector<const PlayerStatistics*> all_player_stats;
+  stats->GetPlayerStatistics(all_player_stats);
+
+  if (!all_player_stats.empty()) {
+    *stream() << ",\n  \"players\": [\n";
+
+    for (std::vector<const PlayerStatistics*>::const_iterator
+         it = all_player_stats.begin(); it != all_player_stats.end(); ++it) {
+      const PlayerStatistics *player_stats = *it;
+
+      *stream() << "    {\n"
+        << "      \"player\": " << player_stats->playerid() << ",\n"
+        << "      \"calls\": " << player_stats->num_calls() << ",\n"
+        << "      \"selfTime\": "
+          << player_stats->self_time().count() << ",\n"
+        << "      \"totalTime\": "
+          << player_stats->total_time().count() << ",\n"
+        << "      \"worstTime\": "
+          << player_stats->worst_time().count() << ",\n"
+        << "      \"worstCallback\": \"";
+      if (player_stats->worst_function() != 0) {
+        *stream() << player_stats->worst_function()->name();
+      }
+      *stream() << "\"\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  if (stats->memory_measured()) {
+    *stream() << ",\n  \"memory\": {\n"
+      << "    \"stackHeapSize\": " << stats->stack_heap_size() << ",\n"
+      << "    \"maxStack\": " << stats->max_stack_usage() << ",\n"
+      << "    \"maxHeap\": " << stats->max_heap_usage() << ",\n"
+      << "    \"maxStackHeap\": " << stats->max_stack_heap_usage() << ",\n"
+      << "    \"functions\": [\n";
+
+    std::vector<FunctionStatistics*> all_fn_stats;
+    stats->GetMemoryStatistics(all_fn_stats);
+
+    for (std::vector<FunctionStatistics*>::const_iterator
+         it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+      const FunctionStatistics *fn_stats = *it;
+
+      *stream() << "      {\n"
+        << "        \"type\": \""
+          << fn_stats->function()->GetTypeString() << "\",\n"
+        << "        \"name\": \""
+          << EscapString(fn_stats->function()->name()) << "\",\n"
+        << "        \"calls\": " << fn_stats->num_calls() << ",\n"
+        << "        \"maxStack\": " << fn_stats->max_stack_usage() << ",\n"
+        << "        \"maxHeap\": " << fn_stats->max_heap_usage() << ",\n"
+        << "        \"heapGrowth\": " << fn_stats->heap_growth() << ",\n"
+        << "        \"maxRecursion\": "
+          << fn_stats->max_recursion_depth() << "\n"
+      << "      },\n";
+    }
+
+    *stream() << "      {}\n    ]\n  }";
+  }
+
+  std::vector<RedundantCallStatistics*> all_redundant_call_stats;
+  stats->GetRedundantCallStatistics(all_redundant_call_stats);
+
+  if (!all_redundant_call_stats.empty()) {
+    *stream() << ",\n  \"redundantCalls\": [\n";
+
+    for (std::vector<RedundantCallStatistics*>::const_iterator
+         it = all_redundant_call_stats.begin();
+         it != all_redundant_call_stats.end(); ++it) {
+      const RedundantCallStatistics *call_stats = *it;
+
+      *stream() << "    {\n"
+        << "      \"native\": \""
+          << call_stats->native()->name() << "\",\n"
+        << "      \"file\": \""
+          << EscapString(call_stats->file()) << "\",\n"
+        << "      \"line\": " << call_stats->line() << ",\n"
+        << "      \"address\": " << call_stats->call_site() << ",\n"
+        << "      \"calls\": " << call_stats->num_calls() << ",\n"
+        << "      \"time\": " << call_stats->time().count() << "\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  std::vector<CounterStatistics*> all_counter_stats;
+  stats->GetCounterStatistics(all_counter_stats);
+
+  if (!all_counter_stats.empty()) {
+    *stream() << ",\n  \"counters\": [\n";
+
+    for (std::vector<CounterStatistics*>::const_iterator
+         it = all_counter_stats.begin(); it != all_counter_stats.end(); ++it) {
+      const CounterStatistics *counter_stats = *it;
+
+      *stream() << "    {\n"
+        << "      \"name\": \""
+          << EscapString(counter_stats->name()) << "\",\n"
+        << "      \"samples\": " << counter_stats->num_samples() << ",\n"
+        << "      \"last\": " << counter_stats->last_value() << ",\n"
+        << "      \"min\": " << counter_stats->min_value() << ",\n"
+        << "      \"max\": " << counter_stats->max_value() << ",\n"
+        << "      \"average\": " << counter_stats->average_value() << "\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  if (!benchmarks_.empty()) {
+    *stream() << ",\n  \"benchmarks\": [\n";
+
+    typedef std::vector<const Benchmark*>::const_iterator BenchmarkIterator;
+
+    for (BenchmarkIterator it = benchmarks_.begin();
+         it != benchmarks_.end(); ++it) {
+      const Benchmark *benchmark = *it;
+      const BenchmarkSummary &summary = benchmark->summary();
+
+      *stream() << "    {\n"
+        << "      \"name\": \""
+          << EscapString(benchmark->name()) << "\",\n"
+        << "      \"function\": \""
+          << EscapString(benchmark->function()) << "\",\n"
+        << "      \"iterations\": "
+          << benchmark->num_iterations() << ",\n"
+        << "      \"samples\": "
+          << summary.num_samples() << ",\n"
+        << "      \"outliers\": "
+          << summary.num_outliers() << ",\n"
+        << "      \"mean\": "
+          << summary.mean().count() << ",\n"
+        << "      \"median\": "
+          << summary.median().count() << ",\n"
+        << "      \"stddev\": "
+          << summary.stddev().count() << ",\n"
+        << "      \"min\": "
+          << summary.min().count() << ",\n"
+        << "      \"max\": "
+          << summary.max().count() << ",\n"
+        << "      \"ci95\": "
+          << summary.ci95().count() << "\n"
+      << "    },\n";
+    }
+
+    *stream() << "    {}\n  ]";
+  }
+
+  *stream() << "\n}\n";
 }
 
 } // namespace amxprof
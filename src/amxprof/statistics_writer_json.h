@@ -25,13 +25,24 @@
 #ifndef AMXPROF_STATISTICS_WRITER_XML_H
 #define AMXPROF_STATISTICS_WRITER_XML_H
 
+#include <vector>
 #include "statistics_writer.h"
 
 namespace amxprof {
 
+class Benchmark;
+
 class StatisticsWriterJson : public StatisticsWriter {
  public:
   virtual void Write(const Statistics *stats);
+
+  // Benchmark results are written to a separate "benchmarks" array.
+  void AddBenchmark(const Benchmark *benchmark) {
+    benchmarks_.push_back(benchmark);
+  }
+
+ private:
+  std::vector<const Benchmark*> benchmarks_;
 };
 
 } // namespace amxprof
@@ -24,12 +24,25 @@
 
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include "call_site_statistics.h"
+#include "counter_statistics.h"
+#include "cross_script_call_statistics.h"
 #include "duration.h"
+#include "file_statistics.h"
 #include "function.h"
 #include "function_statistics.h"
+#include "line_statistics.h"
+#include "perf_counters.h"
 #include "performance_counter.h"
+#include "player_statistics.h"
+#include "redundant_call_statistics.h"
+#include "public_caller_statistics.h"
+#include "slow_call_log.h"
 #include "statistics_writer_text.h"
 #include "statistics.h"
+#include "tick_statistics.h"
+#include "timer_statistics.h"
 #include "time_utils.h"
 
 static const int kTypeWidth = 7;
@@ -50,11 +63,179 @@ static const int kWidthAll = kTypeWidth + kNameWidth + kCallsWidth
 
 static const int kNumColumns = 11;
 
+static const int kOffCpuTimePercentWidth = 15;
+static const int kOffCpuTimeWidth = 15;
+
+static const int kOffCpuWidthAll = kOffCpuTimePercentWidth + kOffCpuTimeWidth;
+static const int kOffCpuNumColumns = 2;
+
+static const int kFileWidth = 32;
+static const int kLineWidth = 8;
+static const int kHitsWidth = 10;
+static const int kLineTimePercentWidth = 15;
+static const int kLineTimeWidth = 15;
+static const int kAvgLineTimeWidth = 15;
+
+static const int kLinesWidthAll = kFileWidth + kLineWidth + kHitsWidth
+  + kLineTimePercentWidth + kLineTimeWidth + kAvgLineTimeWidth;
+
+static const int kLinesNumColumns = 6;
+
+static const int kSiteFunctionWidth = 32;
+static const int kSiteLocationWidth = 40;
+static const int kSiteCallsWidth = 10;
+static const int kSiteTimePercentWidth = 15;
+static const int kSiteTimeWidth = 15;
+static const int kAvgSiteTimeWidth = 15;
+
+static const int kSitesWidthAll = kSiteFunctionWidth + kSiteLocationWidth
+  + kSiteCallsWidth + kSiteTimePercentWidth + kSiteTimeWidth
+  + kAvgSiteTimeWidth;
+
+static const int kSitesNumColumns = 6;
+
+static const int kCounterWidth = 17;
+static const int kIpcWidth = 8;
+
+static const int kCrossCallerScriptWidth = 24;
+static const int kCrossCallerWidth = 48;
+static const int kCrossCalleeScriptWidth = 24;
+static const int kCrossCalleeWidth = 32;
+static const int kCrossCallsWidth = 10;
+static const int kCrossTimeWidth = 15;
+static const int kAvgCrossTimeWidth = 15;
+
+static const int kCrossWidthAll = kCrossCallerScriptWidth + kCrossCallerWidth
+  + kCrossCalleeScriptWidth + kCrossCalleeWidth + kCrossCallsWidth
+  + kCrossTimeWidth + kAvgCrossTimeWidth;
+
+static const int kCrossNumColumns = 7;
+
+static const int kCallerModuleWidth = 32;
+static const int kCallerPublicWidth = 32;
+static const int kCallerCallsWidth = 10;
+static const int kCallerTimeWidth = 15;
+static const int kAvgCallerTimeWidth = 15;
+
+static const int kCallersWidthAll = kCallerModuleWidth + kCallerPublicWidth
+  + kCallerCallsWidth + kCallerTimeWidth + kAvgCallerTimeWidth;
+
+static const int kCallersNumColumns = 5;
+
+static const int kPlayerIdWidth = 8;
+static const int kPlayerCallsWidth = 10;
+static const int kPlayerSelfTimeWidth = 15;
+static const int kPlayerTotalTimeWidth = 15;
+static const int kAvgPlayerTimeWidth = 15;
+static const int kWorstPlayerTimeWidth = 16;
+static const int kWorstPlayerCallbackWidth = 32;
+
+static const int kPlayersWidthAll = kPlayerIdWidth + kPlayerCallsWidth
+  + kPlayerSelfTimeWidth + kPlayerTotalTimeWidth + kAvgPlayerTimeWidth
+  + kWorstPlayerTimeWidth + kWorstPlayerCallbackWidth;
+
+static const int kPlayersNumColumns = 7;
+
+static const int kMemoryCallsWidth = 10;
+static const int kMaxStackUsageWidth = 18;
+static const int kMaxHeapUsageWidth = 18;
+static const int kHeapGrowthWidth = 20;
+static const int kMaxRecursionDepthWidth = 14;
+
+static const int kMemoryWidthAll = kTypeWidth + kNameWidth
+  + kMemoryCallsWidth + kMaxStackUsageWidth + kMaxHeapUsageWidth
+  + kHeapGrowthWidth + kMaxRecursionDepthWidth;
+
+static const int kMemoryNumColumns = 7;
+
+static const int kRedundantNativeWidth = 32;
+static const int kRedundantLocationWidth = 40;
+static const int kRedundantCallsWidth = 10;
+static const int kRedundantPercentWidth = 17;
+static const int kRedundantTimeWidth = 16;
+
+static const int kRedundantWidthAll = kRedundantNativeWidth
+  + kRedundantLocationWidth + kRedundantCallsWidth + kRedundantPercentWidth
+  + kRedundantTimeWidth;
+
+static const int kRedundantNumColumns = 5;
+
+static const int kScriptCounterNameWidth = 32;
+static const int kScriptCounterSamplesWidth = 10;
+static const int kScriptCounterLastWidth = 15;
+static const int kScriptCounterMinWidth = 15;
+static const int kScriptCounterMaxWidth = 15;
+static const int kScriptCounterAverageWidth = 15;
+
+static const int kScriptCountersWidthAll = kScriptCounterNameWidth
+  + kScriptCounterSamplesWidth + kScriptCounterLastWidth
+  + kScriptCounterMinWidth + kScriptCounterMaxWidth
+  + kScriptCounterAverageWidth;
+
+static const int kScriptCountersNumColumns = 6;
+
+static const int kTimerPublicWidth = 32;
+static const int kTimerLocationWidth = 40;
+static const int kTimerIntervalWidth = 15;
+static const int kTimerRepeatWidth = 7;
+static const int kTimerTimersWidth = 10;
+static const int kTimerFiresWidth = 10;
+static const int kTimerKillsWidth = 10;
+static const int kTimerCadenceWidth = 15;
+static const int kTimerLatenessWidth = 15;
+static const int kTimerMaxLatenessWidth = 15;
+static const int kTimerJitterWidth = 15;
+static const int kTimerFireTimeWidth = 15;
+static const int kTimerOverlapWidth = 16;
+
+static const int kTimersWidthAll = kTimerPublicWidth + kTimerLocationWidth
+  + kTimerIntervalWidth + kTimerRepeatWidth + kTimerTimersWidth
+  + kTimerFiresWidth + kTimerKillsWidth + kTimerCadenceWidth
+  + kTimerLatenessWidth + kTimerMaxLatenessWidth + kTimerJitterWidth
+  + kTimerFireTimeWidth + kTimerOverlapWidth;
+
+static const int kTimersNumColumns = 13;
+
+static const int kHistogramTimeWidth = 20;
+static const int kHistogramTicksWidth = 10;
+static const int kHistogramPercentWidth = 10;
+
+static const int kHistogramWidthAll = kHistogramTimeWidth
+  + kHistogramTicksWidth + kHistogramPercentWidth;
+
+static const int kHistogramNumColumns = 3;
+
+static const int kTickFunctionWidth = 32;
+static const int kTickFunctionTicksWidth = 10;
+static const int kAvgTickTimeWidth = 20;
+static const int kMaxTickTimeWidth = 20;
+static const int kAvgTickShareWidth = 15;
+
+static const int kTickFunctionsWidthAll = kTickFunctionWidth
+  + kTickFunctionTicksWidth + kAvgTickTimeWidth + kMaxTickTimeWidth
+  + kAvgTickShareWidth;
+
+static const int kTickFunctionsNumColumns = 5;
+
+static const int kFileNameWidth = 48;
+static const int kFileFunctionsWidth = 10;
+static const int kFileCallsWidth = 10;
+static const int kFileSelfTimePercentWidth = 15;
+static const int kFileSelfTimeWidth = 15;
+static const int kFileTotalTimePercentWidth = 15;
+static const int kFileTotalTimeWidth = 15;
+
+static const int kFilesWidthAll = kFileNameWidth + kFileFunctionsWidth
+  + kFileCallsWidth + kFileSelfTimePercentWidth + kFileSelfTimeWidth
+  + kFileTotalTimePercentWidth + kFileTotalTimeWidth;
+
+static const int kFilesNumColumns = 7;
+
 namespace amxprof {
 
-void StatisticsWriterText::DoHLine() {
+void StatisticsWriterText::DoHLine(int width) {
   char fillch = stream()->fill();
-  *stream() << std::setw(kWidthAll + kNumColumns * 2 + 1)
+  *stream() << std::setw(width)
             << std::setfill('-') << "" << std::setfill(fillch) << '\n';
 }
 
@@ -67,10 +248,25 @@ void StatisticsWriterText::Write(const Statistics *stats)
   }
 
   if (print_run_time()) {
-    *stream() << " (duration: " << TimeSpan(stats->GetTotalRunTime()) << ")\n";
+    *stream() << " (duration: " << TimeSpan(stats->GetTotalRunTime()) << ")";
+  }
+
+  *stream() << "\n";
+
+  for (Metadata::const_iterator it = metadata().begin();
+       it != metadata().end(); ++it) {
+    *stream() << it->first << ": " << it->second << "\n";
+  }
+
+  // The off-CPU columns are only there if CPU time was measured.
+  bool cpu_time_measured = stats->cpu_time_measured();
+
+  int width = kWidthAll + kNumColumns * 2 + 1;
+  if (cpu_time_measured) {
+    width += kOffCpuWidthAll + kOffCpuNumColumns * 2;
   }
 
-  DoHLine();
+  DoHLine(width);
   *stream() << std::left
     << "| " << std::setw(kTypeWidth) << "Type"
     << "| " << std::setw(kNameWidth) << "Name"
@@ -82,9 +278,14 @@ void StatisticsWriterText::Write(const Statistics *stats)
     << "| " << std::setw(kTotalTimePercentWidth) << "Total Time (%)"
     << "| " << std::setw(kTotalTimeWidth) << "Total Time (s)"
     << "| " << std::setw(kAvgTotalTimeWidth) << "Avg. TT (ms)"
-    << "| " << std::setw(kWorstTotalTimeWidth) << "Worst TT (ms)"
-    << "|\n";
-  DoHLine();
+    << "| " << std::setw(kWorstTotalTimeWidth) << "Worst TT (ms)";
+  if (cpu_time_measured) {
+    *stream()
+      << "| " << std::setw(kOffCpuTimePercentWidth) << "Off-CPU (%)"
+      << "| " << std::setw(kOffCpuTimeWidth) << "Off-CPU (s)";
+  }
+  *stream() << "|\n";
+  DoHLine(width);
 
   std::vector<FunctionStatistics*> all_fn_stats;
   stats->GetStatistics(all_fn_stats);
@@ -146,9 +347,807 @@ void StatisticsWriterText::Write(const Statistics *stats)
       << "| " << std::setw(kAvgTotalTimeWidth) << std::setprecision(1)
         << avg_total_time
       << "| " << std::setw(kWorstTotalTimeWidth) << std::setprecision(1)
-        << worst_total_time
+        << worst_total_time;
+    if (cpu_time_measured) {
+      // Relative to the function's own total time: a function that
+      // mostly waits is a likely blocking call.
+      double off_cpu_time_percent = 0;
+      if (fn_stats->total_time() > Nanoseconds(0)) {
+        off_cpu_time_percent = fn_stats->off_cpu_time().count() * 100
+                             / fn_stats->total_time().count();
+      }
+      double off_cpu_time = Seconds(fn_stats->off_cpu_time()).count();
+      *stream()
+        << "| " << std::setw(kOffCpuTimePercentWidth) << std::setprecision(2)
+          << off_cpu_time_percent
+        << "| " << std::setw(kOffCpuTimeWidth) << std::setprecision(1)
+          << off_cpu_time;
+    }
+    *stream() << "|\n";
+    DoHLine(width);
+  }
+
+  stream()->flags(flags);
+
+  WriteCounters(stats);
+
+  std::vector<FileStatistics*> all_file_stats;
+  stats->GetFileStatistics(all_file_stats);
+  WriteFiles("File", all_file_stats, self_time_all);
+
+  std::vector<FileStatistics*> all_directory_stats;
+  stats->GetDirectoryStatistics(all_directory_stats);
+  WriteFiles("Directory", all_directory_stats, self_time_all);
+
+  std::vector<FileStatistics*> all_module_stats;
+  stats->GetModuleStatistics(all_module_stats);
+  WriteFiles("Module", all_module_stats, self_time_all);
+
+  WriteLines(stats);
+  WriteCallSites(stats);
+  WriteCrossScriptCalls(stats);
+  WritePublicCallers(stats);
+  WriteSlowCalls(stats);
+  WriteTicks(stats);
+  WriteTimers(stats);
+  WritePlayers(stats);
+  WriteMemory(stats);
+  WriteRedundantCalls(stats);
+  WriteScriptCounters(stats);
+}
+
+void StatisticsWriterText::WriteFiles(
+    const char *title,
+    const std::vector<FileStatistics*> &all_file_stats,
+    Nanoseconds time_all) {
+  if (all_file_stats.empty()) {
+    return;
+  }
+
+  *stream() << "\n";
+  DoHLine(kFilesWidthAll + kFilesNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kFileNameWidth) << title
+    << "| " << std::setw(kFileFunctionsWidth) << "Functions"
+    << "| " << std::setw(kFileCallsWidth) << "Calls"
+    << "| " << std::setw(kFileSelfTimePercentWidth) << "Self Time (%)"
+    << "| " << std::setw(kFileSelfTimeWidth) << "Self Time (s)"
+    << "| " << std::setw(kFileTotalTimePercentWidth) << "Total Time (%)"
+    << "| " << std::setw(kFileTotalTimeWidth) << "Total Time (s)"
+    << "|\n";
+  DoHLine(kFilesWidthAll + kFilesNumColumns * 2 + 1);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<FileStatistics*>::const_iterator FileIterator;
+
+  for (FileIterator it = all_file_stats.begin();
+       it != all_file_stats.end(); ++it) {
+    const FileStatistics *file_stats = *it;
+
+    double self_time_percent =
+      file_stats->self_time().count() * 100 / time_all.count();
+    double total_time_percent =
+      file_stats->total_time().count() * 100 / time_all.count();
+
+    *stream()
+      << "| " << std::setw(kFileNameWidth) << file_stats->name()
+      << "| " << std::setw(kFileFunctionsWidth) << file_stats->num_functions()
+      << "| " << std::setw(kFileCallsWidth) << file_stats->num_calls()
+      << "| " << std::setw(kFileSelfTimePercentWidth) << std::setprecision(2)
+        << self_time_percent
+      << "| " << std::setw(kFileSelfTimeWidth) << std::setprecision(1)
+        << Seconds(file_stats->self_time()).count()
+      << "| " << std::setw(kFileTotalTimePercentWidth) << std::setprecision(2)
+        << total_time_percent
+      << "| " << std::setw(kFileTotalTimeWidth) << std::setprecision(1)
+        << Seconds(file_stats->total_time()).count()
+      << "|\n";
+    DoHLine(kFilesWidthAll + kFilesNumColumns * 2 + 1);
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WriteLines(const Statistics *stats) {
+  std::vector<LineStatistics*> all_line_stats;
+  stats->GetLineStatistics(all_line_stats);
+
+  if (all_line_stats.empty()) {
+    return;
+  }
+
+  typedef std::vector<LineStatistics*>::const_iterator LineIterator;
+
+  Nanoseconds time_all;
+  for (LineIterator it = all_line_stats.begin();
+       it != all_line_stats.end(); ++it) {
+    time_all += (*it)->time();
+  }
+
+  *stream() << "\n";
+  DoHLine(kLinesWidthAll + kLinesNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kFileWidth) << "File"
+    << "| " << std::setw(kLineWidth) << "Line"
+    << "| " << std::setw(kHitsWidth) << "Hits"
+    << "| " << std::setw(kLineTimePercentWidth) << "Time (%)"
+    << "| " << std::setw(kLineTimeWidth) << "Time (s)"
+    << "| " << std::setw(kAvgLineTimeWidth) << "Avg. Time (ms)"
+    << "|\n";
+  DoHLine(kLinesWidthAll + kLinesNumColumns * 2 + 1);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (LineIterator it = all_line_stats.begin();
+       it != all_line_stats.end(); ++it) {
+    const LineStatistics *line_stats = *it;
+
+    double time_percent =
+      line_stats->time().count() * 100 / time_all.count();
+    double time = Seconds(line_stats->time()).count();
+    double avg_time =
+      Milliseconds(line_stats->time()).count() / line_stats->num_hits();
+
+    *stream()
+      << "| " << std::setw(kFileWidth) << line_stats->file()
+      << "| " << std::setw(kLineWidth) << line_stats->line()
+      << "| " << std::setw(kHitsWidth) << line_stats->num_hits()
+      << "| " << std::setw(kLineTimePercentWidth) << std::setprecision(2)
+        << time_percent
+      << "| " << std::setw(kLineTimeWidth) << std::setprecision(1)
+        << time
+      << "| " << std::setw(kAvgLineTimeWidth) << std::setprecision(3)
+        << avg_time
+      << "|\n";
+    DoHLine(kLinesWidthAll + kLinesNumColumns * 2 + 1);
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WriteCounters(const Statistics *stats) {
+  const PerfCounters *counters = stats->perf_counters();
+  if (counters == 0 || !counters->is_open()) {
+    return;
+  }
+
+  // Instructions per cycle only make sense for hardware events.
+  bool show_ipc = counters->is_hardware();
+
+  int width = kTypeWidth + kNameWidth + kCallsWidth
+            + counters->num_events() * kCounterWidth
+            + (3 + counters->num_events()) * 2 + 1;
+  if (show_ipc) {
+    width += kIpcWidth + 2;
+  }
+
+  *stream() << "\n";
+  DoHLine(width);
+  *stream() << std::left
+    << "| " << std::setw(kTypeWidth) << "Type"
+    << "| " << std::setw(kNameWidth) << "Name"
+    << "| " << std::setw(kCallsWidth) << "Calls";
+  for (int i = 0; i < counters->num_events(); i++) {
+    *stream() << "| " << std::setw(kCounterWidth) << counters->event_name(i);
+  }
+  if (show_ipc) {
+    *stream() << "| " << std::setw(kIpcWidth) << "IPC";
+  }
+  *stream() << "|\n";
+  DoHLine(width);
+
+  std::vector<FunctionStatistics*> all_fn_stats;
+  stats->GetStatistics(all_fn_stats);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<FunctionStatistics*>::const_iterator FuncIterator;
+
+  for (FuncIterator it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+    const FunctionStatistics *fn_stats = *it;
+    EventCounts counts = fn_stats->self_counts();
+
+    *stream()
+      << "| " << std::setw(kTypeWidth) << fn_stats->function()->GetTypeString()
+      << "| " << std::setw(kNameWidth) << fn_stats->function()->name()
+      << "| " << std::setw(kCallsWidth) << fn_stats->num_calls();
+    for (int i = 0; i < counters->num_events(); i++) {
+      *stream() << "| " << std::setw(kCounterWidth) << counts[i];
+    }
+    if (show_ipc) {
+      double ipc = 0;
+      if (counts[PerfCounters::CYCLES] != 0) {
+        ipc = static_cast<double>(counts[PerfCounters::INSTRUCTIONS])
+            / counts[PerfCounters::CYCLES];
+      }
+      *stream() << "| " << std::setw(kIpcWidth) << std::setprecision(2)
+                << ipc;
+    }
+    *stream() << "|\n";
+    DoHLine(width);
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WriteCallSites(const Statistics *stats) {
+  std::vector<CallSiteStatistics*> all_site_stats;
+  stats->GetCallSiteStatistics(all_site_stats);
+
+  if (all_site_stats.empty()) {
+    return;
+  }
+
+  *stream() << "\n";
+  DoHLine(kSitesWidthAll + kSitesNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kSiteFunctionWidth) << "Function"
+    << "| " << std::setw(kSiteLocationWidth) << "Called From"
+    << "| " << std::setw(kSiteCallsWidth) << "Calls"
+    << "| " << std::setw(kSiteTimePercentWidth) << "Time (%)"
+    << "| " << std::setw(kSiteTimeWidth) << "Time (s)"
+    << "| " << std::setw(kAvgSiteTimeWidth) << "Avg. Time (ms)"
+    << "|\n";
+  DoHLine(kSitesWidthAll + kSitesNumColumns * 2 + 1);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<CallSiteStatistics*>::const_iterator SiteIterator;
+
+  for (SiteIterator it = all_site_stats.begin();
+       it != all_site_stats.end(); ++it) {
+    const CallSiteStatistics *site_stats = *it;
+    const FunctionStatistics *fn_stats =
+      stats->GetFunctionStatistics(site_stats->function()->address());
+
+    // Percentage of the function's total time spent in calls from here.
+    double time_percent = 0;
+    if (fn_stats->total_time().count() > 0) {
+      time_percent =
+        site_stats->time().count() * 100 / fn_stats->total_time().count();
+    }
+    double time = Seconds(site_stats->time()).count();
+    double avg_time =
+      Milliseconds(site_stats->time()).count() / site_stats->num_calls();
+
+    *stream()
+      << "| " << std::setw(kSiteFunctionWidth) << site_stats->function()->name()
+      << "| " << std::setw(kSiteLocationWidth)
+        << site_stats->GetLocationString()
+      << "| " << std::setw(kSiteCallsWidth) << site_stats->num_calls()
+      << "| " << std::setw(kSiteTimePercentWidth) << std::setprecision(2)
+        << time_percent
+      << "| " << std::setw(kSiteTimeWidth) << std::setprecision(1)
+        << time
+      << "| " << std::setw(kAvgSiteTimeWidth) << std::setprecision(3)
+        << avg_time
+      << "|\n";
+    DoHLine(kSitesWidthAll + kSitesNumColumns * 2 + 1);
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WriteCrossScriptCalls(const Statistics *stats) {
+  std::vector<CrossScriptCallStatistics*> all_call_stats;
+  stats->GetCrossScriptCallStatistics(all_call_stats);
+
+  if (all_call_stats.empty()) {
+    return;
+  }
+
+  *stream() << "\n";
+  DoHLine(kCrossWidthAll + kCrossNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kCrossCallerScriptWidth) << "Caller Script"
+    << "| " << std::setw(kCrossCallerWidth) << "Caller"
+    << "| " << std::setw(kCrossCalleeScriptWidth) << "Callee Script"
+    << "| " << std::setw(kCrossCalleeWidth) << "Callee"
+    << "| " << std::setw(kCrossCallsWidth) << "Calls"
+    << "| " << std::setw(kCrossTimeWidth) << "Time (s)"
+    << "| " << std::setw(kAvgCrossTimeWidth) << "Avg. Time (ms)"
+    << "|\n";
+  DoHLine(kCrossWidthAll + kCrossNumColumns * 2 + 1);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<CrossScriptCallStatistics*>::const_iterator CallIterator;
+
+  for (CallIterator it = all_call_stats.begin();
+       it != all_call_stats.end(); ++it) {
+    const CrossScriptCallStatistics *call_stats = *it;
+
+    double time = Seconds(call_stats->time()).count();
+    double avg_time =
+      Milliseconds(call_stats->time()).count() / call_stats->num_calls();
+
+    *stream()
+      << "| " << std::setw(kCrossCallerScriptWidth)
+        << call_stats->caller_script()
+      << "| " << std::setw(kCrossCallerWidth) << call_stats->caller()
+      << "| " << std::setw(kCrossCalleeScriptWidth)
+        << call_stats->callee_script()
+      << "| " << std::setw(kCrossCalleeWidth) << call_stats->callee()
+      << "| " << std::setw(kCrossCallsWidth) << call_stats->num_calls()
+      << "| " << std::setw(kCrossTimeWidth) << std::setprecision(1)
+        << time
+      << "| " << std::setw(kAvgCrossTimeWidth) << std::setprecision(3)
+        << avg_time
+      << "|\n";
+    DoHLine(kCrossWidthAll + kCrossNumColumns * 2 + 1);
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WritePublicCallers(const Statistics *stats) {
+  std::vector<PublicCallerStatistics*> all_caller_stats;
+  stats->GetPublicCallerStatistics(all_caller_stats);
+
+  if (all_caller_stats.empty()) {
+    return;
+  }
+
+  *stream() << "\n";
+  DoHLine(kCallersWidthAll + kCallersNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kCallerModuleWidth) << "Called By"
+    << "| " << std::setw(kCallerPublicWidth) << "Public"
+    << "| " << std::setw(kCallerCallsWidth) << "Calls"
+    << "| " << std::setw(kCallerTimeWidth) << "Time (s)"
+    << "| " << std::setw(kAvgCallerTimeWidth) << "Avg. Time (ms)"
+    << "|\n";
+  DoHLine(kCallersWidthAll + kCallersNumColumns * 2 + 1);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  typedef std::vector<PublicCallerStatistics*>::const_iterator CallerIterator;
+
+  for (CallerIterator it = all_caller_stats.begin();
+       it != all_caller_stats.end(); ++it) {
+    const PublicCallerStatistics *caller_stats = *it;
+
+    double time = Seconds(caller_stats->time()).count();
+    double avg_time =
+      Milliseconds(caller_stats->time()).count() / caller_stats->num_calls();
+
+    *stream()
+      << "| " << std::setw(kCallerModuleWidth) << caller_stats->module()
+      << "| " << std::setw(kCallerPublicWidth)
+        << caller_stats->function()->name()
+      << "| " << std::setw(kCallerCallsWidth) << caller_stats->num_calls()
+      << "| " << std::setw(kCallerTimeWidth) << std::setprecision(1)
+        << time
+      << "| " << std::setw(kAvgCallerTimeWidth) << std::setprecision(3)
+        << avg_time
+      << "|\n";
+    DoHLine(kCallersWidthAll + kCallersNumColumns * 2 + 1);
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WriteSlowCalls(const Statistics *stats) {
+  const SlowCallLog *slow_calls = stats->slow_calls();
+  if (slow_calls->is_empty()) {
+    return;
+  }
+
+  *stream() << "\nSlow calls (" << slow_calls->num_calls() << " total, "
+            << "showing the last " << slow_calls->max_size() << "):\n";
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (SlowCallLog::const_iterator it = slow_calls->begin();
+       it != slow_calls->end(); ++it) {
+    *stream() << "\n" << CTime(it->time_stamp()) << "  "
+              << std::setprecision(3) << Milliseconds(it->time()).count()
+              << " ms  " << it->stack() << "\n";
+
+    const std::vector<SlowCallFrame> &frames = it->frames();
+    for (std::vector<SlowCallFrame>::const_iterator frame_it = frames.begin();
+         frame_it != frames.end(); ++frame_it) {
+      *stream() << "    " << std::setprecision(3)
+                << Milliseconds(frame_it->time()).count()
+                << " ms  " << frame_it->stack() << "\n";
+    }
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WriteTicks(const Statistics *stats) {
+  const TickStatistics *ticks = stats->ticks();
+  if (ticks->num_ticks() == 0) {
+    return;
+  }
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  *stream() << "\nTicks: " << ticks->num_ticks() << ", script time: "
+            << std::setprecision(3)
+            << Seconds(ticks->total_script_time()).count() << " s total, "
+            << Milliseconds(ticks->total_script_time()).count()
+               / ticks->num_ticks() << " ms avg, "
+            << Milliseconds(ticks->max_script_time()).count() << " ms max\n";
+
+  *stream() << "\n";
+  DoHLine(kHistogramWidthAll + kHistogramNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kHistogramTimeWidth) << "Script Time / Tick"
+    << "| " << std::setw(kHistogramTicksWidth) << "Ticks"
+    << "| " << std::setw(kHistogramPercentWidth) << "Ticks (%)"
+    << "|\n";
+  DoHLine(kHistogramWidthAll + kHistogramNumColumns * 2 + 1);
+
+  for (int i = 0; i < TickStatistics::kNumHistogramBuckets; i++) {
+    std::ostringstream bucket;
+    bucket << std::fixed << std::setprecision(2);
+    if (i < TickStatistics::kNumHistogramBuckets - 1) {
+      bucket << "< " << TickStatistics::GetHistogramBound(i).count();
+    } else {
+      bucket << ">= " << TickStatistics::GetHistogramBound(i - 1).count();
+    }
+    bucket << " ms";
+
+    long count = ticks->histogram_count(i);
+    double percent =
+      static_cast<double>(count) * 100 / ticks->num_ticks();
+
+    *stream()
+      << "| " << std::setw(kHistogramTimeWidth) << bucket.str()
+      << "| " << std::setw(kHistogramTicksWidth) << count
+      << "| " << std::setw(kHistogramPercentWidth) << std::setprecision(2)
+        << percent
+      << "|\n";
+  }
+  DoHLine(kHistogramWidthAll + kHistogramNumColumns * 2 + 1);
+
+  std::vector<FunctionTickStatistics*> all_fn_stats;
+  ticks->GetFunctionStatistics(all_fn_stats);
+
+  if (!all_fn_stats.empty()) {
+    *stream() << "\n";
+    DoHLine(kTickFunctionsWidthAll + kTickFunctionsNumColumns * 2 + 1);
+    *stream()
+      << "| " << std::setw(kTickFunctionWidth) << "Function"
+      << "| " << std::setw(kTickFunctionTicksWidth) << "Ticks"
+      << "| " << std::setw(kAvgTickTimeWidth) << "Avg. Time/Tick (ms)"
+      << "| " << std::setw(kMaxTickTimeWidth) << "Max Time/Tick (ms)"
+      << "| " << std::setw(kAvgTickShareWidth) << "Avg. Share (%)"
+      << "|\n";
+    DoHLine(kTickFunctionsWidthAll + kTickFunctionsNumColumns * 2 + 1);
+
+    for (std::vector<FunctionTickStatistics*>::const_iterator
+         it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+      const FunctionTickStatistics *fn_stats = *it;
+      *stream()
+        << "| " << std::setw(kTickFunctionWidth)
+          << fn_stats->function()->name()
+        << "| " << std::setw(kTickFunctionTicksWidth)
+          << fn_stats->num_ticks()
+        << "| " << std::setw(kAvgTickTimeWidth) << std::setprecision(3)
+          << Milliseconds(fn_stats->total_time()).count()
+             / fn_stats->num_ticks()
+        << "| " << std::setw(kMaxTickTimeWidth)
+          << Milliseconds(fn_stats->max_time()).count()
+        << "| " << std::setw(kAvgTickShareWidth) << std::setprecision(2)
+          << fn_stats->average_share() * 100
+        << "|\n";
+      DoHLine(kTickFunctionsWidthAll + kTickFunctionsNumColumns * 2 + 1);
+    }
+  }
+
+  const std::vector<Tick> &worst_ticks = ticks->worst_ticks();
+  if (!worst_ticks.empty()) {
+    *stream() << "\nWorst ticks:\n";
+
+    for (std::vector<Tick>::const_iterator it = worst_ticks.begin();
+         it != worst_ticks.end(); ++it) {
+      *stream() << "\n" << CTime(it->time_stamp()) << "  tick "
+                << it->number() << "  " << std::setprecision(3)
+                << Milliseconds(it->script_time()).count() << " ms";
+      if (it->interval() > Nanoseconds(0)) {
+        *stream() << " (interval "
+                  << Milliseconds(it->interval()).count() << " ms)";
+      }
+      *stream() << "\n";
+
+      const std::vector<TickFunction> &functions = it->top_functions();
+      for (std::vector<TickFunction>::const_iterator fn_it =
+           functions.begin(); fn_it != functions.end(); ++fn_it) {
+        *stream() << "    " << std::setprecision(3)
+                  << Milliseconds(fn_it->time()).count() << " ms  "
+                  << std::setprecision(1)
+                  << fn_it->time().count() * 100
+                     / it->script_time().count()
+                  << "%  " << fn_it->function()->name() << "\n";
+      }
+    }
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WriteTimers(const Statistics *stats) {
+  std::vector<TimerStatistics*> all_timer_stats;
+  stats->GetTimerStatistics(all_timer_stats);
+
+  if (all_timer_stats.empty()) {
+    return;
+  }
+
+  *stream() << "\n";
+  DoHLine(kTimersWidthAll + kTimersNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kTimerPublicWidth) << "Timer"
+    << "| " << std::setw(kTimerLocationWidth) << "Started From"
+    << "| " << std::setw(kTimerIntervalWidth) << "Interval (ms)"
+    << "| " << std::setw(kTimerRepeatWidth) << "Repeat"
+    << "| " << std::setw(kTimerTimersWidth) << "Timers"
+    << "| " << std::setw(kTimerFiresWidth) << "Fires"
+    << "| " << std::setw(kTimerKillsWidth) << "Kills"
+    << "| " << std::setw(kTimerCadenceWidth) << "Cadence (ms)"
+    << "| " << std::setw(kTimerLatenessWidth) << "Late (ms)"
+    << "| " << std::setw(kTimerMaxLatenessWidth) << "Max Late (ms)"
+    << "| " << std::setw(kTimerJitterWidth) << "Jitter (ms)"
+    << "| " << std::setw(kTimerFireTimeWidth) << "Time/Fire (ms)"
+    << "| " << std::setw(kTimerOverlapWidth) << "Same-Tick Fires"
+    << "|\n";
+  DoHLine(kTimersWidthAll + kTimersNumColumns * 2 + 1);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (std::vector<TimerStatistics*>::const_iterator
+       it = all_timer_stats.begin(); it != all_timer_stats.end(); ++it) {
+    const TimerStatistics *timer_stats = *it;
+
+    double fire_time = 0;
+    if (timer_stats->num_fires() > 0) {
+      fire_time = Milliseconds(timer_stats->time()).count()
+                  / timer_stats->num_fires();
+    }
+
+    *stream() << std::setprecision(3)
+      << "| " << std::setw(kTimerPublicWidth)
+        << timer_stats->function()->name()
+      << "| " << std::setw(kTimerLocationWidth)
+        << timer_stats->GetLocationString()
+      << "| " << std::setw(kTimerIntervalWidth)
+        << timer_stats->GetIntervalString()
+      << "| " << std::setw(kTimerRepeatWidth)
+        << (timer_stats->repeating() ? "yes" : "no")
+      << "| " << std::setw(kTimerTimersWidth) << timer_stats->num_timers()
+      << "| " << std::setw(kTimerFiresWidth) << timer_stats->num_fires()
+      << "| " << std::setw(kTimerKillsWidth) << timer_stats->num_kills()
+      << "| " << std::setw(kTimerCadenceWidth)
+        << Milliseconds(timer_stats->average_cadence()).count()
+      << "| " << std::setw(kTimerLatenessWidth)
+        << Milliseconds(timer_stats->average_lateness()).count()
+      << "| " << std::setw(kTimerMaxLatenessWidth)
+        << Milliseconds(timer_stats->max_lateness()).count()
+      << "| " << std::setw(kTimerJitterWidth)
+        << Milliseconds(timer_stats->jitter()).count()
+      << "| " << std::setw(kTimerFireTimeWidth) << fire_time
+      << "| " << std::setw(kTimerOverlapWidth)
+        << timer_stats->num_overlapping_fires()
+      << "|\n";
+    DoHLine(kTimersWidthAll + kTimersNumColumns * 2 + 1);
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WritePlayers(const Statistics *stats) {
+  std::vector<const PlayerStatistics*> all_player_stats;
+  stats->GetPlayerStatistics(all_player_stats);
+
+  if (all_player_stats.empty()) {
+    return;
+  }
+
+  *stream() << "\n";
+  DoHLine(kPlayersWidthAll + kPlayersNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kPlayerIdWidth) << "Player"
+    << "| " << std::setw(kPlayerCallsWidth) << "Calls"
+    << "| " << std::setw(kPlayerSelfTimeWidth) << "Self Time (s)"
+    << "| " << std::setw(kPlayerTotalTimeWidth) << "Total Time (s)"
+    << "| " << std::setw(kAvgPlayerTimeWidth) << "Avg. Time (ms)"
+    << "| " << std::setw(kWorstPlayerTimeWidth) << "Worst Time (ms)"
+    << "| " << std::setw(kWorstPlayerCallbackWidth) << "Worst Callback"
+    << "|\n";
+  DoHLine(kPlayersWidthAll + kPlayersNumColumns * 2 + 1);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (std::vector<const PlayerStatistics*>::const_iterator
+       it = all_player_stats.begin(); it != all_player_stats.end(); ++it) {
+    const PlayerStatistics *player_stats = *it;
+
+    double avg_time = Milliseconds(player_stats->total_time()).count()
+                      / player_stats->num_calls();
+
+    *stream()
+      << "| " << std::setw(kPlayerIdWidth) << player_stats->playerid()
+      << "| " << std::setw(kPlayerCallsWidth) << player_stats->num_calls()
+      << "| " << std::setw(kPlayerSelfTimeWidth) << std::setprecision(3)
+        << Seconds(player_stats->self_time()).count()
+      << "| " << std::setw(kPlayerTotalTimeWidth)
+        << Seconds(player_stats->total_time()).count()
+      << "| " << std::setw(kAvgPlayerTimeWidth) << avg_time
+      << "| " << std::setw(kWorstPlayerTimeWidth)
+        << Milliseconds(player_stats->worst_time()).count()
+      << "| " << std::setw(kWorstPlayerCallbackWidth)
+        << (player_stats->worst_function() != 0
+            ? player_stats->worst_function()->name() : std::string())
+      << "|\n";
+    DoHLine(kPlayersWidthAll + kPlayersNumColumns * 2 + 1);
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WriteMemory(const Statistics *stats) {
+  if (!stats->memory_measured()) {
+    return;
+  }
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  *stream() << "\nStack/heap size: " << stats->stack_heap_size()
+            << " bytes, max stack: " << stats->max_stack_usage()
+            << " bytes, max heap: " << stats->max_heap_usage()
+            << " bytes, max both: " << stats->max_stack_heap_usage()
+            << " bytes";
+  if (stats->stack_heap_size() > 0) {
+    *stream() << " (" << std::setprecision(2)
+              << 100.0 * stats->max_stack_heap_usage()
+                 / stats->stack_heap_size() << "%)";
+  }
+  *stream() << "\n";
+
+  stream()->flags(flags);
+
+  std::vector<FunctionStatistics*> all_fn_stats;
+  stats->GetMemoryStatistics(all_fn_stats);
+
+  if (all_fn_stats.empty()) {
+    return;
+  }
+
+  *stream() << "\n";
+  DoHLine(kMemoryWidthAll + kMemoryNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kTypeWidth) << "Type"
+    << "| " << std::setw(kNameWidth) << "Name"
+    << "| " << std::setw(kMemoryCallsWidth) << "Calls"
+    << "| " << std::setw(kMaxStackUsageWidth) << "Max Stack (bytes)"
+    << "| " << std::setw(kMaxHeapUsageWidth) << "Max Heap (bytes)"
+    << "| " << std::setw(kHeapGrowthWidth) << "Heap Growth (bytes)"
+    << "| " << std::setw(kMaxRecursionDepthWidth) << "Max Recursion"
+    << "|\n";
+  DoHLine(kMemoryWidthAll + kMemoryNumColumns * 2 + 1);
+
+  for (std::vector<FunctionStatistics*>::const_iterator
+       it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+    const FunctionStatistics *fn_stats = *it;
+    *stream()
+      << "| " << std::setw(kTypeWidth) << fn_stats->function()->GetTypeString()
+      << "| " << std::setw(kNameWidth) << fn_stats->function()->name()
+      << "| " << std::setw(kMemoryCallsWidth) << fn_stats->num_calls()
+      << "| " << std::setw(kMaxStackUsageWidth) << fn_stats->max_stack_usage()
+      << "| " << std::setw(kMaxHeapUsageWidth) << fn_stats->max_heap_usage()
+      << "| " << std::setw(kHeapGrowthWidth) << fn_stats->heap_growth()
+      << "| " << std::setw(kMaxRecursionDepthWidth)
+        << fn_stats->max_recursion_depth()
+      << "|\n";
+    DoHLine(kMemoryWidthAll + kMemoryNumColumns * 2 + 1);
+  }
+}
+
+void StatisticsWriterText::WriteRedundantCalls(const Statistics *stats) {
+  std::vector<RedundantCallStatistics*> all_call_stats;
+  stats->GetRedundantCallStatistics(all_call_stats);
+
+  if (all_call_stats.empty()) {
+    return;
+  }
+
+  *stream() << "\n";
+  DoHLine(kRedundantWidthAll + kRedundantNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kRedundantNativeWidth) << "Repeated Native"
+    << "| " << std::setw(kRedundantLocationWidth) << "Called From"
+    << "| " << std::setw(kRedundantCallsWidth) << "Repeats"
+    << "| " << std::setw(kRedundantPercentWidth) << "Of All Calls (%)"
+    << "| " << std::setw(kRedundantTimeWidth) << "Wasted Time (s)"
+    << "|\n";
+  DoHLine(kRedundantWidthAll + kRedundantNumColumns * 2 + 1);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (std::vector<RedundantCallStatistics*>::const_iterator
+       it = all_call_stats.begin(); it != all_call_stats.end(); ++it) {
+    const RedundantCallStatistics *call_stats = *it;
+
+    const FunctionStatistics *fn_stats =
+      stats->GetFunctionStatistics(call_stats->native()->address());
+    double percent = 0;
+    if (fn_stats != 0 && fn_stats->num_calls() > 0) {
+      percent = 100.0 * call_stats->num_calls() / fn_stats->num_calls();
+    }
+
+    *stream()
+      << "| " << std::setw(kRedundantNativeWidth)
+        << call_stats->native()->name()
+      << "| " << std::setw(kRedundantLocationWidth)
+        << call_stats->GetLocationString()
+      << "| " << std::setw(kRedundantCallsWidth) << call_stats->num_calls()
+      << "| " << std::setw(kRedundantPercentWidth) << std::setprecision(2)
+        << percent
+      << "| " << std::setw(kRedundantTimeWidth) << std::setprecision(3)
+        << Seconds(call_stats->time()).count()
+      << "|\n";
+    DoHLine(kRedundantWidthAll + kRedundantNumColumns * 2 + 1);
+  }
+
+  stream()->flags(flags);
+}
+
+void StatisticsWriterText::WriteScriptCounters(const Statistics *stats) {
+  std::vector<CounterStatistics*> all_counter_stats;
+  stats->GetCounterStatistics(all_counter_stats);
+
+  if (all_counter_stats.empty()) {
+    return;
+  }
+
+  *stream() << "\n";
+  DoHLine(kScriptCountersWidthAll + kScriptCountersNumColumns * 2 + 1);
+  *stream() << std::left
+    << "| " << std::setw(kScriptCounterNameWidth) << "Counter"
+    << "| " << std::setw(kScriptCounterSamplesWidth) << "Samples"
+    << "| " << std::setw(kScriptCounterLastWidth) << "Last"
+    << "| " << std::setw(kScriptCounterMinWidth) << "Min"
+    << "| " << std::setw(kScriptCounterMaxWidth) << "Max"
+    << "| " << std::setw(kScriptCounterAverageWidth) << "Average"
+    << "|\n";
+  DoHLine(kScriptCountersWidthAll + kScriptCountersNumColumns * 2 + 1);
+
+  std::ostream::fmtflags flags = stream()->flags();
+  stream()->flags(flags | std::ostream::fixed);
+
+  for (std::vector<CounterStatistics*>::const_iterator
+       it = all_counter_stats.begin(); it != all_counter_stats.end(); ++it) {
+    const CounterStatistics *counter_stats = *it;
+    *stream()
+      << "| " << std::setw(kScriptCounterNameWidth) << counter_stats->name()
+      << "| " << std::setw(kScriptCounterSamplesWidth)
+        << counter_stats->num_samples()
+      << "| " << std::setw(kScriptCounterLastWidth)
+        << counter_stats->last_value()
+      << "| " << std::setw(kScriptCounterMinWidth)
+        << counter_stats->min_value()
+      << "| " << std::setw(kScriptCounterMaxWidth)
+        << counter_stats->max_value()
+      << "| " << std::setw(kScriptCounterAverageWidth) << std::setprecision(2)
+        << counter_stats->average_value()
       << "|\n";
-    DoHLine();
+    DoHLine(kScriptCountersWidthAll + kScriptCountersNumColumns * 2 + 1);
   }
 
   stream()->flags(flags);
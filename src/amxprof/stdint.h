@@ -28,12 +28,16 @@
 #if defined __GNUC__ || (defined _MSC_VER && _MSC_VER >= 1600)
   #include <stdint.h>
   namespace amxprof {
+    using ::int32_t;
+    using ::uint32_t;
     using ::int64_t;
     using ::uint64_t;
   }
 #else
   namespace amxprof {
     #if defined _WIN32
+      typedef signed __int32 int32_t;
+      typedef unsigned __int32 uint32_t;
       typedef signed __int64 int64_t;
       typedef unsigned __int64 uint64_t;
     #endif
@@ -0,0 +1,232 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Runs fixed call sequences through the profiler with a ManualClock and
+// checks the exact times it measures and the reports it writes.
+//
+// Usage: amxprof-tests <directory with expected reports>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <amxprof/amx_utils.h>
+#include <amxprof/clock.h>
+#include <amxprof/function_statistics.h>
+#include <amxprof/profiler.h>
+#include <amxprof/statistics.h>
+#include <amxprof/statistics_writer_json.h>
+#include <amxprof/statistics_writer_text.h>
+#include "test_script.h"
+
+using namespace amxprof;
+using amxprof::tests::TestScript;
+
+namespace amxprof {
+
+// Found by argument-dependent lookup in CheckEqual().
+std::ostream &operator<<(std::ostream &stream, Nanoseconds time) {
+  return stream << time.count() << " ns";
+}
+
+std::ostream &operator<<(std::ostream &stream, Milliseconds time) {
+  return stream << time.count() << " ms";
+}
+
+} // namespace amxprof
+
+#define CHECK(x) \
+  Check((x), #x, __LINE__)
+
+#define CHECK_EQUAL(x, y) \
+  CheckEqual((x) == (y), #x, x, #y, y, __LINE__)
+
+namespace {
+
+int num_failures = 0;
+
+void Check(bool result, const char *expr, int line) {
+  if (!result) {
+    std::cout << "Line " << line << ": check failed: " << expr << std::endl;
+    num_failures++;
+  }
+}
+
+template<typename T, typename U>
+void CheckEqual(bool result,
+                const char *op1,
+                const T &op1_value,
+                const char *op2,
+                const U &op2_value,
+                int line) {
+  if (!result) {
+    std::cout << "Line " << line << ": check failed: "
+              << op1 << " `" << op1_value << "`"
+              << " = "
+              << op2 << " `" << op2_value << "`"
+              << std::endl;
+    num_failures++;
+  }
+}
+
+std::string ReadFile(const std::string &filename) {
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  std::ostringstream contents;
+  contents << stream.rdbuf();
+  return contents.str();
+}
+
+// Compares the output of the writer with the expected output in a file.
+// If they differ the actual output is written next to the test executable
+// for inspection.
+void CheckReport(StatisticsWriter *writer,
+                 const Statistics *stats,
+                 const std::string &expected_dir,
+                 const std::string &filename) {
+  std::ostringstream stream;
+  writer->set_stream(&stream);
+  writer->set_script_name("test.amx");
+  writer->Write(stats);
+
+  std::string expected = ReadFile(expected_dir + "/" + filename);
+  if (stream.str() != expected) {
+    std::ofstream actual(filename.c_str(),
+                         std::ios::out | std::ios::binary);
+    actual << stream.str();
+    std::cout << "Report differs from " << expected_dir << "/" << filename
+              << ", see " << filename << std::endl;
+    num_failures++;
+  }
+}
+
+const FunctionStatistics *GetFunctionStats(const Profiler &profiler,
+                                           Address address) {
+  return profiler.stats()->GetFunctionStatistics(address);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cout << "Usage: amxprof-tests <expected reports directory>"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string expected_dir = argv[1];
+
+  ManualClock clock;
+  TestScript script(&clock);
+  Profiler profiler(script.amx(), false, &clock);
+  script.set_profiler(&profiler);
+
+  Address f0 = script.GetFunctionAddress(0);
+  Address f1 = script.GetFunctionAddress(1);
+  Address f2 = script.GetFunctionAddress(2);
+
+  // OnTest0 -> f0 -> test_native0
+  //               -> f1 -> f1
+  script.Work(Milliseconds(10));
+  script.Call(0);
+    script.Work(Milliseconds(20));
+    script.Native(0, Milliseconds(5));
+    script.Call(1);
+      script.Work(Milliseconds(30));
+      script.Call(1);
+        script.Work(Milliseconds(40));
+      script.Return();
+      script.Work(Milliseconds(50));
+    script.Return();
+    script.Work(Milliseconds(60));
+  script.Return();
+  script.Work(Milliseconds(70));
+  int error = script.Exec(0);
+  CHECK(error == AMX_ERR_NONE);
+
+  // OnTest1 -> f2 -> f1, which fails: the profiler has to unwind both
+  // functions when the public returns.
+  script.Work(Milliseconds(100));
+  script.Call(2);
+    script.Work(Milliseconds(200));
+    script.Call(1);
+      script.Work(Milliseconds(300));
+      script.Fail();
+  error = script.Exec(1);
+  CHECK(error == AMX_ERR_GENERAL);
+  CHECK(profiler.call_stack()->is_empty());
+
+  Address on_test0 = GetPublicAddress(script.amx(), 0);
+  const FunctionStatistics *stats = GetFunctionStats(profiler, on_test0);
+  CHECK_EQUAL(stats->num_calls(), 1);
+  CHECK_EQUAL(stats->self_time(), Milliseconds(80));
+  CHECK_EQUAL(stats->total_time(), Milliseconds(285));
+  CHECK_EQUAL(stats->worst_self_time(), Milliseconds(80));
+  CHECK_EQUAL(stats->worst_total_time(), Milliseconds(285));
+
+  Address on_test1 = GetPublicAddress(script.amx(), 1);
+  stats = GetFunctionStats(profiler, on_test1);
+  CHECK_EQUAL(stats->num_calls(), 1);
+  CHECK_EQUAL(stats->self_time(), Milliseconds(100));
+  CHECK_EQUAL(stats->total_time(), Milliseconds(600));
+
+  stats = GetFunctionStats(profiler, f0);
+  CHECK_EQUAL(stats->num_calls(), 1);
+  CHECK_EQUAL(stats->self_time(), Milliseconds(80));
+  CHECK_EQUAL(stats->total_time(), Milliseconds(205));
+  CHECK_EQUAL(stats->worst_self_time(), Milliseconds(80));
+  CHECK_EQUAL(stats->worst_total_time(), Milliseconds(205));
+
+  // The recursive call is part of the outer call's total time, so f1's
+  // total time is 120 ms from OnTest0 and 300 ms from OnTest1.
+  stats = GetFunctionStats(profiler, f1);
+  CHECK_EQUAL(stats->num_calls(), 3);
+  CHECK_EQUAL(stats->self_time(), Milliseconds(420));
+  CHECK_EQUAL(stats->total_time(), Milliseconds(420));
+  CHECK_EQUAL(stats->worst_self_time(), Milliseconds(300));
+  CHECK_EQUAL(stats->worst_total_time(), Milliseconds(300));
+
+  stats = GetFunctionStats(profiler, f2);
+  CHECK_EQUAL(stats->num_calls(), 1);
+  CHECK_EQUAL(stats->self_time(), Milliseconds(200));
+  CHECK_EQUAL(stats->total_time(), Milliseconds(500));
+
+  Address native0 = GetNativeAddress(script.amx(), 0);
+  stats = GetFunctionStats(profiler, native0);
+  CHECK_EQUAL(stats->num_calls(), 1);
+  CHECK_EQUAL(stats->self_time(), Milliseconds(5));
+  CHECK_EQUAL(stats->total_time(), Milliseconds(5));
+
+  StatisticsWriterText text_writer;
+  CheckReport(&text_writer, profiler.stats(), expected_dir, "profile.txt");
+
+  StatisticsWriterJson json_writer;
+  CheckReport(&json_writer, profiler.stats(), expected_dir, "profile.json");
+
+  if (num_failures > 0) {
+    std::cout << num_failures << " checks failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "OK" << std::endl;
+  return EXIT_SUCCESS;
+}
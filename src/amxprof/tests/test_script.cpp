@@ -0,0 +1,306 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <amxprof/amx_utils.h>
+#include <amxprof/profiler.h>
+#include "test_script.h"
+
+namespace amxprof {
+namespace tests {
+
+namespace {
+
+// Size of the global variables' area at the start of the data section.
+const int kNumGlobals = 16;
+
+// Cells reserved for the stack and the heap.
+const int kStackSize = 1024;
+
+// PROC, a statement and one CALL per ordinary function.
+const int kRegionSize = (2 + 2 * TestScript::kNumFunctions) * sizeof(cell);
+
+std::string MakeName(const char *prefix, int index) {
+  char buffer[32];
+  std::sprintf(buffer, "%s%d", prefix, index);
+  return buffer;
+}
+
+} // anonymous namespace
+
+TestScript::TestScript(ManualClock *clock)
+ : profiler_(0),
+   clock_(clock)
+{
+  int num_regions = kNumPublics + kNumFunctions;
+
+  std::string names;
+  std::vector<int> name_offsets;
+
+  int publics = sizeof(AMX_HEADER);
+  int natives = publics + kNumPublics * sizeof(AMX_FUNCSTUBNT);
+  int libraries = natives + kNumNatives * sizeof(AMX_FUNCSTUBNT);
+  int nametable = libraries;
+
+  for (int i = 0; i < kNumPublics; i++) {
+    name_offsets.push_back(nametable + static_cast<int>(names.size()));
+    names.append(MakeName("OnTest", i));
+    names.push_back('\0');
+  }
+  for (int i = 0; i < kNumNatives; i++) {
+    name_offsets.push_back(nametable + static_cast<int>(names.size()));
+    names.append(MakeName("test_native", i));
+    names.push_back('\0');
+  }
+
+  int cod = (nametable + static_cast<int>(names.size()) + sizeof(cell) - 1)
+            & ~static_cast<int>(sizeof(cell) - 1);
+  // An empty region at the start so that no function has address 0 and
+  // one at the end to keep the last return address inside the code.
+  int code_size = (num_regions + 2) * kRegionSize;
+  int dat = cod + code_size;
+  int globals_size = kNumGlobals * sizeof(cell);
+  int data_size = globals_size + kStackSize * sizeof(cell);
+
+  image_.assign(dat + data_size, 0);
+
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(&image_[0]);
+  hdr->size = static_cast<int32_t>(image_.size());
+  hdr->magic = AMX_MAGIC;
+  hdr->file_version = CUR_FILE_VERSION;
+  hdr->amx_version = MIN_AMX_VERSION;
+  hdr->defsize = sizeof(AMX_FUNCSTUBNT);
+  hdr->cod = cod;
+  hdr->dat = dat;
+  hdr->hea = dat + globals_size;
+  hdr->stp = dat + data_size;
+  hdr->cip = GetRegion(0);
+  hdr->publics = publics;
+  hdr->natives = natives;
+  hdr->libraries = libraries;
+  hdr->pubvars = libraries;
+  hdr->tags = libraries;
+  hdr->nametable = nametable;
+
+  AMX_FUNCSTUBNT *public_table =
+    reinterpret_cast<AMX_FUNCSTUBNT*>(&image_[publics]);
+  for (int i = 0; i < kNumPublics; i++) {
+    public_table[i].address = GetRegion(i);
+    public_table[i].nameofs = name_offsets[i];
+  }
+
+  // Natives only need unique addresses outside of the script's code.
+  AMX_FUNCSTUBNT *native_table =
+    reinterpret_cast<AMX_FUNCSTUBNT*>(&image_[natives]);
+  for (int i = 0; i < kNumNatives; i++) {
+    native_table[i].address = code_size + i * sizeof(cell);
+    native_table[i].nameofs = name_offsets[kNumPublics + i];
+  }
+
+  std::copy(names.begin(), names.end(), image_.begin() + nametable);
+
+  // Every function can call every ordinary function. CALL targets are
+  // absolute addresses, as after relocation by the VM.
+  unsigned char *code = &image_[cod];
+  cell code_base = static_cast<cell>(reinterpret_cast<std::size_t>(code));
+
+  for (int region = 0; region < num_regions; region++) {
+    *reinterpret_cast<cell*>(code + GetRegion(region)) = OP_PROC;
+    for (int i = 0; i < kNumFunctions; i++) {
+      cell *instr = reinterpret_cast<cell*>(code + GetCallSite(region, i));
+      instr[0] = OP_CALL;
+      instr[1] = code_base + GetFunctionAddress(i);
+    }
+  }
+
+  std::memset(&amx_, 0, sizeof(amx_));
+  amx_.base = &image_[0];
+  amx_.flags = AMX_FLAG_NTVREG | AMX_FLAG_RELOC;
+  amx_.cip = hdr->cip;
+  amx_.hea = globals_size;
+  amx_.hlw = globals_size;
+  amx_.stp = data_size;
+  amx_.stk = data_size;
+  amx_.frm = 0;
+  amx_.userdata[0] = this;
+}
+
+Address TestScript::GetFunctionAddress(int function) const {
+  return GetRegion(kNumPublics + function);
+}
+
+void TestScript::Work(Nanoseconds time) {
+  AddStep(Step::WORK, 0, time);
+}
+
+void TestScript::Call(int function) {
+  assert(function >= 0 && function < kNumFunctions);
+  AddStep(Step::CALL, function, 0);
+}
+
+void TestScript::Return() {
+  AddStep(Step::RETURN, 0, 0);
+}
+
+void TestScript::Native(int native, Nanoseconds time) {
+  assert(native >= 0 && native < kNumNatives);
+  AddStep(Step::NATIVE, native, time);
+}
+
+void TestScript::Fail() {
+  AddStep(Step::FAIL, 0, 0);
+}
+
+int TestScript::Exec(int index) {
+  assert(profiler_ != 0);
+  assert(index >= 0 && index < kNumPublics);
+  cell retval;
+  int error = profiler_->ExecHook(&retval, index, ExecSteps);
+  steps_.clear();
+  return error;
+}
+
+Address TestScript::GetRegion(int region) const {
+  return (region + 1) * kRegionSize;
+}
+
+Address TestScript::GetCallSite(int region, int function) const {
+  return GetRegion(region) + (2 + 2 * function) * sizeof(cell);
+}
+
+void TestScript::AddStep(Step::Type type, int index, Nanoseconds time) {
+  Step step;
+  step.type = type;
+  step.index = index;
+  step.time = time;
+  steps_.push_back(step);
+}
+
+void TestScript::Push(cell value) {
+  amx_.stk -= sizeof(cell);
+  unsigned char *data = amx_.base + reinterpret_cast<AMX_HEADER*>(amx_.base)->dat;
+  *reinterpret_cast<cell*>(data + amx_.stk) = value;
+}
+
+cell TestScript::Pop() {
+  unsigned char *data = amx_.base + reinterpret_cast<AMX_HEADER*>(amx_.base)->dat;
+  cell value = *reinterpret_cast<cell*>(data + amx_.stk);
+  amx_.stk += sizeof(cell);
+  return value;
+}
+
+void TestScript::Break(Address cip) {
+  amx_.cip = cip;
+  profiler_->DebugHook();
+}
+
+int TestScript::RunSteps(int index) {
+  cell reset_stk = amx_.stk;
+  cell reset_frm = amx_.frm;
+
+  // See bench::SyntheticScript::Exec().
+  Push(0);
+  Push(0);
+  Push(amx_.frm);
+  amx_.frm = amx_.stk;
+  regions_.push_back(index);
+
+  for (std::vector<Step>::const_iterator step = steps_.begin();
+       step != steps_.end(); ++step) {
+    switch (step->type) {
+      case Step::WORK:
+        clock_->Advance(step->time);
+        break;
+      case Step::CALL: {
+        int region = kNumPublics + step->index;
+        Push(0);
+        Push(GetCallSite(regions_.back(), step->index) + 2 * sizeof(cell));
+        Push(amx_.frm);
+        amx_.frm = amx_.stk;
+        regions_.push_back(region);
+        Break(GetRegion(region) + sizeof(cell));
+        break;
+      }
+      case Step::RETURN: {
+        assert(regions_.size() > 1);
+        amx_.stk = amx_.frm;
+        amx_.frm = Pop();
+        Address return_address = Pop();
+        Pop();
+        regions_.pop_back();
+        // The next statement of the caller is where the profiler notices
+        // that the function has returned.
+        Break(return_address);
+        break;
+      }
+      case Step::NATIVE: {
+        cell params[1] = {0};
+        cell result = 0;
+        native_time_ = step->time;
+        profiler_->CallbackHook(step->index, &result, params, CallNative);
+        break;
+      }
+      case Step::FAIL:
+        // The VM resets the stack and returns the error.
+        amx_.stk = reset_stk;
+        amx_.frm = reset_frm;
+        regions_.clear();
+        return AMX_ERR_GENERAL;
+    }
+  }
+
+  assert(regions_.size() == 1);
+  amx_.stk = amx_.frm;
+  amx_.frm = Pop();
+  Pop();
+  Pop();
+  regions_.clear();
+  return AMX_ERR_NONE;
+}
+
+// static
+int AMXAPI TestScript::ExecSteps(AMX *amx, cell *retval, int index) {
+  TestScript *script = static_cast<TestScript*>(amx->userdata[0]);
+  *retval = 0;
+  return script->RunSteps(index);
+}
+
+// static
+int AMXAPI TestScript::CallNative(AMX *amx, cell index, cell *result,
+                                  cell *params) {
+  (void)index;
+  (void)params;
+  TestScript *script = static_cast<TestScript*>(amx->userdata[0]);
+  script->clock_->Advance(script->native_time_);
+  *result = 0;
+  return AMX_ERR_NONE;
+}
+
+} // namespace tests
+} // namespace amxprof
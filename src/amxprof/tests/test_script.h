@@ -0,0 +1,124 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_TESTS_TEST_SCRIPT_H
+#define AMXPROF_TESTS_TEST_SCRIPT_H
+
+#include <vector>
+#include <amxprof/amx_types.h>
+#include <amxprof/clock.h>
+#include <amxprof/macros.h>
+
+namespace amxprof {
+
+class Profiler;
+
+namespace tests {
+
+// An in-memory AMX image whose public functions run a list of steps
+// given by the test instead of real code. Like bench::SyntheticScript it
+// has CALL instructions at call sites and a stack, so the profiler's hooks
+// see the same frames as with the real VM; time only passes when a step
+// says so, by advancing a ManualClock.
+//
+// The script has kNumPublics publics named OnTest0, OnTest1, ...,
+// kNumFunctions ordinary functions and kNumNatives natives named
+// test_native0, test_native1, ...
+class TestScript {
+ public:
+  static const int kNumPublics = 2;
+  static const int kNumFunctions = 3;
+  static const int kNumNatives = 2;
+
+  explicit TestScript(ManualClock *clock);
+
+  AMX *amx() { return &amx_; }
+
+  // The profiler whose hooks are called. Must be set before Exec().
+  void set_profiler(Profiler *profiler) { profiler_ = profiler; }
+
+  // Address of the ordinary function with the given index.
+  Address GetFunctionAddress(int function) const;
+
+  // Steps of the next Exec(). Each step is run when the previous one has
+  // finished.
+  void Work(Nanoseconds time);
+  void Call(int function);
+  void Return();
+  void Native(int native, Nanoseconds time);
+
+  // Aborts the public with a run time error, leaving the functions that
+  // were called from it on the profiler's call stack.
+  void Fail();
+
+  // Runs the steps as the public function through Profiler::ExecHook()
+  // and clears them. Returns the error code of the call.
+  int Exec(int index);
+
+ private:
+  struct Step {
+    enum Type {
+      WORK,
+      CALL,
+      RETURN,
+      NATIVE,
+      FAIL
+    };
+    Type type;
+    int index;
+    Nanoseconds time;
+  };
+
+  Address GetRegion(int region) const;
+  Address GetCallSite(int region, int function) const;
+
+  void AddStep(Step::Type type, int index, Nanoseconds time);
+
+  void Push(cell value);
+  cell Pop();
+  void Break(Address cip);
+
+  int RunSteps(int index);
+
+  static int AMXAPI ExecSteps(AMX *amx, cell *retval, int index);
+  static int AMXAPI CallNative(AMX *amx, cell index, cell *result,
+                               cell *params);
+
+ private:
+  Profiler *profiler_;
+  ManualClock *clock_;
+  std::vector<unsigned char> image_;
+  AMX amx_;
+  std::vector<Step> steps_;
+  std::vector<int> regions_;
+  Nanoseconds native_time_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(TestScript);
+};
+
+} // namespace tests
+} // namespace amxprof
+
+#endif // !AMXPROF_TESTS_TEST_SCRIPT_H
@@ -0,0 +1,148 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include "tick_statistics.h"
+
+namespace amxprof {
+
+namespace {
+
+const double kHistogramBounds[] = {
+  0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50
+};
+
+bool CompareTickFunctions(const TickFunction &lhs, const TickFunction &rhs) {
+  return rhs.time() < lhs.time();
+}
+
+bool CompareTicks(const Tick &lhs, const Tick &rhs) {
+  return rhs.script_time() < lhs.script_time();
+}
+
+bool CompareFunctionTickStatistics(const FunctionTickStatistics *lhs,
+                                   const FunctionTickStatistics *rhs) {
+  return rhs->max_time() < lhs->max_time();
+}
+
+} // anonymous namespace
+
+void FunctionTickStatistics::AddTick(Nanoseconds time,
+                                     Nanoseconds script_time) {
+  num_ticks_++;
+  total_time_ += time;
+  if (time > max_time_) {
+    max_time_ = time;
+  }
+  if (script_time.count() > 0) {
+    total_share_ += time.count() / script_time.count();
+  }
+}
+
+TickStatistics::TickStatistics()
+ : num_ticks_(0)
+{
+  std::fill(histogram_, histogram_ + kNumHistogramBuckets, 0);
+}
+
+TickStatistics::~TickStatistics() {
+  for (FunctionStatsMap::const_iterator it = function_stats_.begin();
+       it != function_stats_.end(); ++it) {
+    delete it->second;
+  }
+}
+
+// static
+Milliseconds TickStatistics::GetHistogramBound(int bucket) {
+  if (bucket < kNumHistogramBuckets - 1) {
+    return Milliseconds(kHistogramBounds[bucket]);
+  }
+  return Milliseconds(0);
+}
+
+void TickStatistics::EndTick(Nanoseconds interval) {
+  num_ticks_++;
+  total_script_time_ += current_script_time_;
+  if (current_script_time_ > max_script_time_) {
+    max_script_time_ = current_script_time_;
+  }
+
+  int bucket = 0;
+  while (bucket < kNumHistogramBuckets - 1
+         && !(current_script_time_ < GetHistogramBound(bucket))) {
+    bucket++;
+  }
+  histogram_[bucket]++;
+
+  for (FunctionTimeMap::const_iterator it = current_functions_.begin();
+       it != current_functions_.end(); ++it) {
+    FunctionTickStatistics *&fn_stats = function_stats_[it->first];
+    if (fn_stats == 0) {
+      fn_stats = new FunctionTickStatistics(it->first);
+    }
+    fn_stats->AddTick(it->second, current_script_time_);
+  }
+
+  // Collecting the top functions is only worth it for the worst ticks.
+  if (current_script_time_ > Nanoseconds(0)
+      && (worst_ticks_.size() < kMaxWorstTicks
+          || current_script_time_ > worst_ticks_.back().script_time())) {
+    std::vector<TickFunction> top_functions;
+    for (FunctionTimeMap::const_iterator it = current_functions_.begin();
+         it != current_functions_.end(); ++it) {
+      top_functions.push_back(TickFunction(it->first, it->second));
+    }
+    std::sort(top_functions.begin(), top_functions.end(),
+              CompareTickFunctions);
+    if (top_functions.size() > kMaxTopFunctions) {
+      top_functions.resize(kMaxTopFunctions,
+                           TickFunction(0, Nanoseconds(0)));
+    }
+
+    Tick tick(num_ticks_, current_script_time_, interval, top_functions);
+    worst_ticks_.insert(std::upper_bound(worst_ticks_.begin(),
+                                         worst_ticks_.end(),
+                                         tick,
+                                         CompareTicks),
+                        tick);
+    if (worst_ticks_.size() > kMaxWorstTicks) {
+      worst_ticks_.pop_back();
+    }
+  }
+
+  current_functions_.clear();
+  current_script_time_ = Nanoseconds(0);
+}
+
+void TickStatistics::GetFunctionStatistics(
+    std::vector<FunctionTickStatistics*> &stats) const {
+  for (FunctionStatsMap::const_iterator it = function_stats_.begin();
+       it != function_stats_.end(); ++it) {
+    stats.push_back(it->second);
+  }
+  std::stable_sort(stats.begin(), stats.end(),
+                   CompareFunctionTickStatistics);
+}
+
+} // namespace amxprof
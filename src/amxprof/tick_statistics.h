@@ -0,0 +1,182 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_TICK_STATISTICS_H
+#define AMXPROF_TICK_STATISTICS_H
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include "duration.h"
+#include "time_utils.h"
+
+namespace amxprof {
+
+class Function;
+
+// Time spent in a function during a single tick.
+class TickFunction {
+ public:
+  TickFunction(Function *fn, Nanoseconds time)
+   : fn_(fn),
+     time_(time)
+  {}
+
+  Function *function() const { return fn_; }
+  Nanoseconds time() const { return time_; }
+
+ private:
+  Function *fn_;
+  Nanoseconds time_;
+};
+
+// A server tick, i.e. everything the script did between two calls to
+// the plugin's ProcessTick().
+class Tick {
+ public:
+  Tick(long number,
+       Nanoseconds script_time,
+       Nanoseconds interval,
+       const std::vector<TickFunction> &top_functions)
+   : number_(number),
+     script_time_(script_time),
+     interval_(interval),
+     top_functions_(top_functions)
+  {}
+
+  // When the tick ended.
+  TimeStamp time_stamp() const { return time_stamp_; }
+
+  // Number of the tick, counting from 1.
+  long number() const { return number_; }
+
+  // Self time of all functions called during the tick.
+  Nanoseconds script_time() const { return script_time_; }
+
+  // Time since the end of the previous tick, or zero for the first tick.
+  Nanoseconds interval() const { return interval_; }
+
+  // Functions with the highest self time in the tick, highest first.
+  const std::vector<TickFunction> &top_functions() const {
+    return top_functions_;
+  }
+
+ private:
+  TimeStamp time_stamp_;
+  long number_;
+  Nanoseconds script_time_;
+  Nanoseconds interval_;
+  std::vector<TickFunction> top_functions_;
+};
+
+// How the self time of a function is spread over the ticks it ran in.
+class FunctionTickStatistics {
+ public:
+  explicit FunctionTickStatistics(Function *fn)
+   : fn_(fn),
+     num_ticks_(0),
+     total_share_(0)
+  {}
+
+  Function *function() const { return fn_; }
+
+  // Number of ticks in which the function was called.
+  long num_ticks() const { return num_ticks_; }
+
+  Nanoseconds total_time() const { return total_time_; }
+  Nanoseconds max_time() const { return max_time_; }
+
+  // Average fraction of a tick's script time taken by the function, over
+  // the ticks it ran in.
+  double average_share() const {
+    return num_ticks_ > 0 ? total_share_ / num_ticks_ : 0;
+  }
+
+  void AddTick(Nanoseconds time, Nanoseconds script_time);
+
+ private:
+  Function *fn_;
+  long num_ticks_;
+  Nanoseconds total_time_;
+  Nanoseconds max_time_;
+  double total_share_;
+};
+
+// Splits the script's work into server ticks. The profiler adds the self
+// time of each timed call to the current tick and the tick is ended by
+// EndTick(). Ticks with untimed calls (see Sampler) are incomplete, so
+// these statistics are only accurate if all calls are timed.
+class TickStatistics {
+ public:
+  // Script time histogram buckets, see GetHistogramBound().
+  static const int kNumHistogramBuckets = 10;
+
+  // Number of the longest ticks and of their top functions to keep.
+  static const std::size_t kMaxWorstTicks = 10;
+  static const std::size_t kMaxTopFunctions = 5;
+
+  TickStatistics();
+  ~TickStatistics();
+
+  void AddTime(Function *fn, Nanoseconds time) {
+    current_functions_[fn] += time;
+    current_script_time_ += time;
+  }
+
+  void EndTick(Nanoseconds interval);
+
+  long num_ticks() const { return num_ticks_; }
+  Nanoseconds total_script_time() const { return total_script_time_; }
+  Nanoseconds max_script_time() const { return max_script_time_; }
+
+  // Upper bound of the script time in the given histogram bucket. The
+  // last bucket has no bound and collects everything above the previous
+  // one.
+  static Milliseconds GetHistogramBound(int bucket);
+  long histogram_count(int bucket) const { return histogram_[bucket]; }
+
+  // Ticks with the highest script time, highest first.
+  const std::vector<Tick> &worst_ticks() const { return worst_ticks_; }
+
+  // Sorted by the maximum time per tick from highest to lowest.
+  void GetFunctionStatistics(
+    std::vector<FunctionTickStatistics*> &stats) const;
+
+ private:
+  typedef std::map<Function*, Nanoseconds> FunctionTimeMap;
+  typedef std::map<Function*, FunctionTickStatistics*> FunctionStatsMap;
+
+  FunctionTimeMap current_functions_;
+  Nanoseconds current_script_time_;
+  long num_ticks_;
+  Nanoseconds total_script_time_;
+  Nanoseconds max_script_time_;
+  long histogram_[kNumHistogramBuckets];
+  std::vector<Tick> worst_ticks_;
+  FunctionStatsMap function_stats_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_TICK_STATISTICS_H
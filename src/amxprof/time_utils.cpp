@@ -44,8 +44,8 @@ TimeStamp::TimeStamp(std::time_t value)
 }
 
 std::string CTime(TimeStamp ts) {
-  std::time_t now = TimeStamp::Now();
-  std::string str = std::ctime(&now);
+  std::time_t value = ts.value();
+  std::string str = std::ctime(&value);
   str.erase(str.length() - 1);
   return str;
 }
@@ -0,0 +1,105 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <sstream>
+#include "timer_statistics.h"
+
+namespace amxprof {
+
+TimerStatistics::TimerStatistics(Function *function,
+                                 Address call_site,
+                                 const std::string &file,
+                                 long line)
+ : function_(function),
+   call_site_(call_site),
+   file_(file),
+   line_(line),
+   num_timers_(0),
+   repeating_(false),
+   num_kills_(0),
+   num_fires_(0),
+   total_lateness_(0),
+   total_lateness_squared_(0),
+   num_cadences_(0),
+   total_cadence_(0),
+   num_overlapping_fires_(0),
+   num_timed_fires_(0)
+{
+}
+
+std::string TimerStatistics::GetLocationString() const {
+  std::ostringstream stream;
+  if (!file_.empty()) {
+    stream << file_ << ":" << line_;
+  } else {
+    stream << "0x" << std::hex << call_site_;
+  }
+  return stream.str();
+}
+
+std::string TimerStatistics::GetIntervalString() const {
+  std::ostringstream stream;
+  stream << min_interval_.count();
+  if (max_interval_ > min_interval_) {
+    stream << "-" << max_interval_.count();
+  }
+  return stream.str();
+}
+
+void TimerStatistics::AddTimer(Milliseconds interval, bool repeating) {
+  if (num_timers_ == 0 || interval < min_interval_) {
+    min_interval_ = interval;
+  }
+  if (num_timers_ == 0 || interval > max_interval_) {
+    max_interval_ = interval;
+  }
+  repeating_ = repeating_ || repeating;
+  num_timers_++;
+}
+
+Nanoseconds TimerStatistics::jitter() const {
+  if (num_fires_ < 2) {
+    return 0;
+  }
+  double mean = total_lateness_ / num_fires_;
+  double variance = total_lateness_squared_ / num_fires_ - mean * mean;
+  return variance > 0 ? std::sqrt(variance) : 0;
+}
+
+void TimerStatistics::AddFire(Nanoseconds lateness) {
+  if (num_fires_ == 0 || lateness > max_lateness_) {
+    max_lateness_ = lateness;
+  }
+  num_fires_++;
+  total_lateness_ += lateness.count();
+  total_lateness_squared_ += lateness.count() * lateness.count();
+}
+
+void TimerStatistics::AddCadence(Nanoseconds cadence) {
+  num_cadences_++;
+  total_cadence_ += cadence.count();
+}
+
+} // namespace amxprof
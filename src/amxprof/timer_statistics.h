@@ -0,0 +1,137 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_TIMER_STATISTICS_H
+#define AMXPROF_TIMER_STATISTICS_H
+
+#include <string>
+#include "amx_types.h"
+#include "duration.h"
+
+namespace amxprof {
+
+class Function;
+
+// Timers started with SetTimer() or SetTimerEx() from a single place in
+// the code, all calling the same public function.
+class TimerStatistics {
+ public:
+  TimerStatistics(Function *function,
+                  Address call_site,
+                  const std::string &file,
+                  long line);
+
+  // The public function called by the timers.
+  Function *function() const { return function_; }
+
+  // The return address of the SetTimer() or SetTimerEx() call and its
+  // location as found in the debug info.
+  Address call_site() const { return call_site_; }
+  const std::string &file() const { return file_; }
+  long line() const { return line_; }
+
+  // Returns "file:line", or the address in hex if the location is unknown.
+  std::string GetLocationString() const;
+
+  // Number of timers started and whether any of them were repeating.
+  long num_timers() const { return num_timers_; }
+  bool repeating() const { return repeating_; }
+
+  // Shortest and longest interval the timers were started with.
+  Milliseconds min_interval() const { return min_interval_; }
+  Milliseconds max_interval() const { return max_interval_; }
+
+  // Returns the interval in milliseconds, or a range if the timers were
+  // started with different intervals.
+  std::string GetIntervalString() const;
+
+  void AddTimer(Milliseconds interval, bool repeating);
+
+  // Number of timers killed with KillTimer() before they fired (or
+  // while repeating).
+  long num_kills() const { return num_kills_; }
+  void AdjustNumKills(long delta) { num_kills_ += delta; }
+
+  // Lateness is how much later than scheduled a timer fired, jitter is
+  // its standard deviation.
+  long num_fires() const { return num_fires_; }
+  Nanoseconds average_lateness() const {
+    return num_fires_ > 0 ? total_lateness_ / num_fires_ : 0;
+  }
+  Nanoseconds max_lateness() const { return max_lateness_; }
+  Nanoseconds jitter() const;
+
+  void AddFire(Nanoseconds lateness);
+
+  // Average time between consecutive fires of the same repeating timer.
+  Nanoseconds average_cadence() const {
+    return num_cadences_ > 0 ? total_cadence_ / num_cadences_ : 0;
+  }
+  void AddCadence(Nanoseconds cadence);
+
+  // Number of fires that happened in the same server tick as at least
+  // one other timer fire.
+  long num_overlapping_fires() const { return num_overlapping_fires_; }
+  void AdjustNumOverlappingFires(long delta) {
+    num_overlapping_fires_ += delta;
+  }
+
+  // Number of fires that were timed, see FunctionStatistics.
+  long num_timed_fires() const { return num_timed_fires_; }
+  void AdjustNumTimedFires(long delta) { num_timed_fires_ += delta; }
+
+  // Time spent in the fires, extrapolated to all fires if only some of
+  // them were timed.
+  Nanoseconds time() const {
+    if (num_timed_fires_ == 0 || num_timed_fires_ == num_fires_) {
+      return time_;
+    }
+    return time_.count() * num_fires_ / num_timed_fires_;
+  }
+  void AdjustTime(Nanoseconds delta) { time_ += delta; }
+
+ private:
+  Function *function_;
+  Address call_site_;
+  std::string file_;
+  long line_;
+  long num_timers_;
+  bool repeating_;
+  Milliseconds min_interval_;
+  Milliseconds max_interval_;
+  long num_kills_;
+  long num_fires_;
+  double total_lateness_;
+  double total_lateness_squared_;
+  Nanoseconds max_lateness_;
+  long num_cadences_;
+  double total_cadence_;
+  long num_overlapping_fires_;
+  long num_timed_fires_;
+  Nanoseconds time_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_TIMER_STATISTICS_H
@@ -0,0 +1,109 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <climits>
+#include "timer_statistics.h"
+#include "timer_tracker.h"
+
+namespace amxprof {
+
+void TimerTracker::AddTimer(cell id,
+                            Function *fn,
+                            TimerStatistics *stats,
+                            Milliseconds interval,
+                            bool repeating,
+                            TimePoint now) {
+  // Timer IDs are not reused by the server, but the script may have
+  // missed a fire that would have removed an old one-shot timer.
+  KillTimer(id);
+
+  Timer timer;
+  timer.stats = stats;
+  timer.interval = interval;
+  timer.repeating = repeating;
+  timer.fired = false;
+  timer.due = now + timer.interval;
+  timers_[std::make_pair(fn, id)] = timer;
+  timer_functions_[id] = fn;
+}
+
+void TimerTracker::KillTimer(cell id) {
+  IdToFunctionMap::iterator fn_it = timer_functions_.find(id);
+  if (fn_it == timer_functions_.end()) {
+    return;
+  }
+  TimerMap::iterator it = timers_.find(std::make_pair(fn_it->second, id));
+  if (it != timers_.end()) {
+    it->second.stats->AdjustNumKills(1);
+    timers_.erase(it);
+  }
+  timer_functions_.erase(fn_it);
+}
+
+TimerStatistics *TimerTracker::FireTimer(Function *fn, TimePoint now) {
+  TimerMap::iterator first =
+    timers_.lower_bound(std::make_pair(fn, static_cast<cell>(INT_MIN)));
+  TimerMap::iterator fired = timers_.end();
+
+  for (TimerMap::iterator it = first;
+       it != timers_.end() && it->first.first == fn; ++it) {
+    if (fired == timers_.end()
+        || it->second.due - fired->second.due < Nanoseconds(0)) {
+      fired = it;
+    }
+  }
+  if (fired == timers_.end()) {
+    return 0;
+  }
+
+  Timer &timer = fired->second;
+  TimerStatistics *stats = timer.stats;
+  stats->AddFire(now - timer.due);
+  if (timer.fired) {
+    stats->AddCadence(now - timer.last_fire);
+  }
+  tick_fires_.push_back(stats);
+
+  if (timer.repeating) {
+    timer.fired = true;
+    timer.last_fire = now;
+    timer.due = now + timer.interval;
+  } else {
+    timer_functions_.erase(fired->first.second);
+    timers_.erase(fired);
+  }
+  return stats;
+}
+
+void TimerTracker::EndTick() {
+  if (tick_fires_.size() > 1) {
+    for (std::vector<TimerStatistics*>::const_iterator it =
+         tick_fires_.begin(); it != tick_fires_.end(); ++it) {
+      (*it)->AdjustNumOverlappingFires(1);
+    }
+  }
+  tick_fires_.clear();
+}
+
+} // namespace amxprof
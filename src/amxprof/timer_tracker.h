@@ -0,0 +1,87 @@
+// Copyright (c) 2018 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_TIMER_TRACKER_H
+#define AMXPROF_TIMER_TRACKER_H
+
+#include <map>
+#include <utility>
+#include <vector>
+#include "amx_types.h"
+#include "clock.h"
+#include "duration.h"
+
+namespace amxprof {
+
+class Function;
+class TimerStatistics;
+
+// Follows the timers started by a script to tell which of them fired when
+// the server calls one of their public functions, and updates their
+// statistics accordingly.
+class TimerTracker {
+ public:
+  // Called after SetTimer() or SetTimerEx() returned the timer's ID.
+  void AddTimer(cell id,
+                Function *fn,
+                TimerStatistics *stats,
+                Milliseconds interval,
+                bool repeating,
+                TimePoint now);
+
+  // Called on KillTimer(). Timers that were not started by the script or
+  // have already fired are ignored.
+  void KillTimer(cell id);
+
+  // Matches a call to a public function made by the server with a timer.
+  // If there are several timers calling the function, the one that was
+  // due first is assumed to have fired. Returns the timer's statistics or
+  // null if no timer calls the function.
+  TimerStatistics *FireTimer(Function *fn, TimePoint now);
+
+  // Counts the fires since the previous call as overlapping if there
+  // were more than one.
+  void EndTick();
+
+ private:
+  struct Timer {
+    TimerStatistics *stats;
+    Nanoseconds interval;
+    bool repeating;
+    bool fired;
+    TimePoint due;
+    TimePoint last_fire;
+  };
+
+  typedef std::map<std::pair<Function*, cell>, Timer> TimerMap;
+  typedef std::map<cell, Function*> IdToFunctionMap;
+
+  TimerMap timers_;
+  IdToFunctionMap timer_functions_;
+  std::vector<TimerStatistics*> tick_fires_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_TIMER_TRACKER_H
@@ -22,6 +22,8 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <string>
+#include <amxprof/amx_utils.h>
 #include "natives.h"
 #include "profilerhandler.h"
 
@@ -43,11 +45,65 @@ cell AMX_NATIVE_CALL Profiler_Dump(AMX *amx, cell *params) {
   return ProfilerHandler::GetHandler(amx)->Dump();
 }
 
+cell AMX_NATIVE_CALL Profiler_Trigger(AMX *amx, cell *params) {
+  ProfilerHandler::TriggerFlightRecorders();
+  return 1;
+}
+
+// native Profiler_Zone(const name[]);
+cell AMX_NATIVE_CALL Profiler_Zone(AMX *amx, cell *params) {
+  std::string name = amxprof::GetAmxString(amx, params[1]);
+  return ProfilerHandler::GetHandler(amx)->GetZoneId(name);
+}
+
+// native Profiler_BeginZone(zone);
+cell AMX_NATIVE_CALL Profiler_BeginZone(AMX *amx, cell *params) {
+  return ProfilerHandler::GetHandler(amx)->BeginZone(params[1]);
+}
+
+// native Profiler_EndZone();
+cell AMX_NATIVE_CALL Profiler_EndZone(AMX *amx, cell *params) {
+  return ProfilerHandler::GetHandler(amx)->EndZone();
+}
+
+// native Profiler_Counter(const name[]);
+cell AMX_NATIVE_CALL Profiler_Counter(AMX *amx, cell *params) {
+  std::string name = amxprof::GetAmxString(amx, params[1]);
+  return ProfilerHandler::GetHandler(amx)->GetCounterId(name);
+}
+
+// native Profiler_SetCounter(counter, value);
+cell AMX_NATIVE_CALL Profiler_SetCounter(AMX *amx, cell *params) {
+  return ProfilerHandler::GetHandler(amx)->SetCounter(params[1], params[2]);
+}
+
+// native Benchmark_Register(const name[], const function[]);
+cell AMX_NATIVE_CALL Benchmark_Register(AMX *amx, cell *params) {
+  std::string name = amxprof::GetAmxString(amx, params[1]);
+  std::string function = amxprof::GetAmxString(amx, params[2]);
+  return ProfilerHandler::GetHandler(amx)->RegisterBenchmark(name, function);
+}
+
+// native Benchmark_Run(samples = 30, iterations = 0, warmup = 100);
+cell AMX_NATIVE_CALL Benchmark_Run(AMX *amx, cell *params) {
+  return ProfilerHandler::GetHandler(amx)->RunBenchmarks(params[1],
+                                                         params[2],
+                                                         params[3]);
+}
+
 const AMX_NATIVE_INFO natives[] = {
-  { "Profiler_GetState", Profiler_GetState },
-  { "Profiler_Start",    Profiler_Start },
-  { "Profiler_Stop",     Profiler_Stop },
-  { "Profiler_Dump",     Profiler_Dump }
+  { "Profiler_GetState",   Profiler_GetState },
+  { "Profiler_Start",      Profiler_Start },
+  { "Profiler_Stop",       Profiler_Stop },
+  { "Profiler_Dump",       Profiler_Dump },
+  { "Profiler_Trigger",    Profiler_Trigger },
+  { "Profiler_Zone",       Profiler_Zone },
+  { "Profiler_BeginZone",  Profiler_BeginZone },
+  { "Profiler_EndZone",    Profiler_EndZone },
+  { "Profiler_Counter",    Profiler_Counter },
+  { "Profiler_SetCounter", Profiler_SetCounter },
+  { "Benchmark_Register", Benchmark_Register },
+  { "Benchmark_Run",      Benchmark_Run }
 };
 
 } // anonymous namespace
@@ -31,6 +31,13 @@
 #else
   #include <stdio.h>
 #endif
+#ifdef _MSC_VER
+  #include <intrin.h>
+  #pragma intrinsic(_ReturnAddress)
+  #define RETURN_ADDRESS() _ReturnAddress()
+#else
+  #define RETURN_ADDRESS() __builtin_return_address(0)
+#endif
 #include "amxpathfinder.h"
 #include "fileutils.h"
 #include "logprintf.h"
@@ -98,26 +105,16 @@ AMXPathFinder amx_path_finder;
   }
 #endif
 
-int AMXAPI amx_Debug_Profiler(AMX *amx) {
-  ProfilerHandler *profiler = ProfilerHandler::GetHandler(amx);
-  return profiler->Debug();
-}
-
-int AMXAPI amx_Callback_Profiler(AMX *amx,
-                                        cell index,
-                                        cell *result,
-                                        cell *params) {
-  ProfilerHandler *profiler = ProfilerHandler::GetHandler(amx);
-  return profiler->Callback(index, result, params);
-}
-
 int AMXAPI amx_Exec_Profiler(AMX *amx, cell *retval, int index) {
   if (amx->flags & AMX_FLAG_BROWSE) {
     // Not an actual exec, just some internal AMX hack.
     return amx_Exec(amx, retval, index);
   } else {
+    // The hook is entered with a jump from amx_Exec(), so this is where
+    // in the server or a plugin amx_Exec() was called from.
+    const void *return_address = RETURN_ADDRESS();
     ProfilerHandler *profiler = ProfilerHandler::GetHandler(amx);
-    return profiler->Exec(retval, index);
+    return profiler->Exec(retval, index, return_address);
   }
 }
 
@@ -128,7 +125,7 @@ void *AMXAPI amx_Align_Profiler(void *v) {
 } // anonymous namespace
 
 PLUGIN_EXPORT unsigned int PLUGIN_CALL Supports() {
-  return SUPPORTS_VERSION | SUPPORTS_AMX_NATIVES;
+  return SUPPORTS_VERSION | SUPPORTS_AMX_NATIVES | SUPPORTS_PROCESS_TICK;
 }
 
 PLUGIN_EXPORT bool PLUGIN_CALL Load(void **ppData) {
@@ -183,18 +180,20 @@ PLUGIN_EXPORT int PLUGIN_CALL AmxLoad(AMX *amx) {
 
   if (profiler->GetState() > PROFILER_DISABLED) {
     profiler->Start();
-
-    amx_SetDebugHook(amx, amx_Debug_Profiler);
-    amx_SetCallback(amx, amx_Callback_Profiler);
-
-    // This should stop the VM from replacing SYSREQ.C instructions with
-    // SYSREQ.D and allow us to profile native functions.
-    amx->sysreq_d = 0;
   }
 
   return RegisterNatives(amx);
 }
 
+PLUGIN_EXPORT void PLUGIN_CALL ProcessTick() {
+  const ProfilerHandler::HandlerMap &handlers =
+    ProfilerHandler::GetHandlers();
+  for (ProfilerHandler::HandlerMap::const_iterator it = handlers.begin();
+       it != handlers.end(); ++it) {
+    it->second->ProcessTick();
+  }
+}
+
 PLUGIN_EXPORT int PLUGIN_CALL AmxUnload(AMX *amx) {
   ProfilerHandler *profiler = ProfilerHandler::GetHandler(amx);
 
@@ -48,6 +48,7 @@ enum SUPPORTS_FLAGS
 	SUPPORTS_VERSION		= SAMP_PLUGIN_VERSION,
 	SUPPORTS_VERSION_MASK	= 0xffff,
 	SUPPORTS_AMX_NATIVES	= 0x10000,
+	SUPPORTS_PROCESS_TICK	= 0x20000,
 };
 
 //----------------------------------------------------------
@@ -24,9 +24,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <csignal>
 #include <cstdarg>
+#include <cstdlib>
 #include <exception>
 #include <fstream>
+#include <iomanip>
 #include <iterator>
 #include <sstream>
 #include <string>
@@ -34,6 +37,8 @@
 #include <amxprof/call_graph_writer_dot.h>
 #include <amxprof/function.h>
 #include <amxprof/function_statistics.h>
+#include <amxprof/statistics.h>
+#include <amxprof/statistics_writer_gprof.h>
 #include <amxprof/statistics_writer_html.h>
 #include <amxprof/statistics_writer_json.h>
 #include <amxprof/statistics_writer_text.h>
@@ -60,6 +65,48 @@ bool call_graph =
     server_cfg.GetValueWithDefault("profiler_callgraph", false);
 std::string call_graph_format =
     server_cfg.GetValueWithDefault("profiler_callgraphformat", "dot");
+std::string call_graph_threshold =
+    server_cfg.GetValueWithDefault("profiler_callgraph_threshold");
+std::string level =
+    server_cfg.GetValueWithDefault("profiler_level", "functions");
+int sample_rate =
+    server_cfg.GetValueWithDefault("profiler_sample_rate", 1);
+std::string max_overhead =
+    server_cfg.GetValueWithDefault("profiler_max_overhead");
+bool compensate_overhead =
+    server_cfg.GetValueWithDefault("profiler_compensate_overhead", true);
+std::string clock =
+    server_cfg.GetValueWithDefault("profiler_clock", "system");
+bool call_sites =
+    server_cfg.GetValueWithDefault("profiler_call_sites", true);
+bool cpu_time =
+    server_cfg.GetValueWithDefault("profiler_cpu_time", false);
+bool perf_counters =
+    server_cfg.GetValueWithDefault("profiler_perf_counters", false);
+int slow_threshold_ms =
+    server_cfg.GetValueWithDefault("profiler_slow_threshold_ms", 0);
+bool ticks =
+    server_cfg.GetValueWithDefault("profiler_ticks", false);
+bool timers =
+    server_cfg.GetValueWithDefault("profiler_timers", false);
+bool player_stats =
+    server_cfg.GetValueWithDefault("profiler_player_stats", false);
+std::vector<std::string> player_callbacks =
+    server_cfg.GetValues<std::string>("profiler_player_callbacks");
+bool redundant_calls =
+    server_cfg.GetValueWithDefault("profiler_redundant_calls", false);
+bool memory =
+    server_cfg.GetValueWithDefault("profiler_memory", false);
+bool flight_recorder =
+    server_cfg.GetValueWithDefault("profiler_flight_recorder", false);
+int flight_recorder_events =
+    server_cfg.GetValueWithDefault("profiler_flight_recorder_events", 1000000);
+int flight_recorder_seconds =
+    server_cfg.GetValueWithDefault("profiler_flight_recorder_seconds", 10);
+int flight_recorder_tick_ms =
+    server_cfg.GetValueWithDefault("profiler_flight_recorder_tick_ms", 0);
+bool record_natives =
+    server_cfg.GetValueWithDefault("profiler_record_natives", false);
 
 namespace old {
 
@@ -98,6 +145,60 @@ bool IsCallGraphEnabled() {
   return cfg::call_graph || cfg::old::call_graph;
 }
 
+// The gprof output format is made from the call graph, so it has to be
+// collected even if it's not written separately.
+bool IsCallGraphNeeded() {
+  return IsCallGraphEnabled()
+      || stringutils::CompareIgnoreCase(cfg::output_format, "gprof") == 0;
+}
+
+bool IsTscClockEnabled() {
+  return stringutils::CompareIgnoreCase(cfg::clock, "tsc") == 0;
+}
+
+// All scripts share the same clock so that their times can be compared.
+amxprof::Clock *GetClock() {
+  if (IsTscClockEnabled()) {
+    static amxprof::TscClock tsc_clock;
+    return &tsc_clock;
+  }
+  return amxprof::SystemClock::GetInstance();
+}
+
+// Callbacks whose first parameter is a player ID, used for per-player
+// statistics unless profiler_player_callbacks is set.
+std::vector<std::string> GetPlayerCallbacks() {
+  static const char *const default_callbacks[] = {
+    "OnPlayerConnect",
+    "OnPlayerDisconnect",
+    "OnPlayerSpawn",
+    "OnPlayerDeath",
+    "OnPlayerText",
+    "OnPlayerCommandText",
+    "OnPlayerRequestClass",
+    "OnPlayerStateChange",
+    "OnPlayerKeyStateChange",
+    "OnPlayerUpdate",
+    "OnPlayerEnterCheckpoint",
+    "OnPlayerEnterRaceCheckpoint",
+    "OnPlayerPickUpPickup",
+    "OnPlayerStreamIn",
+    "OnPlayerTakeDamage",
+    "OnPlayerGiveDamage",
+    "OnPlayerWeaponShot",
+    "OnPlayerClickMap",
+    "OnPlayerClickTextDraw",
+    "OnPlayerClickPlayerTextDraw",
+    "OnDialogResponse"
+  };
+  if (!cfg::player_callbacks.empty()) {
+    return cfg::player_callbacks;
+  }
+  return std::vector<std::string>(
+    default_callbacks,
+    default_callbacks + sizeof(default_callbacks) / sizeof(*default_callbacks));
+}
+
 bool IsGameMode(const std::string &amx_path) {
   return amx_path.find("gamemodes/") != std::string::npos;
 }
@@ -106,7 +207,29 @@ bool IsFilterScript(const std::string &amx_path) {
   return amx_path.find("filterscripts/") != std::string::npos;
 }
 
-bool ShouldBeProfiled(const std::string amx_path) {
+// Checks if a "name[:level]" entry from profiler_gamemodes or
+// profiler_filterscripts refers to the specified AMX file. If it does and
+// the entry includes a level, the level is stored in the last argument.
+bool MatchScript(const std::string &amx_path,
+                 const std::string &directory,
+                 const std::string &entry,
+                 std::string &level) {
+  std::string name = entry;
+  std::string::size_type colon = entry.find(':');
+  if (colon != std::string::npos) {
+    name = entry.substr(0, colon);
+  }
+  if (fileutils::SameFile(amx_path, directory + name + ".amx") ||
+      fileutils::SameFile(amx_path, directory + name)) {
+    if (colon != std::string::npos) {
+      level = entry.substr(colon + 1);
+    }
+    return true;
+  }
+  return false;
+}
+
+bool ShouldBeProfiled(const std::string amx_path, std::string &level) {
   if (IsGameMode(amx_path)) {
     if (cfg::old::profile_gamemode) {
       return true;
@@ -115,9 +238,7 @@ bool ShouldBeProfiled(const std::string amx_path) {
     stringutils::SplitString(cfg::gamemodes, ' ', gm_names);
     for (std::vector<std::string>::const_iterator iterator = gm_names.begin();
          iterator != gm_names.end(); ++iterator) {
-      const std::string &gm_name = *iterator;
-      if (fileutils::SameFile(amx_path, "gamemodes/" + gm_name + ".amx") ||
-          fileutils::SameFile(amx_path, "gamemodes/" + gm_name)) {
+      if (MatchScript(amx_path, "gamemodes/", *iterator, level)) {
         return true;
       }
     }
@@ -132,9 +253,7 @@ bool ShouldBeProfiled(const std::string amx_path) {
               std::back_inserter(fs_names));
     for (std::vector<std::string>::const_iterator iterator = fs_names.begin();
          iterator != fs_names.end(); ++iterator) {
-      const std::string &fs_name = *iterator;
-      if (fileutils::SameFile(amx_path, "filterscripts/" + fs_name + ".amx") ||
-          fileutils::SameFile(amx_path, "filterscripts/" + fs_name)) {
+      if (MatchScript(amx_path, "filterscripts/", *iterator, level)) {
         return true;
       }
     }
@@ -142,14 +261,72 @@ bool ShouldBeProfiled(const std::string amx_path) {
   return false;
 }
 
+bool ParseLevel(const std::string &name, ProfilerLevel &level) {
+  static const struct {
+    const char *name;
+    ProfilerLevel level;
+  } levels[] = {
+    {"publics",   PROFILER_LEVEL_PUBLICS},
+    {"natives",   PROFILER_LEVEL_NATIVES},
+    {"functions", PROFILER_LEVEL_FUNCTIONS},
+    {"lines",     PROFILER_LEVEL_LINES}
+  };
+  for (std::size_t i = 0; i < sizeof(levels) / sizeof(*levels); i++) {
+    if (stringutils::CompareIgnoreCase(name, levels[i].name) == 0) {
+      level = levels[i].level;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Incremented on each flight recorder trigger, scripts compare it with
+// the number of triggers they have already handled.
+volatile std::sig_atomic_t num_flight_recorder_triggers = 0;
+
+#ifdef SIGUSR2
+  void HandleTriggerSignal(int) {
+    ProfilerHandler::TriggerFlightRecorders();
+  }
+#endif
+
+void InstallTriggerSignalHandler() {
+  #ifdef SIGUSR2
+    static bool installed = false;
+    if (!installed) {
+      std::signal(SIGUSR2, HandleTriggerSignal);
+      installed = true;
+    }
+  #endif
+}
+
+int AMXAPI amx_Debug_Profiler(AMX *amx) {
+  ProfilerHandler *profiler = ProfilerHandler::GetHandler(amx);
+  return profiler->Debug();
+}
+
+int AMXAPI amx_Callback_Profiler(AMX *amx,
+                                 cell index,
+                                 cell *result,
+                                 cell *params) {
+  ProfilerHandler *profiler = ProfilerHandler::GetHandler(amx);
+  return profiler->Callback(index, result, params);
+}
+
 } // anonymous namespace
 
 ProfilerHandler::ProfilerHandler(AMX *amx)
  : AMXHandler<ProfilerHandler>(amx),
    prev_debug_(amx->debug),
    prev_callback_(amx->callback),
-   profiler_(amx, IsCallGraphEnabled()),
-   state_(PROFILER_DISABLED)
+   profiler_(amx, IsCallGraphNeeded(), GetClock()),
+   num_handled_triggers_(0),
+   running_benchmarks_(false),
+   num_reported_slow_calls_(0),
+   last_slow_call_report_(0),
+   last_long_tick_trigger_(0),
+   state_(PROFILER_DISABLED),
+   level_(PROFILER_LEVEL_FUNCTIONS)
 {
 }
 
@@ -158,22 +335,35 @@ int ProfilerHandler::Load() {
   amx_name_ = fileutils::GetDirectory(amx_path_)
             + "/"
             + fileutils::GetBaseName(amx_path_);
+  profiler_.set_name(amx_name_);
 
   if (amx_path_.empty()) {
     Printf("Could not find AMX file (try setting AMX_PATH?)");
   }
-  if (ShouldBeProfiled(amx_path_)) {
+
+  std::string level = cfg::level;
+  bool should_be_profiled = ShouldBeProfiled(amx_path_, level);
+  if (!ParseLevel(level, level_)) {
+    Printf("Unknown profiler level '%s', using '%s'",
+           level.c_str(), GetLevelString());
+  }
+  if (should_be_profiled) {
     Attach();
   }
   return AMX_ERR_NONE;
 }
 
 int ProfilerHandler::Unload() {
+  // Events left in the file mean that the server didn't shut down
+  // properly, see Attach().
+  if (flight_recorder_.is_open()) {
+    flight_recorder_.Reset();
+  }
   return AMX_ERR_NONE;
 }
 
 int ProfilerHandler::Debug() {
-  if (state_ == PROFILER_STARTED) {
+  if (state_ == PROFILER_STARTED && !running_benchmarks_) {
     try {
       return profiler_.DebugHook(prev_debug_);
     } catch (const std::exception &e) {
@@ -187,7 +377,7 @@ int ProfilerHandler::Debug() {
 }
 
 int ProfilerHandler::Callback(cell index, cell *result, cell *params) {
-  if (state_ == PROFILER_STARTED) {
+  if (state_ == PROFILER_STARTED && !running_benchmarks_) {
     try {
       return profiler_.CallbackHook(index, result, params, prev_callback_);
     } catch (const std::exception &e) {
@@ -197,7 +387,9 @@ int ProfilerHandler::Callback(cell index, cell *result, cell *params) {
   return prev_callback_(amx(), index, result, params);
 }
 
-int ProfilerHandler::Exec(cell *retval, int index) {
+int ProfilerHandler::Exec(cell *retval,
+                          int index,
+                          const void *return_address) {
   if (profiler_.call_stack()->is_empty()) {
     switch (state_) {
       case PROFILER_ATTACHING:
@@ -212,7 +404,18 @@ int ProfilerHandler::Exec(cell *retval, int index) {
   }
   if (state_ == PROFILER_STARTED) {
     try {
-      int error = profiler_.ExecHook(retval, index, amx_Exec);
+      int error =
+        profiler_.ExecHook(retval, index, amx_Exec, return_address);
+      if (profiler_.slow_call_threshold() > amxprof::Nanoseconds(0)
+          && profiler_.call_stack()->is_empty()) {
+        ReportSlowCalls();
+      }
+      if (flight_recorder_.is_open()
+          && num_handled_triggers_ != num_flight_recorder_triggers
+          && profiler_.call_stack()->is_empty()) {
+        num_handled_triggers_ = num_flight_recorder_triggers;
+        DumpFlightRecorder(amx_name_ + "-flight.txt");
+      }
       if (state_ == PROFILER_STOPPING
           && profiler_.call_stack()->is_empty()) {
         CompleteStop();
@@ -225,10 +428,136 @@ int ProfilerHandler::Exec(cell *retval, int index) {
   return amx_Exec(amx(), retval, index);
 }
 
+void ProfilerHandler::ProcessTick() {
+  // Don't dump the flight recorder on every tick if the server is slow for
+  // a while.
+  static const std::time_t kMinTriggerInterval = 10;
+
+  if (state_ != PROFILER_STARTED || !profiler_.call_stack()->is_empty()) {
+    return;
+  }
+  if (flight_recorder_.is_open()
+      && cfg::flight_recorder_tick_ms > 0
+      && profiler_.tick_script_time()
+         > amxprof::Milliseconds(cfg::flight_recorder_tick_ms)) {
+    std::time_t now = std::time(0);
+    if (now - last_long_tick_trigger_ >= kMinTriggerInterval) {
+      Printf("Long tick: %.3f ms of script time",
+             amxprof::Milliseconds(profiler_.tick_script_time()).count());
+      TriggerFlightRecorders();
+      last_long_tick_trigger_ = now;
+    }
+  }
+  profiler_.EndTick();
+}
+
+void ProfilerHandler::ReportSlowCalls() {
+  // Don't flood the log if many calls in a row are slow.
+  static const std::time_t kMinReportInterval = 10;
+
+  const amxprof::SlowCallLog *slow_calls = profiler_.stats()->slow_calls();
+  long num_new_calls = slow_calls->num_calls() - num_reported_slow_calls_;
+  if (num_new_calls <= 0) {
+    return;
+  }
+
+  std::time_t now = std::time(0);
+  if (now - last_slow_call_report_ < kMinReportInterval) {
+    return;
+  }
+
+  const amxprof::SlowCall &call = slow_calls->latest();
+  std::ostringstream message;
+  message << std::fixed << std::setprecision(3)
+          << "Slow call: " << call.stack() << " took "
+          << amxprof::Milliseconds(call.time()).count() << " ms";
+  if (!call.frames().empty()) {
+    const amxprof::SlowCallFrame &slowest = call.frames().front();
+    message << ", slowest: " << slowest.stack() << " ("
+            << amxprof::Milliseconds(slowest.time()).count() << " ms)";
+  }
+  if (num_new_calls > 1) {
+    message << " (" << num_new_calls << " slow calls since last report)";
+  }
+  Printf("%s", message.str().c_str());
+
+  if (flight_recorder_.is_open()) {
+    DumpFlightRecorder(amx_name_ + "-flight.txt");
+  }
+
+  num_reported_slow_calls_ = slow_calls->num_calls();
+  last_slow_call_report_ = now;
+}
+
+void ProfilerHandler::TriggerFlightRecorders() {
+  num_flight_recorder_triggers = num_flight_recorder_triggers + 1;
+}
+
+void ProfilerHandler::DumpFlightRecorder(const std::string &filename) const {
+  std::ofstream stream(filename.c_str());
+  if (!stream.is_open()) {
+    Printf("Error opening '%s' for writing", filename.c_str());
+    return;
+  }
+  Printf("Writing flight recorder trace to %s", filename.c_str());
+  flight_recorder_.Dump(stream,
+                        amxprof::Seconds(cfg::flight_recorder_seconds));
+}
+
 ProfilerState ProfilerHandler::GetState() const {
   return state_;
 }
 
+ProfilerLevel ProfilerHandler::GetLevel() const {
+  return level_;
+}
+
+const char *ProfilerHandler::GetLevelString() const {
+  switch (level_) {
+    case PROFILER_LEVEL_PUBLICS:
+      return "publics";
+    case PROFILER_LEVEL_NATIVES:
+      return "natives";
+    case PROFILER_LEVEL_FUNCTIONS:
+      return "functions";
+    case PROFILER_LEVEL_LINES:
+      return "lines";
+  }
+  return "unknown";
+}
+
+std::string ProfilerHandler::GetSamplingString() const {
+  const amxprof::Sampler *sampler = profiler_.sampler();
+  std::ostringstream stream;
+  stream << "1 in " << sampler->rate() << " calls";
+  if (sampler->is_adaptive()) {
+    stream << " (adaptive, max. overhead "
+           << sampler->max_overhead() * 100 << "%, last measured "
+           << sampler->overhead() * 100 << "%)";
+  }
+  return stream.str();
+}
+
+std::string ProfilerHandler::GetOverheadString() const {
+  double ns_per_event = profiler_.call_overhead().count() / 2;
+  double num_events = static_cast<double>(profiler_.num_events());
+  double run_time = amxprof::Seconds(
+    profiler_.stats()->GetTotalRunTime()).count();
+  double self_time = amxprof::Seconds(
+    amxprof::Nanoseconds(ns_per_event * num_events)).count();
+
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(1)
+         << ns_per_event << " ns/event, "
+         << (run_time > 0 ? num_events / run_time : 0) << " events/s, "
+         << std::setprecision(3)
+         << self_time << " s total";
+  if (!cfg::compensate_overhead) {
+    stream << " (not compensated)";
+  }
+  return stream.str();
+}
+
 bool ProfilerHandler::Attach() {
   try {
     if (amx_path_.empty()) {
@@ -238,6 +567,93 @@ bool ProfilerHandler::Attach() {
       return false;
     }
 
+    // Install only the hooks needed for the chosen level, public
+    // functions are always intercepted by the amx_Exec() hook.
+    if (level_ >= PROFILER_LEVEL_NATIVES) {
+      prev_callback_ = amx()->callback;
+      amx_SetCallback(amx(), amx_Callback_Profiler);
+
+      // This should stop the VM from replacing SYSREQ.C instructions with
+      // SYSREQ.D and allow us to profile native functions.
+      amx()->sysreq_d = 0;
+    }
+    if (level_ >= PROFILER_LEVEL_FUNCTIONS) {
+      prev_debug_ = amx()->debug;
+      amx_SetDebugHook(amx(), amx_Debug_Profiler);
+    }
+    profiler_.set_line_stats_enabled(level_ >= PROFILER_LEVEL_LINES);
+    profiler_.set_call_site_stats_enabled(cfg::call_sites);
+    profiler_.set_tick_stats_enabled(cfg::ticks);
+    if (cfg::cpu_time) {
+      profiler_.set_cpu_clock(amxprof::ThreadCpuClock::GetInstance());
+    }
+    profiler_.set_slow_call_threshold(
+        amxprof::Milliseconds(cfg::slow_threshold_ms));
+    if (cfg::perf_counters) {
+      if (perf_counters_.Open()) {
+        if (!perf_counters_.is_hardware()) {
+          Printf("Hardware counters are not available, counting software "
+                 "events instead");
+        }
+        profiler_.set_perf_counters(&perf_counters_);
+      } else {
+        Printf("Could not open performance counters");
+      }
+    }
+
+    if (cfg::flight_recorder) {
+      std::string filename = amx_name_ + "-flight.bin";
+      if (flight_recorder_.Open(filename, cfg::flight_recorder_events)) {
+        // The previous run didn't unload the script, so these are its
+        // last events before it crashed or hung.
+        if (flight_recorder_.num_events() > 0) {
+          DumpFlightRecorder(amx_name_ + "-flight-crash.txt");
+          flight_recorder_.Reset();
+        }
+        profiler_.set_flight_recorder(&flight_recorder_);
+        InstallTriggerSignalHandler();
+      } else {
+        Printf("Error opening %s", filename.c_str());
+      }
+    }
+
+    profiler_.set_memory_stats_enabled(cfg::memory);
+
+    if (cfg::player_stats) {
+      profiler_.SetPlayerCallbacks(GetPlayerCallbacks());
+    }
+
+    if (cfg::timers) {
+      if (level_ >= PROFILER_LEVEL_NATIVES) {
+        profiler_.set_timer_stats_enabled(true);
+      } else {
+        Printf("Timer statistics require level 'natives' or higher");
+      }
+    }
+
+    if (cfg::redundant_calls) {
+      if (level_ >= PROFILER_LEVEL_NATIVES) {
+        profiler_.set_redundant_call_stats_enabled(true);
+      } else {
+        Printf("Redundant call detection requires level 'natives' or higher");
+      }
+    }
+
+    if (cfg::record_natives) {
+      if (level_ >= PROFILER_LEVEL_NATIVES) {
+        profiler_.set_native_recorder(&native_recorder_);
+      } else {
+        Printf("Recording natives requires level 'natives' or higher");
+      }
+    }
+
+    // The overhead limit is specified in percent, e.g. "2%" or just "2".
+    profiler_.sampler()->set_rate(cfg::sample_rate);
+    profiler_.sampler()->set_max_overhead(
+        std::atof(cfg::max_overhead.c_str()) / 100);
+
+    profiler_.Calibrate(cfg::compensate_overhead);
+
     if (amxprof::HasDebugInfo(amx())) {
       if (debug_info_.Load(amx_path_)) {
         profiler_.set_debug_info(&debug_info_);
@@ -248,9 +664,11 @@ bool ProfilerHandler::Attach() {
     }
 
     if (debug_info_.is_loaded()) {
-      Printf("Attached profiler to %s", amx_name_.c_str());
+      Printf("Attached profiler to %s (level: %s)",
+             amx_name_.c_str(), GetLevelString());
     } else {
-      Printf("Attached profiler to %s (no debug info)", amx_name_.c_str());
+      Printf("Attached profiler to %s (level: %s, no debug info)",
+             amx_name_.c_str(), GetLevelString());
     }
 
     state_ = PROFILER_ATTACHED;
@@ -276,6 +694,14 @@ bool ProfilerHandler::Start() {
 
 void ProfilerHandler::CompleteStart() {
   Printf("Started profiling %s", amx_name_.c_str());
+  if (cfg::record_natives && level_ >= PROFILER_LEVEL_NATIVES) {
+    std::string log_filename = amx_name_ + "-natives.log";
+    if (native_recorder_.Open(log_filename, amx())) {
+      Printf("Recording native calls to %s", log_filename.c_str());
+    } else {
+      Printf("Error opening %s for writing", log_filename.c_str());
+    }
+  }
   state_ = PROFILER_STARTED;
 }
 
@@ -289,6 +715,7 @@ bool ProfilerHandler::Stop() {
 
 void ProfilerHandler::CompleteStop() {
   Printf("Stopped profiling %s", amx_name_.c_str());
+  native_recorder_.Close();
   state_ = PROFILER_STOPPED;
 }
 
@@ -348,6 +775,11 @@ bool ProfilerHandler::Dump() const {
         writer = new amxprof::StatisticsWriterText;
       } else if (output_format == "json") {
         writer = new amxprof::StatisticsWriterJson;
+      } else if (output_format == "gprof") {
+        amxprof::StatisticsWriterGprof *gprof_writer =
+            new amxprof::StatisticsWriterGprof;
+        gprof_writer->set_call_graph(profiler_.call_graph());
+        writer = gprof_writer;
       } else {
         Printf("Unsupported output format '%s'", output_format.c_str());
       }
@@ -358,6 +790,10 @@ bool ProfilerHandler::Dump() const {
         writer->set_script_name(amx_path_);
         writer->set_print_date(true);
         writer->set_print_run_time(true);
+        writer->AddMetadata("Level", GetLevelString());
+        writer->AddMetadata("Sampling", GetSamplingString());
+        writer->AddMetadata("Profiler overhead", GetOverheadString());
+        writer->AddMetadata("Clock", IsTscClockEnabled() ? "tsc" : "system");
         writer->Write(profiler_.stats());
         delete writer;
       }
@@ -392,6 +828,9 @@ bool ProfilerHandler::Dump() const {
           writer->set_stream(&call_graph_stream);
           writer->set_script_name(amx_path_);
           writer->set_root_node_name("SA-MP Server");
+          // The threshold is specified in percent, like the overhead limit.
+          writer->set_edge_threshold(
+              std::atof(cfg::call_graph_threshold.c_str()) / 100);
           writer->Write(profiler_.call_graph());
           delete writer;
         }
@@ -408,3 +847,108 @@ bool ProfilerHandler::Dump() const {
   }
   return false;
 }
+
+bool ProfilerHandler::RegisterBenchmark(const std::string &name,
+                                        const std::string &function) {
+  int index;
+  if (amx_FindPublic(amx(), function.c_str(), &index) != AMX_ERR_NONE) {
+    Printf("Benchmark '%s': public function %s not found",
+           name.c_str(), function.c_str());
+    return false;
+  }
+  benchmarks_.push_back(amxprof::Benchmark(name, function, index));
+  return true;
+}
+
+int ProfilerHandler::GetZoneId(const std::string &name) {
+  return profiler_.GetZoneId(name);
+}
+
+bool ProfilerHandler::BeginZone(int zone) {
+  if (state_ != PROFILER_STARTED
+      || running_benchmarks_
+      || profiler_.call_stack()->is_empty()) {
+    return false;
+  }
+  return profiler_.BeginZone(zone);
+}
+
+bool ProfilerHandler::EndZone() {
+  if (state_ != PROFILER_STARTED || running_benchmarks_) {
+    return false;
+  }
+  return profiler_.EndZone();
+}
+
+int ProfilerHandler::GetCounterId(const std::string &name) {
+  return profiler_.GetCounterId(name);
+}
+
+bool ProfilerHandler::SetCounter(int counter, cell value) {
+  if (state_ != PROFILER_STARTED) {
+    return false;
+  }
+  return profiler_.SetCounter(counter, value);
+}
+
+int ProfilerHandler::RunBenchmarks(int num_samples,
+                                   int num_iterations,
+                                   int num_warmup) {
+  if (benchmarks_.empty() || running_benchmarks_) {
+    return 0;
+  }
+  if (num_samples < 1 || num_iterations < 0 || num_warmup < 0) {
+    Printf("Benchmark_Run: invalid arguments (samples = %d, "
+           "iterations = %d, warmup = %d)",
+           num_samples, num_iterations, num_warmup);
+    return 0;
+  }
+
+  std::string output_filename = amx_name_ + "-benchmark.json";
+  std::ofstream output_stream(output_filename.c_str());
+  if (!output_stream.is_open()) {
+    Printf("Error opening '%s' for writing", output_filename.c_str());
+    return 0;
+  }
+
+  amxprof::StatisticsWriterJson writer;
+  writer.set_stream(&output_stream);
+  writer.set_script_name(amx_path_);
+  writer.set_print_date(true);
+  writer.AddMetadata("Clock", IsTscClockEnabled() ? "tsc" : "system");
+
+  // The benchmarked code runs without the profiler's hooks, which would
+  // otherwise add their overhead to the results.
+  running_benchmarks_ = true;
+
+  int num_completed = 0;
+  for (std::vector<amxprof::Benchmark>::iterator it = benchmarks_.begin();
+       it != benchmarks_.end(); ++it) {
+    int error = it->Run(amx(), amx_Exec, GetClock(),
+                        num_samples, num_iterations, num_warmup);
+    if (error != AMX_ERR_NONE) {
+      Printf("Benchmark '%s' failed: %s",
+             it->name().c_str(), aux_StrError(error));
+      continue;
+    }
+    const amxprof::BenchmarkSummary &summary = it->summary();
+    Printf("Benchmark '%s': %.1f ns +/- %.1f ns per call "
+           "(%d iterations, %d samples, %d outliers)",
+           it->name().c_str(),
+           summary.mean().count(),
+           summary.ci95().count(),
+           it->num_iterations(),
+           summary.num_samples(),
+           summary.num_outliers());
+    writer.AddBenchmark(&*it);
+    num_completed++;
+  }
+
+  running_benchmarks_ = false;
+
+  amxprof::Statistics no_stats;
+  writer.Write(&no_stats);
+  Printf("Wrote benchmark results to %s", output_filename.c_str());
+
+  return num_completed;
+}
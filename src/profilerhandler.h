@@ -25,8 +25,15 @@
 #ifndef PROFILERHANDLER_H
 #define PROFILERHANDLER_H
 
+#include <ctime>
+#include <string>
+#include <vector>
 #include <configreader.h>
+#include <amxprof/benchmark.h>
 #include <amxprof/debug_info.h>
+#include <amxprof/flight_recorder.h>
+#include <amxprof/native_recorder.h>
+#include <amxprof/perf_counters.h>
 #include <amxprof/profiler.h>
 #include "amxhandler.h"
 
@@ -42,6 +49,15 @@ enum ProfilerState {
   PROFILER_STOPPED
 };
 
+// Instrumentation levels. Each level includes everything from the
+// previous ones and costs more.
+enum ProfilerLevel {
+  PROFILER_LEVEL_PUBLICS,   // public functions only (exec hook)
+  PROFILER_LEVEL_NATIVES,   // + native functions (callback hook)
+  PROFILER_LEVEL_FUNCTIONS, // + normal functions (debug hook)
+  PROFILER_LEVEL_LINES      // + per-line statistics
+};
+
 class AMXPathFinder;
 
 class ProfilerHandler : public AMXHandler<ProfilerHandler> {
@@ -57,21 +73,48 @@ class ProfilerHandler : public AMXHandler<ProfilerHandler> {
 
   int Debug();
   int Callback(cell index, cell *result, cell *params);
-  int Exec(cell *retval, int index);
+  int Exec(cell *retval, int index, const void *return_address = 0);
+  void ProcessTick();
 
  public:
   ProfilerState GetState() const;
+  ProfilerLevel GetLevel() const;
+  const char *GetLevelString() const;
   bool Attach();
   bool Start();
   bool Stop();
   bool Dump() const;
 
+  // Makes every script with a flight recorder dump its recent events the
+  // next time it returns to the server. Safe to call from a signal handler.
+  static void TriggerFlightRecorders();
+
+  bool RegisterBenchmark(const std::string &name, const std::string &function);
+  int RunBenchmarks(int num_samples, int num_iterations, int num_warmup);
+
+  // Zones and counters marked by the script, see amxprof::Profiler. They
+  // are only recorded while the profiler is running.
+  int GetZoneId(const std::string &name);
+  bool BeginZone(int zone);
+  bool EndZone();
+  int GetCounterId(const std::string &name);
+  bool SetCounter(int counter, cell value);
+
  private:
   ProfilerHandler(AMX *amx);
 
+  std::string GetSamplingString() const;
+  std::string GetOverheadString() const;
+
   void CompleteStart();
   void CompleteStop();
 
+  // Logs the latest slow call, if there were any since the last report.
+  void ReportSlowCalls();
+
+  // Writes the flight recorder's recent events to a file.
+  void DumpFlightRecorder(const std::string &filename) const;
+
  private:
   AMXPathFinder *amx_path_finder_;
   std::string amx_path_;
@@ -80,7 +123,17 @@ class ProfilerHandler : public AMXHandler<ProfilerHandler> {
   AMX_CALLBACK prev_callback_;
   amxprof::Profiler profiler_;
   amxprof::DebugInfo debug_info_;
+  amxprof::NativeRecorder native_recorder_;
+  amxprof::PerfCounters perf_counters_;
+  amxprof::FlightRecorder flight_recorder_;
+  int num_handled_triggers_;
+  std::vector<amxprof::Benchmark> benchmarks_;
+  bool running_benchmarks_;
+  long num_reported_slow_calls_;
+  std::time_t last_slow_call_report_;
+  std::time_t last_long_tick_trigger_;
   ProfilerState state_;
+  ProfilerLevel level_;
 };
 
 #endif // !PROFILERHANDLER_H